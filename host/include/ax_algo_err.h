@@ -0,0 +1,24 @@
+/**************************************************************************************************
+ *
+ * Copyright (c) 2019-2023 Axera Semiconductor (Shanghai) Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Axera Semiconductor (Shanghai) Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Axera Semiconductor (Shanghai) Co., Ltd.
+ *
+ **************************************************************************************************/
+
+#ifndef _AX_ALGO_ERR_H_
+#define _AX_ALGO_ERR_H_
+
+#include "ax_global_type.h"
+
+#define AX_ALGO_SUCC                    (0)
+#define AX_ERR_ALGO_INVALID_HANDLE      AX_DEF_ERR(AX_ID_SKEL, AX_ERR_LEVEL_ERROR, AX_ERR_INVALID_CHNID)
+#define AX_ERR_ALGO_NULL_PTR            AX_DEF_ERR(AX_ID_SKEL, AX_ERR_LEVEL_ERROR, AX_ERR_NULLPTR)
+#define AX_ERR_ALGO_ILLEGAL_PARAM       AX_DEF_ERR(AX_ID_SKEL, AX_ERR_LEVEL_ERROR, AX_ERR_ILLEGAL_PARAMETER)
+#define AX_ERR_ALGO_NOT_SUPPORT         AX_DEF_ERR(AX_ID_SKEL, AX_ERR_LEVEL_ERROR, AX_ERR_NOT_SUPPORT)
+#define AX_ERR_ALGO_NOMEM               AX_DEF_ERR(AX_ID_SKEL, AX_ERR_LEVEL_ERROR, AX_ERR_NOMEM)
+#define AX_ERR_ALGO_NOT_INIT            AX_DEF_ERR(AX_ID_SKEL, AX_ERR_LEVEL_ERROR, AX_ERR_NOT_INITED)
+
+#endif // _AX_ALGO_ERR_H_
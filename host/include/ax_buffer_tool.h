@@ -0,0 +1,56 @@
+/**************************************************************************************************
+ *
+ * Copyright (c) 2019-2023 Axera Semiconductor (Shanghai) Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Axera Semiconductor (Shanghai) Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Axera Semiconductor (Shanghai) Co., Ltd.
+ *
+ **************************************************************************************************/
+
+#ifndef _AX_BUFFER_TOOL_H_
+#define _AX_BUFFER_TOOL_H_
+
+#include "ax_global_type.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#define AX_COMM_ALIGN(value, n)     (((value) + (n) - 1) & ~((n) - 1))
+
+static inline AX_U32 AX_VIN_GetImgBufferSize(AX_U32 uHeight, AX_U32 uWidth, AX_IMG_FORMAT_E eImgFormat, AX_U32 nAlign)
+{
+    AX_U32 uStride = (nAlign > 0) ? AX_COMM_ALIGN(uWidth, nAlign) : uWidth;
+
+    switch (eImgFormat) {
+        case AX_FORMAT_YUV400:
+            return uStride * uHeight;
+        case AX_FORMAT_YUV420_SEMIPLANAR:
+        case AX_FORMAT_YUV420_SEMIPLANAR_VU:
+        case AX_FORMAT_YUV420_PLANAR:
+        case AX_FORMAT_YUV420_PLANAR_VU:
+            return uStride * uHeight * 3 / 2;
+        case AX_FORMAT_YUV422_PLANAR:
+        case AX_FORMAT_YUV422_SEMIPLANAR:
+            return uStride * uHeight * 2;
+        case AX_FORMAT_RGB888:
+        case AX_FORMAT_BGR888:
+        case AX_FORMAT_YUV444_PLANAR:
+        case AX_FORMAT_YUV444_SEMIPLANAR:
+        case AX_FORMAT_YUV444_SEMIPLANAR_VU:
+            return uStride * uHeight * 3;
+        case AX_FORMAT_ARGB8888:
+        case AX_FORMAT_RGBA8888:
+            return uStride * uHeight * 4;
+        default:
+            return 0;
+    }
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _AX_BUFFER_TOOL_H_
@@ -0,0 +1,41 @@
+/**************************************************************************************************
+ *
+ * Copyright (c) 2019-2023 Axera Semiconductor (Shanghai) Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Axera Semiconductor (Shanghai) Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Axera Semiconductor (Shanghai) Co., Ltd.
+ *
+ **************************************************************************************************/
+
+#ifndef _AX_ENGINE_API_H_
+#define _AX_ENGINE_API_H_
+
+#include "ax_engine_type.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/* host: mirrors the AX620E signatures */
+AX_S32 AX_ENGINE_Init(AX_VOID);
+AX_S32 AX_ENGINE_Deinit(AX_VOID);
+const AX_CHAR* AX_ENGINE_GetVersion(AX_VOID);
+
+AX_S32 AX_ENGINE_GetVNPUAttr(AX_ENGINE_NPU_ATTR_T* pAttr);
+AX_S32 AX_ENGINE_GetModelType(const AX_VOID* pData, AX_U32 nDataSize, AX_ENGINE_MODEL_TYPE_T* pModelType);
+
+AX_S32 AX_ENGINE_CreateHandle(AX_ENGINE_HANDLE* pHandle, const AX_VOID* pData, AX_U32 nDataSize);
+AX_S32 AX_ENGINE_CreateHandleV2(AX_ENGINE_HANDLE* pHandle, const AX_VOID* pData, AX_U32 nDataSize, AX_ENGINE_HANDLE_EXTRA_T* pExtraParam);
+AX_S32 AX_ENGINE_DestroyHandle(AX_ENGINE_HANDLE nHandle);
+
+AX_S32 AX_ENGINE_GetIOInfo(AX_ENGINE_HANDLE nHandle, AX_ENGINE_IO_INFO_T** pIO);
+AX_S32 AX_ENGINE_CreateContext(AX_ENGINE_HANDLE handle);
+AX_S32 AX_ENGINE_RunSync(AX_ENGINE_HANDLE handle, AX_ENGINE_IO_T* pIO);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _AX_ENGINE_API_H_
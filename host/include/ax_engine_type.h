@@ -0,0 +1,149 @@
+/**************************************************************************************************
+ *
+ * Copyright (c) 2019-2023 Axera Semiconductor (Shanghai) Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Axera Semiconductor (Shanghai) Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Axera Semiconductor (Shanghai) Co., Ltd.
+ *
+ **************************************************************************************************/
+
+#ifndef _AX_ENGINE_TYPE_H_
+#define _AX_ENGINE_TYPE_H_
+
+#include "ax_global_type.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#define AX_ERR_ENGINE_NULL_PTR          AX_DEF_ERR(AX_ID_ENGINE, AX_ERR_LEVEL_ERROR, AX_ERR_NULLPTR)
+#define AX_ERR_ENGINE_ILLEGAL_PARAM     AX_DEF_ERR(AX_ID_ENGINE, AX_ERR_LEVEL_ERROR, AX_ERR_ILLEGAL_PARAMETER)
+#define AX_ERR_ENGINE_NOT_INIT          AX_DEF_ERR(AX_ID_ENGINE, AX_ERR_LEVEL_ERROR, AX_ERR_NOT_INITED)
+#define AX_ERR_ENGINE_UNEXIST           AX_DEF_ERR(AX_ID_ENGINE, AX_ERR_LEVEL_ERROR, AX_ERR_UNEXIST)
+#define AX_ERR_ENGINE_NOMEM             AX_DEF_ERR(AX_ID_ENGINE, AX_ERR_LEVEL_ERROR, AX_ERR_NOMEM)
+
+typedef AX_VOID* AX_ENGINE_HANDLE;
+typedef AX_U32 AX_ENGINE_NPU_SET_T;
+
+typedef enum {
+    AX_ENGINE_TENSOR_LAYOUT_UNKNOWN = 0,
+    AX_ENGINE_TENSOR_LAYOUT_NHWC    = 1,
+    AX_ENGINE_TENSOR_LAYOUT_NCHW    = 2,
+} AX_ENGINE_TENSOR_LAYOUT_T;
+
+typedef enum {
+    AX_ENGINE_MT_PHYSICAL = 0,
+    AX_ENGINE_MT_VIRTUAL  = 1,
+    AX_ENGINE_MT_OCM      = 2,
+} AX_ENGINE_MEMORY_TYPE_T;
+
+typedef enum {
+    AX_ENGINE_DT_UNKNOWN        = 0,
+    AX_ENGINE_DT_UINT8          = 1,
+    AX_ENGINE_DT_UINT16         = 2,
+    AX_ENGINE_DT_FLOAT32        = 3,
+    AX_ENGINE_DT_SINT16         = 4,
+    AX_ENGINE_DT_SINT8          = 5,
+    AX_ENGINE_DT_SINT32         = 6,
+    AX_ENGINE_DT_UINT32         = 7,
+    AX_ENGINE_DT_FLOAT64        = 8,
+    AX_ENGINE_DT_UINT10_PACKED  = 100,
+    AX_ENGINE_DT_UINT12_PACKED  = 101,
+    AX_ENGINE_DT_UINT14_PACKED  = 102,
+    AX_ENGINE_DT_UINT16_PACKED  = 103,
+} AX_ENGINE_DATA_TYPE_T;
+
+typedef enum {
+    AX_ENGINE_CS_FEATUREMAP = 0,
+    AX_ENGINE_CS_RAW8       = 12,
+    AX_ENGINE_CS_RAW10      = 13,
+    AX_ENGINE_CS_RAW12      = 14,
+    AX_ENGINE_CS_RAW14      = 15,
+    AX_ENGINE_CS_RAW16      = 16,
+    AX_ENGINE_CS_NV12       = 20,
+    AX_ENGINE_CS_NV21       = 21,
+    AX_ENGINE_CS_RGB        = 30,
+    AX_ENGINE_CS_BGR        = 31,
+    AX_ENGINE_CS_RGBA       = 32,
+    AX_ENGINE_CS_GRAY       = 40,
+    AX_ENGINE_CS_YUV444     = 50,
+} AX_ENGINE_COLOR_SPACE_T;
+
+typedef enum {
+    AX_ENGINE_VIRTUAL_NPU_DISABLE = 0,
+    AX_ENGINE_VIRTUAL_NPU_ENABLE  = 1,
+    AX_ENGINE_VIRTUAL_NPU_BUTT
+} AX_ENGINE_NPU_MODE_T;
+
+typedef enum {
+    AX_ENGINE_MODEL_TYPE0 = 0,  /* half OCM */
+    AX_ENGINE_MODEL_TYPE1 = 1,  /* full OCM */
+    AX_ENGINE_MODEL_TYPE_BUTT
+} AX_ENGINE_MODEL_TYPE_T;
+
+typedef struct {
+    AX_ENGINE_NPU_MODE_T    eHardMode;
+    AX_U32                  reserve[8];
+} AX_ENGINE_NPU_ATTR_T;
+
+typedef struct {
+    AX_ENGINE_NPU_SET_T     nNpuSet;
+    AX_S8*                  pName;
+    AX_U32                  reserve[8];
+} AX_ENGINE_HANDLE_EXTRA_T;
+
+typedef struct {
+    AX_ENGINE_COLOR_SPACE_T eColorSpace;
+    AX_U64                  u64Reserved[18];
+} AX_ENGINE_IOMETA_EX_T;
+
+typedef struct {
+    AX_CHAR*                    pName;
+    AX_S32*                     pShape;
+    AX_U8                       nShapeSize;
+    AX_ENGINE_TENSOR_LAYOUT_T   eLayout;
+    AX_ENGINE_MEMORY_TYPE_T     eMemoryType;
+    AX_ENGINE_DATA_TYPE_T       eDataType;
+    AX_ENGINE_IOMETA_EX_T*      pExtraMeta;
+    AX_U32                      nSize;
+    AX_U32                      nQuantizationValue;
+    AX_S32*                     pStride;
+    AX_U64                      u64Reserved[9];
+} AX_ENGINE_IOMETA_T;
+
+typedef struct {
+    AX_ENGINE_IOMETA_T*     pInputs;
+    AX_U32                  nInputSize;
+    AX_ENGINE_IOMETA_T*     pOutputs;
+    AX_U32                  nOutputSize;
+    AX_U32                  nMaxBatchSize;
+    AX_BOOL                 bDynamicBatchSize;
+    AX_U64                  u64Reserved[11];
+} AX_ENGINE_IO_INFO_T;
+
+typedef struct {
+    AX_U64                  phyAddr;
+    AX_VOID*                pVirAddr;
+    AX_U32                  nSize;
+    AX_S32*                 pStride;
+    AX_U8                   nStrideSize;
+    AX_U64                  u64Reserved[11];
+} AX_ENGINE_IO_BUFFER_T;
+
+typedef struct {
+    AX_ENGINE_IO_BUFFER_T*  pInputs;
+    AX_U32                  nInputSize;
+    AX_ENGINE_IO_BUFFER_T*  pOutputs;
+    AX_U32                  nOutputSize;
+    AX_U32                  nBatchSize;
+    AX_VOID*                pIoSetting;
+    AX_U64                  u64Reserved[10];
+} AX_ENGINE_IO_T;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _AX_ENGINE_TYPE_H_
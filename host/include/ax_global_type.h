@@ -0,0 +1,173 @@
+/**************************************************************************************************
+ *
+ * Copyright (c) 2019-2023 Axera Semiconductor (Shanghai) Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Axera Semiconductor (Shanghai) Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Axera Semiconductor (Shanghai) Co., Ltd.
+ *
+ **************************************************************************************************/
+
+#ifndef _AX_GLOBAL_TYPE_H_
+#define _AX_GLOBAL_TYPE_H_
+
+/*
+ * Host (x86) simulation of the AX SDK common types.
+ * Only the subset used by the framework is declared, field names follow the BSP headers.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+typedef uint8_t             AX_U8;
+typedef uint16_t            AX_U16;
+typedef uint32_t            AX_U32;
+typedef uint64_t            AX_U64;
+typedef signed char         AX_S8;
+typedef int16_t             AX_S16;
+typedef int32_t             AX_S32;
+typedef int64_t             AX_S64;
+typedef float               AX_F32;
+typedef double              AX_F64;
+typedef char                AX_CHAR;
+typedef uint64_t            AX_ADDR;
+#define AX_VOID             void
+
+typedef enum {
+    AX_FALSE = 0,
+    AX_TRUE  = 1,
+} AX_BOOL;
+
+/* not a macro: the framework declares its own AX_SUCCESS inside namespace ax */
+enum { AX_SUCCESS = 0 };
+
+typedef enum {
+    AX_ID_MIN      = 0x00,
+    AX_ID_ISP      = 0x01,
+    AX_ID_CE       = 0x02,
+    AX_ID_VO       = 0x03,
+    AX_ID_VDSP     = 0x04,
+    AX_ID_EFUSE    = 0x05,
+    AX_ID_NPU      = 0x06,
+    AX_ID_VENC     = 0x07,
+    AX_ID_VDEC     = 0x08,
+    AX_ID_JENC     = 0x09,
+    AX_ID_JDEC     = 0x0a,
+    AX_ID_SYS      = 0x0b,
+    AX_ID_AENC     = 0x0c,
+    AX_ID_IVPS     = 0x0d,
+    AX_ID_MIPI     = 0x0e,
+    AX_ID_ADEC     = 0x0f,
+    AX_ID_DMA      = 0x10,
+    AX_ID_VIN      = 0x11,
+    AX_ID_USER     = 0x12,
+    AX_ID_IVES     = 0x13,
+    AX_ID_SKEL     = 0x14,
+    AX_ID_IVE      = 0x15,
+    AX_ID_AUDIO    = 0x16,
+    AX_ID_ENGINE   = 0x17,
+    AX_ID_POOL     = 0x18,
+    AX_ID_BUTT,
+} AX_MOD_ID_E;
+
+/* error code layout: 0x80 | module | level | code */
+#define AX_ERR_APPID            (0x80000000L)
+#define AX_ERR_LEVEL_ERROR      (0x02)
+#define AX_DEF_ERR(module, level, errid) \
+    ((AX_S32)((AX_ERR_APPID) | ((module) << 16) | ((level) << 8) | (errid)))
+
+typedef enum {
+    AX_ERR_INVALID_MODID      = 0x01,
+    AX_ERR_INVALID_DEVID      = 0x02,
+    AX_ERR_INVALID_GRPID      = 0x03,
+    AX_ERR_INVALID_CHNID      = 0x04,
+    AX_ERR_EXIST              = 0x05,
+    AX_ERR_UNEXIST            = 0x06,
+    AX_ERR_NULLPTR            = 0x07,
+    AX_ERR_ILLEGAL_PARAMETER  = 0x08,
+    AX_ERR_NOT_SUPPORT        = 0x09,
+    AX_ERR_NOT_PERM           = 0x0a,
+    AX_ERR_NOMEM              = 0x0b,
+    AX_ERR_NOT_INITED         = 0x0c,
+    AX_ERR_BUF_EMPTY          = 0x0d,
+    AX_ERR_BUF_FULL           = 0x0e,
+    AX_ERR_TIMED_OUT          = 0x0f,
+    AX_ERR_BUSY               = 0x10,
+} AX_COMMON_ERR_E;
+
+typedef enum {
+    PT_PCMU  = 0,
+    PT_JPEG  = 26,
+    PT_H264  = 96,
+    PT_H265  = 265,
+    PT_MJPEG = 1002,
+    PT_BUTT
+} AX_PAYLOAD_TYPE_E;
+
+typedef enum {
+    AX_UNLINK_MODE = 0,
+    AX_LINK_MODE   = 1,
+    AX_LINK_MODE_BUTT
+} AX_LINK_MODE_E;
+
+typedef enum {
+    AX_FORMAT_INVALID                   = -1,
+    AX_FORMAT_YUV400                    = 0x0,
+    AX_FORMAT_YUV420_PLANAR             = 0x1,
+    AX_FORMAT_YUV420_PLANAR_VU          = 0x2,
+    AX_FORMAT_YUV420_SEMIPLANAR         = 0x3,
+    AX_FORMAT_YUV420_SEMIPLANAR_VU      = 0x4,
+    AX_FORMAT_YUV422_PLANAR             = 0x8,
+    AX_FORMAT_YUV422_SEMIPLANAR         = 0xa,
+    AX_FORMAT_YUV444_PLANAR             = 0x10,
+    AX_FORMAT_YUV444_SEMIPLANAR         = 0x12,
+    AX_FORMAT_YUV444_SEMIPLANAR_VU      = 0x13,
+    AX_FORMAT_RGB565                    = 0x40,
+    AX_FORMAT_RGB888                    = 0x41,
+    AX_FORMAT_BGR888                    = 0x42,
+    AX_FORMAT_ARGB8888                  = 0x46,
+    AX_FORMAT_RGBA8888                  = 0x48,
+    AX_FORMAT_BUTT
+} AX_IMG_FORMAT_E;
+
+typedef AX_S32 AX_POOL;
+typedef AX_U32 AX_BLK;
+#define AX_INVALID_POOLID   (-1U)
+#define AX_INVALID_BLOCKID  (0)
+
+typedef struct {
+    AX_U32              u32Width;
+    AX_U32              u32Height;
+    AX_IMG_FORMAT_E     enImgFormat;
+    AX_S16              s16CropX;
+    AX_S16              s16CropY;
+    AX_S16              s16CropWidth;
+    AX_S16              s16CropHeight;
+    AX_U32              u32PicStride[3];
+    AX_U64              u64PhyAddr[3];
+    AX_U64              u64VirAddr[3];
+    AX_BLK              u32BlkId[3];
+    AX_U64              u64PTS;
+    AX_U64              u64SeqNum;
+    AX_U64              u64UserData;
+    AX_U64              u64PrivateData;
+    AX_U32              u32FrameFlag;
+    AX_U32              u32FrameSize;
+} AX_VIDEO_FRAME_T;
+
+typedef struct {
+    AX_VIDEO_FRAME_T    stVFrame;
+    AX_MOD_ID_E         enModId;
+    AX_BOOL             bEndOfStream;
+} AX_VIDEO_FRAME_INFO_T;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _AX_GLOBAL_TYPE_H_
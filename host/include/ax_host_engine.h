@@ -0,0 +1,53 @@
+/**************************************************************************************************
+ *
+ * Copyright (c) 2019-2023 Axera Semiconductor (Shanghai) Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Axera Semiconductor (Shanghai) Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Axera Semiconductor (Shanghai) Co., Ltd.
+ *
+ **************************************************************************************************/
+
+#ifndef _AX_HOST_ENGINE_H_
+#define _AX_HOST_ENGINE_H_
+
+/*
+ * Host only: pluggable fake models for the simulated AX_ENGINE.
+ *
+ * A model is registered with its io description and a run callback. AX_ENGINE_CreateHandle
+ * picks the model whose name follows AX_HOST_MODEL_MAGIC at the start of the model buffer,
+ * e.g. a model file containing "axhost:pico", otherwise the last registered model is used.
+ */
+
+#include "ax_engine_type.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#define AX_HOST_MODEL_MAGIC         "axhost:"
+
+/* fill pIo->pOutputs from pIo->pInputs, return 0 on success */
+typedef AX_S32 (*AX_HOST_ENGINE_RUN_FN)(const AX_ENGINE_IO_INFO_T* pInfo, AX_ENGINE_IO_T* pIo, AX_VOID* pUserData);
+
+typedef struct {
+    const AX_CHAR*          pName;
+    const AX_ENGINE_IOMETA_T* pInputs;
+    AX_U32                  nInputSize;
+    const AX_ENGINE_IOMETA_T* pOutputs;
+    AX_U32                  nOutputSize;
+    AX_HOST_ENGINE_RUN_FN   pfnRun;         /* nullptr: outputs are zero filled */
+    AX_VOID*                pUserData;
+    AX_U32                  nLatencyUs;     /* simulated NPU time added to every RunSync */
+} AX_HOST_ENGINE_MODEL_T;
+
+/* metas are deep copied, a model registered twice with the same name replaces the first one */
+AX_S32 AX_HOST_ENGINE_RegisterModel(const AX_HOST_ENGINE_MODEL_T* pModel);
+AX_S32 AX_HOST_ENGINE_UnregisterModel(const AX_CHAR* pName);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _AX_HOST_ENGINE_H_
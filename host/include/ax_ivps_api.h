@@ -0,0 +1,81 @@
+/**************************************************************************************************
+ *
+ * Copyright (c) 2019-2023 Axera Semiconductor (Shanghai) Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Axera Semiconductor (Shanghai) Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Axera Semiconductor (Shanghai) Co., Ltd.
+ *
+ **************************************************************************************************/
+
+#ifndef _AX_IVPS_API_H_
+#define _AX_IVPS_API_H_
+
+#include "ax_global_type.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#define AX_ERR_IVPS_NULL_PTR            AX_DEF_ERR(AX_ID_IVPS, AX_ERR_LEVEL_ERROR, AX_ERR_NULLPTR)
+#define AX_ERR_IVPS_ILLEGAL_PARAM       AX_DEF_ERR(AX_ID_IVPS, AX_ERR_LEVEL_ERROR, AX_ERR_ILLEGAL_PARAMETER)
+#define AX_ERR_IVPS_NOT_SUPPORT         AX_DEF_ERR(AX_ID_IVPS, AX_ERR_LEVEL_ERROR, AX_ERR_NOT_SUPPORT)
+
+typedef enum {
+    AX_IVPS_ASPECT_RATIO_STRETCH = 0,   /* fill dst, aspect ratio not kept */
+    AX_IVPS_ASPECT_RATIO_AUTO    = 1,   /* letterbox, aligned by eAligns, padded with nBgColor */
+    AX_IVPS_ASPECT_RATIO_MANUAL  = 2,   /* scale into tRect */
+    AX_IVPS_ASPECT_RATIO_BUTT
+} AX_IVPS_ASPECT_RATIO_E;
+
+typedef enum {
+    AX_IVPS_ASPECT_RATIO_HORIZONTAL_CENTER = 0,
+    AX_IVPS_ASPECT_RATIO_HORIZONTAL_LEFT   = 1,
+    AX_IVPS_ASPECT_RATIO_HORIZONTAL_RIGHT  = 2,
+    AX_IVPS_ASPECT_RATIO_VERTICAL_CENTER   = AX_IVPS_ASPECT_RATIO_HORIZONTAL_CENTER,
+    AX_IVPS_ASPECT_RATIO_VERTICAL_TOP      = AX_IVPS_ASPECT_RATIO_HORIZONTAL_LEFT,
+    AX_IVPS_ASPECT_RATIO_VERTICAL_BOTTOM   = AX_IVPS_ASPECT_RATIO_HORIZONTAL_RIGHT,
+} AX_IVPS_ASPECT_RATIO_ALIGN_E;
+
+typedef struct {
+    AX_S16 nX;
+    AX_S16 nY;
+    AX_U16 nW;
+    AX_U16 nH;
+} AX_IVPS_RECT_T;
+
+typedef struct {
+    AX_IVPS_ASPECT_RATIO_E          eMode;
+    AX_U32                          nBgColor;   /* 0xRRGGBB */
+    AX_IVPS_ASPECT_RATIO_ALIGN_E    eAligns[2]; /* [0]: horizontal, [1]: vertical */
+    AX_IVPS_RECT_T                  tRect;
+} AX_IVPS_ASPECT_RATIO_T;
+
+typedef enum {
+    AX_IVPS_SCL_TYPE_AUTO     = 0,
+    AX_IVPS_SCL_TYPE_BILINEAR = 1,
+    AX_IVPS_SCL_TYPE_NEAREST  = 2,
+    AX_IVPS_SCL_TYPE_BUTT
+} AX_IVPS_SCL_TYPE_E;
+
+typedef struct {
+    AX_IVPS_ASPECT_RATIO_T  tAspectRatio;
+    AX_IVPS_SCL_TYPE_E      eSclType;
+} AX_IVPS_CROP_RESIZE_ATTR_T;
+
+/*
+ * Crop (s16Crop* of src) and resize into the already allocated dst frame.
+ * host: CPU kernel, supports NV12/NV21, RGB888/BGR888 and YUV400.
+ */
+AX_S32 AX_IVPS_CropResizeTdp(const AX_VIDEO_FRAME_T *ptSrc, AX_VIDEO_FRAME_T *ptDst, const AX_IVPS_CROP_RESIZE_ATTR_T *ptAttr);
+
+/* one source, nCropNum boxes, nCropNum already allocated destinations */
+AX_S32 AX_IVPS_CropResizeV2Tdp(const AX_VIDEO_FRAME_T *ptSrc, const AX_IVPS_RECT_T tBox[], AX_U32 nCropNum,
+                               AX_VIDEO_FRAME_T *ptDst[], const AX_IVPS_CROP_RESIZE_ATTR_T *ptAttr);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _AX_IVPS_API_H_
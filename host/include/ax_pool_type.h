@@ -0,0 +1,61 @@
+/**************************************************************************************************
+ *
+ * Copyright (c) 2019-2023 Axera Semiconductor (Shanghai) Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Axera Semiconductor (Shanghai) Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Axera Semiconductor (Shanghai) Co., Ltd.
+ *
+ **************************************************************************************************/
+
+#ifndef _AX_POOL_TYPE_H_
+#define _AX_POOL_TYPE_H_
+
+#include "ax_global_type.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#define AX_MAX_COMM_POOLS               16
+#define AX_MAX_PARTITION_NAME_LEN       32
+
+#define AX_ERR_POOL_NULL_PTR            AX_DEF_ERR(AX_ID_POOL, AX_ERR_LEVEL_ERROR, AX_ERR_NULLPTR)
+#define AX_ERR_POOL_ILLEGAL_PARAM       AX_DEF_ERR(AX_ID_POOL, AX_ERR_LEVEL_ERROR, AX_ERR_ILLEGAL_PARAMETER)
+#define AX_ERR_POOL_NOMEM               AX_DEF_ERR(AX_ID_POOL, AX_ERR_LEVEL_ERROR, AX_ERR_NOMEM)
+#define AX_ERR_POOL_UNEXIST             AX_DEF_ERR(AX_ID_POOL, AX_ERR_LEVEL_ERROR, AX_ERR_UNEXIST)
+#define AX_ERR_POOL_NOT_PERM            AX_DEF_ERR(AX_ID_POOL, AX_ERR_LEVEL_ERROR, AX_ERR_NOT_PERM)
+
+typedef enum {
+    AX_POOL_CACHE_MODE_NONCACHE = 0,
+    AX_POOL_CACHE_MODE_CACHED   = 1,
+    AX_POOL_CACHE_MODE_BUTT
+} AX_POOL_CACHE_MODE_E;
+
+typedef enum {
+    AX_POOL_SOURCE_COMMON  = 0,
+    AX_POOL_SOURCE_PRIVATE = 1,
+    AX_POOL_SOURCE_USER    = 2,
+    AX_POOL_SOURCE_BUTT
+} AX_POOL_SOURCE_E;
+
+typedef struct {
+    AX_U64                  MetaSize;
+    AX_U64                  BlkSize;
+    AX_U32                  BlkCnt;
+    AX_BOOL                 IsMergeMode;
+    AX_POOL_CACHE_MODE_E    CacheMode;
+    AX_S8                   PartitionName[AX_MAX_PARTITION_NAME_LEN];
+    AX_S8                   PoolName[AX_MAX_PARTITION_NAME_LEN];
+} AX_POOL_CONFIG_T;
+
+typedef struct {
+    AX_POOL_CONFIG_T        CommPool[AX_MAX_COMM_POOLS];
+} AX_POOL_FLOORPLAN_T;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _AX_POOL_TYPE_H_
@@ -0,0 +1,70 @@
+/**************************************************************************************************
+ *
+ * Copyright (c) 2019-2023 Axera Semiconductor (Shanghai) Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Axera Semiconductor (Shanghai) Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Axera Semiconductor (Shanghai) Co., Ltd.
+ *
+ **************************************************************************************************/
+
+#ifndef _AX_SYS_API_H_
+#define _AX_SYS_API_H_
+
+#include "ax_global_type.h"
+#include "ax_pool_type.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#define AX_ERR_SYS_NULL_PTR             AX_DEF_ERR(AX_ID_SYS, AX_ERR_LEVEL_ERROR, AX_ERR_NULLPTR)
+#define AX_ERR_SYS_ILLEGAL_PARAM        AX_DEF_ERR(AX_ID_SYS, AX_ERR_LEVEL_ERROR, AX_ERR_ILLEGAL_PARAMETER)
+#define AX_ERR_SYS_NOMEM                AX_DEF_ERR(AX_ID_SYS, AX_ERR_LEVEL_ERROR, AX_ERR_NOMEM)
+#define AX_ERR_SYS_UNEXIST              AX_DEF_ERR(AX_ID_SYS, AX_ERR_LEVEL_ERROR, AX_ERR_UNEXIST)
+#define AX_ERR_SYS_NOT_INIT             AX_DEF_ERR(AX_ID_SYS, AX_ERR_LEVEL_ERROR, AX_ERR_NOT_INITED)
+
+/* sys */
+AX_S32 AX_SYS_Init(AX_VOID);
+AX_S32 AX_SYS_Deinit(AX_VOID);
+
+/*
+ * CMM
+ * host: blocks come from aligned malloc, physical addresses are fake but unique
+ * and can be translated back with AX_SYS_Mmap / AX_SYS_MmapCache (offsets included).
+ */
+AX_S32 AX_SYS_MemAlloc(AX_U64 *phyaddr, AX_VOID **pviraddr, AX_U32 size, AX_U32 align, const AX_S8 *token);
+AX_S32 AX_SYS_MemAllocCached(AX_U64 *phyaddr, AX_VOID **pviraddr, AX_U32 size, AX_U32 align, const AX_S8 *token);
+AX_S32 AX_SYS_MemFree(AX_U64 phyaddr, AX_VOID *pviraddr);
+AX_VOID *AX_SYS_Mmap(AX_U64 aPhyAddr, AX_U32 size);
+AX_VOID *AX_SYS_MmapCache(AX_U64 aPhyAddr, AX_U32 size);
+AX_S32 AX_SYS_Munmap(AX_VOID *pviraddr, AX_U32 size);
+AX_S32 AX_SYS_MflushCache(AX_U64 phyaddr, AX_VOID *pviraddr, AX_U32 size);
+AX_S32 AX_SYS_MinvalidateCache(AX_U64 phyaddr, AX_VOID *pviraddr, AX_U32 size);
+AX_U64 AX_SYS_GetTickCount(AX_VOID);
+
+/* pool */
+AX_S32 AX_POOL_SetConfig(const AX_POOL_FLOORPLAN_T *pPoolFloorPlan);
+AX_S32 AX_POOL_GetConfig(AX_POOL_FLOORPLAN_T *pPoolFloorPlan);
+AX_S32 AX_POOL_Init(AX_VOID);
+AX_S32 AX_POOL_Exit(AX_VOID);
+AX_POOL AX_POOL_CreatePool(AX_POOL_CONFIG_T *pPoolConfig);
+AX_S32 AX_POOL_DestroyPool(AX_POOL PoolId);
+AX_BLK AX_POOL_GetBlock(AX_POOL PoolId, AX_U64 BlkSize, const AX_S8 *pPartitionName);
+AX_S32 AX_POOL_ReleaseBlock(AX_BLK BlockId);
+AX_BLK AX_POOL_PhysAddr2Handle(AX_U64 PhysAddr);
+AX_U64 AX_POOL_Handle2PhysAddr(AX_BLK BlockId);
+AX_U64 AX_POOL_Handle2MetaPhysAddr(AX_BLK BlockId);
+AX_POOL AX_POOL_Handle2PoolId(AX_BLK BlockId);
+AX_U64 AX_POOL_Handle2BlkSize(AX_BLK BlockId);
+AX_VOID *AX_POOL_GetBlockVirAddr(AX_BLK BlockId);
+AX_VOID *AX_POOL_GetMetaVirAddr(AX_BLK BlockId);
+AX_S32 AX_POOL_IncreaseRefCnt(AX_BLK BlockId);
+AX_S32 AX_POOL_DecreaseRefCnt(AX_BLK BlockId);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _AX_SYS_API_H_
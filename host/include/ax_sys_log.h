@@ -0,0 +1,47 @@
+/**************************************************************************************************
+ *
+ * Copyright (c) 2019-2023 Axera Semiconductor (Shanghai) Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Axera Semiconductor (Shanghai) Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Axera Semiconductor (Shanghai) Co., Ltd.
+ *
+ **************************************************************************************************/
+
+#ifndef _AX_SYS_LOG_H_
+#define _AX_SYS_LOG_H_
+
+#include "ax_global_type.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+typedef enum {
+    SYS_LOG_MIN     = -1,
+    SYS_LOG_EMERG   = 0,
+    SYS_LOG_ALERT   = 1,
+    SYS_LOG_CRIT    = 2,
+    SYS_LOG_ERROR   = 3,
+    SYS_LOG_WARN    = 4,
+    SYS_LOG_NOTICE  = 5,
+    SYS_LOG_INFO    = 6,
+    SYS_LOG_DEBUG   = 7,
+    SYS_LOG_MAX
+} AX_LOG_LEVEL_E;
+
+/* host: level is taken from env AX_HOST_LOG_LEVEL (default SYS_LOG_WARN) */
+AX_VOID AX_SYS_LogPrint_Ex(AX_LOG_LEVEL_E eLv, const AX_CHAR *pszTag, AX_MOD_ID_E eModId, const AX_CHAR *pszFmt, ...);
+
+#define AX_LOG_ERR(tag, id, fmt, ...)       AX_SYS_LogPrint_Ex(SYS_LOG_ERROR,  tag, id, fmt, ##__VA_ARGS__)
+#define AX_LOG_WARN(tag, id, fmt, ...)      AX_SYS_LogPrint_Ex(SYS_LOG_WARN,   tag, id, fmt, ##__VA_ARGS__)
+#define AX_LOG_NOTICE(tag, id, fmt, ...)    AX_SYS_LogPrint_Ex(SYS_LOG_NOTICE, tag, id, fmt, ##__VA_ARGS__)
+#define AX_LOG_INFO(tag, id, fmt, ...)      AX_SYS_LogPrint_Ex(SYS_LOG_INFO,   tag, id, fmt, ##__VA_ARGS__)
+#define AX_LOG_DBG(tag, id, fmt, ...)       AX_SYS_LogPrint_Ex(SYS_LOG_DEBUG,  tag, id, fmt, ##__VA_ARGS__)
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _AX_SYS_LOG_H_
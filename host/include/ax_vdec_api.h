@@ -0,0 +1,132 @@
+/**************************************************************************************************
+ *
+ * Copyright (c) 2019-2023 Axera Semiconductor (Shanghai) Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Axera Semiconductor (Shanghai) Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Axera Semiconductor (Shanghai) Co., Ltd.
+ *
+ **************************************************************************************************/
+
+#ifndef _AX_VDEC_API_H_
+#define _AX_VDEC_API_H_
+
+#include "ax_global_type.h"
+#include "ax_pool_type.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/*
+ * host: pass-through decoder. A stream pack of exactly u32PicWidth * u32PicHeight * 3 / 2 bytes
+ * is taken as a raw NV12 picture, any other pack produces a mid-gray picture of that size.
+ */
+
+#define AX_VDEC_MAX_GRP_NUM             16
+
+#define AX_ERR_VDEC_NULL_PTR            AX_DEF_ERR(AX_ID_VDEC, AX_ERR_LEVEL_ERROR, AX_ERR_NULLPTR)
+#define AX_ERR_VDEC_ILLEGAL_PARAM       AX_DEF_ERR(AX_ID_VDEC, AX_ERR_LEVEL_ERROR, AX_ERR_ILLEGAL_PARAMETER)
+#define AX_ERR_VDEC_INVALID_GRPID       AX_DEF_ERR(AX_ID_VDEC, AX_ERR_LEVEL_ERROR, AX_ERR_INVALID_GRPID)
+#define AX_ERR_VDEC_EXIST               AX_DEF_ERR(AX_ID_VDEC, AX_ERR_LEVEL_ERROR, AX_ERR_EXIST)
+#define AX_ERR_VDEC_UNEXIST             AX_DEF_ERR(AX_ID_VDEC, AX_ERR_LEVEL_ERROR, AX_ERR_UNEXIST)
+#define AX_ERR_VDEC_NOT_INIT            AX_DEF_ERR(AX_ID_VDEC, AX_ERR_LEVEL_ERROR, AX_ERR_NOT_INITED)
+#define AX_ERR_VDEC_NOMEM               AX_DEF_ERR(AX_ID_VDEC, AX_ERR_LEVEL_ERROR, AX_ERR_NOMEM)
+#define AX_ERR_VDEC_BUF_EMPTY           AX_DEF_ERR(AX_ID_VDEC, AX_ERR_LEVEL_ERROR, AX_ERR_BUF_EMPTY)
+#define AX_ERR_VDEC_TIMED_OUT           AX_DEF_ERR(AX_ID_VDEC, AX_ERR_LEVEL_ERROR, AX_ERR_TIMED_OUT)
+
+typedef AX_S32 AX_VDEC_GRP;
+
+typedef enum {
+    AX_VDEC_INPUT_MODE_NAL = 0,
+    AX_VDEC_INPUT_MODE_FRAME,
+    AX_VDEC_INPUT_MODE_STREAM,
+    AX_VDEC_INPUT_MODE_COMPAT,
+    AX_VDEC_INPUT_MODE_BUTT
+} AX_VDEC_INPUT_MODE_E;
+
+typedef enum {
+    AX_VDEC_OUTPUT_ORDER_DISP = 0,
+    AX_VDEC_OUTPUT_ORDER_DEC,
+    AX_VDEC_OUTPUT_ORDER_BUTT
+} AX_VDEC_OUTPUT_ORDER_E;
+
+typedef enum {
+    AX_VDEC_DISPLAY_MODE_PREVIEW = 0,
+    AX_VDEC_DISPLAY_MODE_PLAYBACK,
+    AX_VDEC_DISPLAY_MODE_BUTT
+} AX_VDEC_DISPLAY_MODE_E;
+
+typedef enum {
+    VIDEO_DEC_MODE_IPB = 0,
+    VIDEO_DEC_MODE_IP,
+    VIDEO_DEC_MODE_I,
+    VIDEO_DEC_MODE_BUTT
+} AX_VDEC_MODE_E;
+
+typedef struct {
+    AX_U32                  u32MaxGroupCount;
+    AX_U32                  u32Reserved[4];
+} AX_VDEC_MOD_ATTR_T;
+
+typedef struct {
+    AX_PAYLOAD_TYPE_E       enCodecType;
+    AX_VDEC_INPUT_MODE_E    enInputMode;
+    AX_LINK_MODE_E          enLinkMode;
+    AX_U32                  u32MaxPicWidth;
+    AX_U32                  u32MaxPicHeight;
+    AX_U32                  u32PicWidth;
+    AX_U32                  u32PicHeight;
+    AX_U32                  u32FrameHeight;
+    AX_U32                  u32StreamBufSize;
+    AX_U32                  u32FrameBufCnt;
+    AX_S32                  s32DestroyTimeout;
+    AX_VDEC_OUTPUT_ORDER_E  enOutOrder;
+    AX_POOL_SOURCE_E        enVdecVbSource;
+} AX_VDEC_GRP_ATTR_T;
+
+typedef struct {
+    AX_VDEC_MODE_E          enVdecMode;
+    AX_U32                  u32Reserved[4];
+} AX_VDEC_GRP_PARAM_T;
+
+typedef struct {
+    AX_S32                  s32RecvPicNum;
+} AX_VDEC_RECV_PIC_PARAM_T;
+
+typedef struct {
+    AX_U64                  u64PTS;
+    AX_U64                  u64PhyAddr;
+    AX_U8*                  pu8Addr;
+    AX_U32                  u32StreamPackLen;
+    AX_BOOL                 bEndOfFrame;
+    AX_BOOL                 bEndOfStream;
+    AX_BOOL                 bSkipDisplay;
+    AX_U64                  u64UserData;
+} AX_VDEC_STREAM_T;
+
+AX_S32 AX_VDEC_Init(const AX_VDEC_MOD_ATTR_T *pstModAttr);
+AX_S32 AX_VDEC_Deinit(AX_VOID);
+
+AX_S32 AX_VDEC_CreateGrp(AX_VDEC_GRP VdGrp, const AX_VDEC_GRP_ATTR_T *pstGrpAttr);
+AX_S32 AX_VDEC_DestroyGrp(AX_VDEC_GRP VdGrp);
+AX_S32 AX_VDEC_GetGrpParam(AX_VDEC_GRP VdGrp, AX_VDEC_GRP_PARAM_T *pstGrpParam);
+AX_S32 AX_VDEC_SetGrpParam(AX_VDEC_GRP VdGrp, const AX_VDEC_GRP_PARAM_T *pstGrpParam);
+AX_S32 AX_VDEC_SetDisplayMode(AX_VDEC_GRP VdGrp, AX_VDEC_DISPLAY_MODE_E enDisplayMode);
+
+AX_S32 AX_VDEC_AttachPool(AX_VDEC_GRP VdGrp, AX_POOL PoolId);
+AX_S32 AX_VDEC_DetachPool(AX_VDEC_GRP VdGrp);
+AX_U32 AX_VDEC_GetPicBufferSize(AX_U32 uWidth, AX_U32 uHeight, AX_PAYLOAD_TYPE_E enType);
+
+AX_S32 AX_VDEC_StartRecvStream(AX_VDEC_GRP VdGrp, const AX_VDEC_RECV_PIC_PARAM_T *pstRecvParam);
+AX_S32 AX_VDEC_StopRecvStream(AX_VDEC_GRP VdGrp);
+AX_S32 AX_VDEC_SendStream(AX_VDEC_GRP VdGrp, const AX_VDEC_STREAM_T *pstStream, AX_S32 s32MilliSec);
+AX_S32 AX_VDEC_GetFrame(AX_VDEC_GRP VdGrp, AX_VIDEO_FRAME_INFO_T *pstFrameInfo, AX_S32 s32MilliSec);
+AX_S32 AX_VDEC_ReleaseFrame(AX_VDEC_GRP VdGrp, const AX_VIDEO_FRAME_INFO_T *pstFrameInfo);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _AX_VDEC_API_H_
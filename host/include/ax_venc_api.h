@@ -0,0 +1,192 @@
+/**************************************************************************************************
+ *
+ * Copyright (c) 2019-2023 Axera Semiconductor (Shanghai) Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Axera Semiconductor (Shanghai) Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Axera Semiconductor (Shanghai) Co., Ltd.
+ *
+ **************************************************************************************************/
+
+#ifndef _AX_VENC_API_H_
+#define _AX_VENC_API_H_
+
+#include "ax_global_type.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/*
+ * host: pass-through encoder. Every frame sent is returned as one stream pack holding the
+ * raw picture (tightly packed planes), so the output size is predictable for benchmarks.
+ */
+
+#define AX_VENC_MAX_CHN_NUM             16
+
+#define AX_ERR_VENC_NULL_PTR            AX_DEF_ERR(AX_ID_VENC, AX_ERR_LEVEL_ERROR, AX_ERR_NULLPTR)
+#define AX_ERR_VENC_ILLEGAL_PARAM       AX_DEF_ERR(AX_ID_VENC, AX_ERR_LEVEL_ERROR, AX_ERR_ILLEGAL_PARAMETER)
+#define AX_ERR_VENC_INVALID_CHNID       AX_DEF_ERR(AX_ID_VENC, AX_ERR_LEVEL_ERROR, AX_ERR_INVALID_CHNID)
+#define AX_ERR_VENC_EXIST               AX_DEF_ERR(AX_ID_VENC, AX_ERR_LEVEL_ERROR, AX_ERR_EXIST)
+#define AX_ERR_VENC_UNEXIST             AX_DEF_ERR(AX_ID_VENC, AX_ERR_LEVEL_ERROR, AX_ERR_UNEXIST)
+#define AX_ERR_VENC_NOT_INIT            AX_DEF_ERR(AX_ID_VENC, AX_ERR_LEVEL_ERROR, AX_ERR_NOT_INITED)
+#define AX_ERR_VENC_NOMEM               AX_DEF_ERR(AX_ID_VENC, AX_ERR_LEVEL_ERROR, AX_ERR_NOMEM)
+#define AX_ERR_VENC_BUF_FULL            AX_DEF_ERR(AX_ID_VENC, AX_ERR_LEVEL_ERROR, AX_ERR_BUF_FULL)
+#define AX_ERR_VENC_TIMED_OUT           AX_DEF_ERR(AX_ID_VENC, AX_ERR_LEVEL_ERROR, AX_ERR_TIMED_OUT)
+
+typedef AX_S32 VENC_CHN;
+
+typedef enum {
+    AX_VENC_VIDEO_ENCODER = 1,
+    AX_VENC_JPEG_ENCODER  = 2,
+    AX_VENC_MULTI_ENCODER = 3,
+    AX_VENC_ENCODER_BUTT
+} AX_VENC_ENCODER_TYPE_E;
+
+typedef enum {
+    AX_VENC_H264_BASE_PROFILE = 0,
+    AX_VENC_H264_MAIN_PROFILE,
+    AX_VENC_H264_HIGH_PROFILE,
+    AX_VENC_H264_HIGH_10_PROFILE,
+    AX_VENC_HEVC_MAIN_PROFILE,
+    AX_VENC_HEVC_MAIN_STILL_PROFILE,
+    AX_VENC_HEVC_MAIN_10_PROFILE,
+    AX_VENC_PROFILE_BUTT
+} AX_VENC_PROFILE_E;
+
+typedef enum {
+    AX_VENC_H264_LEVEL_1 = 10,
+    AX_VENC_H264_LEVEL_3 = 30,
+    AX_VENC_H264_LEVEL_4 = 40,
+    AX_VENC_H264_LEVEL_4_1 = 41,
+    AX_VENC_H264_LEVEL_5 = 50,
+    AX_VENC_H264_LEVEL_5_1 = 51,
+    AX_VENC_H264_LEVEL_5_2 = 52,
+    AX_VENC_LEVEL_BUTT
+} AX_VENC_LEVEL_E;
+
+typedef enum {
+    AX_VENC_RC_MODE_H264CBR = 1,
+    AX_VENC_RC_MODE_H264VBR,
+    AX_VENC_RC_MODE_H264AVBR,
+    AX_VENC_RC_MODE_H264FIXQP,
+    AX_VENC_RC_MODE_H265CBR,
+    AX_VENC_RC_MODE_H265VBR,
+    AX_VENC_RC_MODE_H265AVBR,
+    AX_VENC_RC_MODE_H265FIXQP,
+    AX_VENC_RC_MODE_BUTT
+} AX_VENC_RC_MODE_E;
+
+typedef enum {
+    AX_VENC_GOPMODE_NORMALP = 0,
+    AX_VENC_GOPMODE_ONELTR,
+    AX_VENC_GOPMODE_SVC_T,
+    AX_VENC_GOPMODE_BUTT
+} AX_VENC_GOP_MODE_E;
+
+typedef struct {
+    AX_U32                  u32TotalThreadNum;
+    AX_BOOL                 bExplicitSched;
+} AX_VENC_MOD_THD_ATTR_T;
+
+typedef struct {
+    AX_VENC_ENCODER_TYPE_E  enVencType;
+    AX_VENC_MOD_THD_ATTR_T  stModThdAttr;
+} AX_VENC_MOD_ATTR_T;
+
+typedef struct {
+    AX_PAYLOAD_TYPE_E       enType;
+    AX_U32                  u32MaxPicWidth;
+    AX_U32                  u32MaxPicHeight;
+    AX_VENC_PROFILE_E       enProfile;
+    AX_VENC_LEVEL_E         enLevel;
+    AX_U32                  u32BufSize;
+    AX_U32                  u32PicWidthSrc;
+    AX_U32                  u32PicHeightSrc;
+    AX_U32                  u32CropOffsetX;
+    AX_U32                  u32CropOffsetY;
+    AX_U32                  u32CropWidth;
+    AX_U32                  u32CropHeight;
+    AX_LINK_MODE_E          enLinkMode;
+    AX_U8                   u8InFifoDepth;
+    AX_U8                   u8OutFifoDepth;
+} AX_VENC_ATTR_T;
+
+typedef struct {
+    AX_F32                  fSrcFrameRate;
+    AX_F32                  fDstFrameRate;
+} AX_VENC_FRAME_RATE_T;
+
+typedef struct {
+    AX_U32                  u32Gop;
+    AX_U32                  u32StatTime;
+    AX_U32                  u32BitRate;
+    AX_U32                  u32MaxQp;
+    AX_U32                  u32MinQp;
+    AX_U32                  u32MaxIQp;
+    AX_U32                  u32MinIQp;
+    AX_U32                  u32MaxIprop;
+    AX_U32                  u32MinIprop;
+    AX_S32                  s32IntraQpDelta;
+} AX_VENC_H264_CBR_T;
+
+typedef struct {
+    AX_VENC_RC_MODE_E       enRcMode;
+    AX_S32                  s32FirstFrameStartQp;
+    AX_VENC_FRAME_RATE_T    stFrameRate;
+    union {
+        AX_VENC_H264_CBR_T  stH264Cbr;
+        AX_U8               u8Reserved[128];
+    };
+} AX_VENC_RC_ATTR_T;
+
+typedef struct {
+    AX_VENC_GOP_MODE_E      enGopMode;
+    AX_U32                  u32Reserved[8];
+} AX_VENC_GOP_ATTR_T;
+
+typedef struct {
+    AX_VENC_ATTR_T          stVencAttr;
+    AX_VENC_RC_ATTR_T       stRcAttr;
+    AX_VENC_GOP_ATTR_T      stGopAttr;
+} AX_VENC_CHN_ATTR_T;
+
+typedef struct {
+    AX_S32                  s32RecvPicNum;
+} AX_VENC_RECV_PIC_PARAM_T;
+
+typedef struct {
+    AX_U64                  ulPhyAddr;
+    AX_U8*                  pu8Addr;
+    AX_U32                  u32Len;
+    AX_U64                  u64PTS;
+    AX_U64                  u64SeqNum;
+    AX_U64                  u64UserData;
+    AX_PAYLOAD_TYPE_E       enType;
+    AX_BOOL                 bFrameEnd;
+} AX_VENC_PACK_T;
+
+typedef struct {
+    AX_VENC_PACK_T          stPack;
+    AX_U32                  u32Seq;
+} AX_VENC_STREAM_T;
+
+AX_S32 AX_VENC_Init(const AX_VENC_MOD_ATTR_T *pstModAttr);
+AX_S32 AX_VENC_Deinit(AX_VOID);
+
+AX_S32 AX_VENC_CreateChn(VENC_CHN VeChn, const AX_VENC_CHN_ATTR_T *pstAttr);
+AX_S32 AX_VENC_DestroyChn(VENC_CHN VeChn);
+
+AX_S32 AX_VENC_StartRecvFrame(VENC_CHN VeChn, const AX_VENC_RECV_PIC_PARAM_T *pstRecvParam);
+AX_S32 AX_VENC_StopRecvFrame(VENC_CHN VeChn);
+
+AX_S32 AX_VENC_SendFrame(VENC_CHN VeChn, const AX_VIDEO_FRAME_INFO_T *pstFrame, AX_S32 s32MilliSec);
+AX_S32 AX_VENC_GetStream(VENC_CHN VeChn, AX_VENC_STREAM_T *pstStream, AX_S32 s32MilliSec);
+AX_S32 AX_VENC_ReleaseStream(VENC_CHN VeChn, const AX_VENC_STREAM_T *pstStream);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _AX_VENC_API_H_
@@ -0,0 +1,289 @@
+/**************************************************************************************************
+ *
+ * Copyright (c) 2019-2023 Axera Semiconductor (Shanghai) Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Axera Semiconductor (Shanghai) Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Axera Semiconductor (Shanghai) Co., Ltd.
+ *
+ **************************************************************************************************/
+
+#include "ax_engine_api.h"
+#include "ax_host_engine.h"
+#include "ax_host_internal.h"
+
+#include <cstring>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    /// @brief registered model, owns deep copies of the io metas
+    struct HostModel
+    {
+        std::string name;
+        std::vector<AX_ENGINE_IOMETA_T> inputs;
+        std::vector<AX_ENGINE_IOMETA_T> outputs;
+        std::vector<std::string> names;
+        std::vector<std::vector<AX_S32>> shapes;
+        std::vector<std::vector<AX_S32>> strides;
+        std::vector<AX_ENGINE_IOMETA_EX_T> extras;
+        AX_ENGINE_IO_INFO_T info;
+        AX_HOST_ENGINE_RUN_FN run;
+        AX_VOID* user_data;
+        AX_U32 latency_us;
+    };
+
+    struct HostHandle
+    {
+        std::shared_ptr<HostModel> model;
+        bool has_context;
+    };
+
+    std::mutex g_engine_lock;
+    std::map<std::string, std::shared_ptr<HostModel>> g_models;
+    std::shared_ptr<HostModel> g_last_model;
+    int g_engine_init_cnt = 0;
+
+    /* single simulated NPU core: RunSync calls from all handles are serialized */
+    std::mutex g_npu_lock;
+
+    void copy_metas(HostModel& model, const AX_ENGINE_IOMETA_T* src, AX_U32 num, std::vector<AX_ENGINE_IOMETA_T>& dst)
+    {
+        for (AX_U32 i = 0; i < num; i++)
+        {
+            AX_ENGINE_IOMETA_T meta = src[i];
+            model.names.emplace_back(src[i].pName ? src[i].pName : "");
+            model.shapes.emplace_back(src[i].pShape, src[i].pShape + (src[i].pShape ? src[i].nShapeSize : 0));
+            model.strides.emplace_back(src[i].pStride, src[i].pStride + (src[i].pStride ? src[i].nShapeSize : 0));
+            model.extras.push_back(src[i].pExtraMeta ? *src[i].pExtraMeta : AX_ENGINE_IOMETA_EX_T());
+            dst.push_back(meta);
+        }
+    }
+
+    /// @brief pointers are fixed up once all vectors reached their final size
+    void fixup_metas(HostModel& model)
+    {
+        size_t k = 0;
+        auto fixup = [&model, &k](std::vector<AX_ENGINE_IOMETA_T>& metas) {
+            for (auto& m : metas)
+            {
+                m.pName = (AX_CHAR*)model.names[k].c_str();
+                m.pShape = model.shapes[k].empty() ? nullptr : model.shapes[k].data();
+                m.pStride = model.strides[k].empty() ? nullptr : model.strides[k].data();
+                m.pExtraMeta = m.pExtraMeta ? &model.extras[k] : nullptr;
+                k++;
+            }
+        };
+        fixup(model.inputs);
+        fixup(model.outputs);
+
+        memset(&model.info, 0, sizeof(model.info));
+        model.info.pInputs = model.inputs.data();
+        model.info.nInputSize = model.inputs.size();
+        model.info.pOutputs = model.outputs.data();
+        model.info.nOutputSize = model.outputs.size();
+        model.info.nMaxBatchSize = 1;
+        model.info.bDynamicBatchSize = AX_FALSE;
+    }
+
+    std::shared_ptr<HostModel> select_model(const AX_VOID* pData, AX_U32 nDataSize)
+    {
+        const size_t magic_len = strlen(AX_HOST_MODEL_MAGIC);
+        if (pData && nDataSize > magic_len && 0 == memcmp(pData, AX_HOST_MODEL_MAGIC, magic_len))
+        {
+            const char* p = (const char*)pData + magic_len;
+            size_t len = 0;
+            while (magic_len + len < nDataSize && p[len] != '\0' && p[len] != '\n' && p[len] != '\r' && p[len] != ' ')
+                len++;
+            auto it = g_models.find(std::string(p, len));
+            if (it != g_models.end())
+                return it->second;
+            HLOGW(AX_ID_ENGINE, "host model %s not registered", std::string(p, len).c_str());
+        }
+        return g_last_model;
+    }
+}
+
+AX_S32 AX_HOST_ENGINE_RegisterModel(const AX_HOST_ENGINE_MODEL_T* pModel)
+{
+    if (!pModel || !pModel->pName)
+        return AX_ERR_ENGINE_NULL_PTR;
+    if ((pModel->nInputSize && !pModel->pInputs) || (pModel->nOutputSize && !pModel->pOutputs))
+        return AX_ERR_ENGINE_ILLEGAL_PARAM;
+
+    auto model = std::make_shared<HostModel>();
+    model->name = pModel->pName;
+    copy_metas(*model, pModel->pInputs, pModel->nInputSize, model->inputs);
+    copy_metas(*model, pModel->pOutputs, pModel->nOutputSize, model->outputs);
+    fixup_metas(*model);
+    model->run = pModel->pfnRun;
+    model->user_data = pModel->pUserData;
+    model->latency_us = pModel->nLatencyUs;
+
+    std::lock_guard<std::mutex> lg(g_engine_lock);
+    g_models[model->name] = model;
+    g_last_model = model;
+    return 0;
+}
+
+AX_S32 AX_HOST_ENGINE_UnregisterModel(const AX_CHAR* pName)
+{
+    if (!pName)
+        return AX_ERR_ENGINE_NULL_PTR;
+
+    std::lock_guard<std::mutex> lg(g_engine_lock);
+    auto it = g_models.find(pName);
+    if (it == g_models.end())
+        return AX_ERR_ENGINE_UNEXIST;
+    // open handles keep their own reference
+    if (g_last_model == it->second)
+        g_last_model.reset();
+    g_models.erase(it);
+    if (!g_last_model && !g_models.empty())
+        g_last_model = g_models.rbegin()->second;
+    return 0;
+}
+
+AX_S32 AX_ENGINE_Init(AX_VOID)
+{
+    std::lock_guard<std::mutex> lg(g_engine_lock);
+    g_engine_init_cnt++;
+    return 0;
+}
+
+AX_S32 AX_ENGINE_Deinit(AX_VOID)
+{
+    std::lock_guard<std::mutex> lg(g_engine_lock);
+    if (g_engine_init_cnt > 0)
+        g_engine_init_cnt--;
+    return 0;
+}
+
+const AX_CHAR* AX_ENGINE_GetVersion(AX_VOID)
+{
+    return "host";
+}
+
+AX_S32 AX_ENGINE_GetVNPUAttr(AX_ENGINE_NPU_ATTR_T* pAttr)
+{
+    if (!pAttr)
+        return AX_ERR_ENGINE_NULL_PTR;
+    memset(pAttr, 0, sizeof(*pAttr));
+    pAttr->eHardMode = AX_ENGINE_VIRTUAL_NPU_DISABLE;
+    return 0;
+}
+
+AX_S32 AX_ENGINE_GetModelType(const AX_VOID* pData, AX_U32 nDataSize, AX_ENGINE_MODEL_TYPE_T* pModelType)
+{
+    (void)pData;
+    (void)nDataSize;
+    if (!pModelType)
+        return AX_ERR_ENGINE_NULL_PTR;
+    *pModelType = AX_ENGINE_MODEL_TYPE0;
+    return 0;
+}
+
+AX_S32 AX_ENGINE_CreateHandle(AX_ENGINE_HANDLE* pHandle, const AX_VOID* pData, AX_U32 nDataSize)
+{
+    if (!pHandle)
+        return AX_ERR_ENGINE_NULL_PTR;
+
+    std::lock_guard<std::mutex> lg(g_engine_lock);
+    if (g_engine_init_cnt == 0)
+        return AX_ERR_ENGINE_NOT_INIT;
+
+    auto model = select_model(pData, nDataSize);
+    if (!model)
+    {
+        HLOGE(AX_ID_ENGINE, "no host model registered");
+        return AX_ERR_ENGINE_UNEXIST;
+    }
+
+    HostHandle* handle = new HostHandle();
+    handle->model = model;
+    handle->has_context = false;
+    *pHandle = handle;
+    return 0;
+}
+
+AX_S32 AX_ENGINE_CreateHandleV2(AX_ENGINE_HANDLE* pHandle, const AX_VOID* pData, AX_U32 nDataSize, AX_ENGINE_HANDLE_EXTRA_T* pExtraParam)
+{
+    (void)pExtraParam;
+    return AX_ENGINE_CreateHandle(pHandle, pData, nDataSize);
+}
+
+AX_S32 AX_ENGINE_DestroyHandle(AX_ENGINE_HANDLE nHandle)
+{
+    if (!nHandle)
+        return AX_ERR_ENGINE_NULL_PTR;
+    delete (HostHandle*)nHandle;
+    return 0;
+}
+
+AX_S32 AX_ENGINE_GetIOInfo(AX_ENGINE_HANDLE nHandle, AX_ENGINE_IO_INFO_T** pIO)
+{
+    if (!nHandle || !pIO)
+        return AX_ERR_ENGINE_NULL_PTR;
+    *pIO = &((HostHandle*)nHandle)->model->info;
+    return 0;
+}
+
+AX_S32 AX_ENGINE_CreateContext(AX_ENGINE_HANDLE handle)
+{
+    if (!handle)
+        return AX_ERR_ENGINE_NULL_PTR;
+    ((HostHandle*)handle)->has_context = true;
+    return 0;
+}
+
+AX_S32 AX_ENGINE_RunSync(AX_ENGINE_HANDLE handle, AX_ENGINE_IO_T* pIO)
+{
+    if (!handle || !pIO)
+        return AX_ERR_ENGINE_NULL_PTR;
+
+    HostHandle* h = (HostHandle*)handle;
+    HostModel& model = *h->model;
+    if (!h->has_context)
+        return AX_ERR_ENGINE_NOT_INIT;
+
+    if (pIO->nInputSize != model.info.nInputSize || pIO->nOutputSize != model.info.nOutputSize
+        || (pIO->nInputSize && !pIO->pInputs) || (pIO->nOutputSize && !pIO->pOutputs))
+        return AX_ERR_ENGINE_ILLEGAL_PARAM;
+
+    for (AX_U32 i = 0; i < pIO->nInputSize; i++)
+    {
+        if (!pIO->pInputs[i].pVirAddr || pIO->pInputs[i].nSize < model.inputs[i].nSize)
+        {
+            HLOGE(AX_ID_ENGINE, "input %s: buffer too small (%u < %u)", model.inputs[i].pName, pIO->pInputs[i].nSize, model.inputs[i].nSize);
+            return AX_ERR_ENGINE_ILLEGAL_PARAM;
+        }
+    }
+    for (AX_U32 i = 0; i < pIO->nOutputSize; i++)
+    {
+        if (!pIO->pOutputs[i].pVirAddr || pIO->pOutputs[i].nSize < model.outputs[i].nSize)
+        {
+            HLOGE(AX_ID_ENGINE, "output %s: buffer too small (%u < %u)", model.outputs[i].pName, pIO->pOutputs[i].nSize, model.outputs[i].nSize);
+            return AX_ERR_ENGINE_ILLEGAL_PARAM;
+        }
+    }
+
+    std::lock_guard<std::mutex> lg(g_npu_lock);
+    AX_S32 ret = 0;
+    if (model.run)
+    {
+        ret = model.run(&model.info, pIO, model.user_data);
+    }
+    else
+    {
+        for (AX_U32 i = 0; i < pIO->nOutputSize; i++)
+            memset(pIO->pOutputs[i].pVirAddr, 0, model.outputs[i].nSize);
+    }
+
+    if (model.latency_us)
+        std::this_thread::sleep_for(std::chrono::microseconds(model.latency_us));
+    return ret;
+}
@@ -0,0 +1,51 @@
+/**************************************************************************************************
+ *
+ * Copyright (c) 2019-2023 Axera Semiconductor (Shanghai) Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Axera Semiconductor (Shanghai) Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Axera Semiconductor (Shanghai) Co., Ltd.
+ *
+ **************************************************************************************************/
+
+#pragma once
+
+#include "ax_global_type.h"
+#include "ax_sys_log.h"
+
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+
+#define HOST_LOG_TAG        "HOST"
+
+#define HLOGE(id, fmt, ...)  AX_SYS_LogPrint_Ex(SYS_LOG_ERROR,  HOST_LOG_TAG, id, fmt, ##__VA_ARGS__)
+#define HLOGW(id, fmt, ...)  AX_SYS_LogPrint_Ex(SYS_LOG_WARN,   HOST_LOG_TAG, id, fmt, ##__VA_ARGS__)
+#define HLOGD(id, fmt, ...)  AX_SYS_LogPrint_Ex(SYS_LOG_DEBUG,  HOST_LOG_TAG, id, fmt, ##__VA_ARGS__)
+
+namespace host
+{
+    /// @brief translate a (fake) physical address, possibly inside a block, to its virtual address
+    /// @return nullptr if the address does not belong to any CMM block
+    AX_U8* cmm_phy2vir(AX_U64 phy);
+
+    /// @brief allocate a CMM block, shared by AX_SYS_MemAlloc* and the pools
+    AX_S32 cmm_alloc(AX_U64* phy, AX_VOID** vir, AX_U32 size, AX_U32 align, const AX_S8* token, bool cached);
+
+    AX_S32 cmm_free(AX_U64 phy);
+
+    /// @brief virtual address of plane @p index, derived from plane 0 when the frame only fills plane 0
+    AX_U8* frame_plane(const AX_VIDEO_FRAME_T* frame, int index);
+
+    /// @brief wait on @p cv until @p ready, timeout semantics of the SDK: -1 blocking, 0 non-blocking
+    template <typename Pred>
+    bool wait_for(std::unique_lock<std::mutex>& lk, std::condition_variable& cv, AX_S32 milli_sec, Pred ready)
+    {
+        if (milli_sec < 0)
+        {
+            cv.wait(lk, ready);
+            return true;
+        }
+        return cv.wait_for(lk, std::chrono::milliseconds(milli_sec), ready);
+    }
+}
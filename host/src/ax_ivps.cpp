@@ -0,0 +1,325 @@
+/**************************************************************************************************
+ *
+ * Copyright (c) 2019-2023 Axera Semiconductor (Shanghai) Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Axera Semiconductor (Shanghai) Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Axera Semiconductor (Shanghai) Co., Ltd.
+ *
+ **************************************************************************************************/
+
+#include "ax_ivps_api.h"
+#include "ax_host_internal.h"
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+/*
+ * CPU implementation of the TDP crop-resize. Bilinear in 16.16 fixed point, the chroma
+ * plane of semi-planar formats is resampled as interleaved 2-channel data at half resolution.
+ */
+
+namespace
+{
+    struct Plane
+    {
+        const AX_U8* data;
+        AX_U32 stride;
+    };
+
+    struct DstPlane
+    {
+        AX_U8* data;
+        AX_U32 stride;
+    };
+
+    inline bool is_semiplanar(AX_IMG_FORMAT_E fmt)
+    {
+        return fmt == AX_FORMAT_YUV420_SEMIPLANAR || fmt == AX_FORMAT_YUV420_SEMIPLANAR_VU;
+    }
+
+    inline int packed_channels(AX_IMG_FORMAT_E fmt)
+    {
+        switch (fmt)
+        {
+        case AX_FORMAT_RGB888:
+        case AX_FORMAT_BGR888:
+            return 3;
+        case AX_FORMAT_YUV400:
+            return 1;
+        default:
+            return 0;
+        }
+    }
+
+    inline bool is_supported(AX_IMG_FORMAT_E fmt)
+    {
+        return is_semiplanar(fmt) || packed_channels(fmt) > 0;
+    }
+
+    inline AX_U32 row_stride(const AX_VIDEO_FRAME_T* frame)
+    {
+        if (frame->u32PicStride[0])
+            return frame->u32PicStride[0];
+        int c = packed_channels(frame->enImgFormat);
+        return frame->u32Width * (c > 0 ? c : 1);
+    }
+
+    /// @brief resize a (w x h x c) region into a (dw x dh x c) region
+    void resize_bilinear(const AX_U8* src, AX_U32 src_stride, int sw, int sh,
+                         AX_U8* dst, AX_U32 dst_stride, int dw, int dh, int c, bool nearest)
+    {
+        if (sw <= 0 || sh <= 0 || dw <= 0 || dh <= 0)
+            return;
+
+        const int64_t fx = ((int64_t)sw << 16) / dw;
+        const int64_t fy = ((int64_t)sh << 16) / dh;
+
+        std::vector<int> x0(dw), x1(dw), wx(dw);
+        for (int x = 0; x < dw; x++)
+        {
+            int64_t sx = nearest ? ((int64_t)x * fx + fx / 2) : ((int64_t)x * fx + fx / 2 - (1 << 15));
+            if (sx < 0)
+                sx = 0;
+            int ix = (int)(sx >> 16);
+            if (ix >= sw - 1)
+            {
+                ix = sw - 1;
+                sx = (int64_t)ix << 16;
+            }
+            x0[x] = ix * c;
+            x1[x] = std::min(ix + 1, sw - 1) * c;
+            wx[x] = nearest ? 0 : (int)((sx >> 8) & 0xFF);
+        }
+
+        for (int y = 0; y < dh; y++)
+        {
+            int64_t sy = nearest ? ((int64_t)y * fy + fy / 2) : ((int64_t)y * fy + fy / 2 - (1 << 15));
+            if (sy < 0)
+                sy = 0;
+            int iy = (int)(sy >> 16);
+            if (iy >= sh - 1)
+            {
+                iy = sh - 1;
+                sy = (int64_t)iy << 16;
+            }
+            const int wy = nearest ? 0 : (int)((sy >> 8) & 0xFF);
+            const AX_U8* r0 = src + (size_t)iy * src_stride;
+            const AX_U8* r1 = src + (size_t)std::min(iy + 1, sh - 1) * src_stride;
+            AX_U8* out = dst + (size_t)y * dst_stride;
+
+            for (int x = 0; x < dw; x++)
+            {
+                const int a = wx[x];
+                for (int k = 0; k < c; k++)
+                {
+                    int top = r0[x0[x] + k] * (256 - a) + r0[x1[x] + k] * a;
+                    int bot = r1[x0[x] + k] * (256 - a) + r1[x1[x] + k] * a;
+                    out[x * c + k] = (AX_U8)((top * (256 - wy) + bot * wy + (1 << 15)) >> 16);
+                }
+            }
+        }
+    }
+
+    /// @brief BT.601 limited range, used for the padding colour of YUV destinations
+    void rgb_to_yuv(AX_U32 rgb, AX_U8& y, AX_U8& u, AX_U8& v)
+    {
+        int r = (rgb >> 16) & 0xFF, g = (rgb >> 8) & 0xFF, b = rgb & 0xFF;
+        y = (AX_U8)std::min(255, std::max(0, ((66 * r + 129 * g + 25 * b + 128) >> 8) + 16));
+        u = (AX_U8)std::min(255, std::max(0, ((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128));
+        v = (AX_U8)std::min(255, std::max(0, ((112 * r - 94 * g - 18 * b + 128) >> 8) + 128));
+    }
+
+    void fill_background(AX_VIDEO_FRAME_T* dst, AX_U32 color)
+    {
+        const AX_U32 stride = row_stride(dst);
+        AX_U8* p0 = host::frame_plane(dst, 0);
+        const AX_IMG_FORMAT_E fmt = dst->enImgFormat;
+
+        if (is_semiplanar(fmt))
+        {
+            AX_U8 y, u, v;
+            rgb_to_yuv(color, y, u, v);
+            AX_U8* p1 = host::frame_plane(dst, 1);
+            const AX_U32 uv_stride = dst->u32PicStride[1] ? dst->u32PicStride[1] : stride;
+            for (AX_U32 r = 0; r < dst->u32Height; r++)
+                memset(p0 + (size_t)r * stride, y, dst->u32Width);
+            const AX_U8 c0 = fmt == AX_FORMAT_YUV420_SEMIPLANAR ? u : v;
+            const AX_U8 c1 = fmt == AX_FORMAT_YUV420_SEMIPLANAR ? v : u;
+            for (AX_U32 r = 0; r < dst->u32Height / 2; r++)
+            {
+                AX_U8* row = p1 + (size_t)r * uv_stride;
+                for (AX_U32 x = 0; x + 1 < dst->u32Width + 1; x += 2)
+                {
+                    row[x] = c0;
+                    row[x + 1] = c1;
+                }
+            }
+        }
+        else if (fmt == AX_FORMAT_YUV400)
+        {
+            AX_U8 y, u, v;
+            rgb_to_yuv(color, y, u, v);
+            for (AX_U32 r = 0; r < dst->u32Height; r++)
+                memset(p0 + (size_t)r * stride, y, dst->u32Width);
+        }
+        else
+        {
+            AX_U8 rgb[3] = {(AX_U8)(color >> 16), (AX_U8)(color >> 8), (AX_U8)color};
+            if (fmt == AX_FORMAT_BGR888)
+                std::swap(rgb[0], rgb[2]);
+            for (AX_U32 r = 0; r < dst->u32Height; r++)
+            {
+                AX_U8* row = p0 + (size_t)r * stride;
+                for (AX_U32 x = 0; x < dst->u32Width; x++)
+                    memcpy(row + x * 3, rgb, 3);
+            }
+        }
+    }
+
+    inline int align_offset(int free_space, AX_IVPS_ASPECT_RATIO_ALIGN_E align)
+    {
+        switch (align)
+        {
+        case AX_IVPS_ASPECT_RATIO_HORIZONTAL_LEFT:
+            return 0;
+        case AX_IVPS_ASPECT_RATIO_HORIZONTAL_RIGHT:
+            return free_space;
+        default:
+            return free_space / 2;
+        }
+    }
+
+    AX_S32 crop_resize(const AX_VIDEO_FRAME_T* src, AX_IVPS_RECT_T box, AX_VIDEO_FRAME_T* dst,
+                       const AX_IVPS_CROP_RESIZE_ATTR_T* attr)
+    {
+        if (!src || !dst || !attr)
+            return AX_ERR_IVPS_NULL_PTR;
+
+        const AX_IMG_FORMAT_E fmt = src->enImgFormat;
+        if (!is_supported(fmt) || fmt != dst->enImgFormat)
+        {
+            HLOGE(AX_ID_IVPS, "unsupported format src %d dst %d", fmt, dst->enImgFormat);
+            return AX_ERR_IVPS_NOT_SUPPORT;
+        }
+
+        const bool yuv = is_semiplanar(fmt);
+        int cx = box.nX, cy = box.nY, cw = box.nW, ch = box.nH;
+        if (cw == 0 || ch == 0)
+        {
+            cx = 0;
+            cy = 0;
+            cw = src->u32Width;
+            ch = src->u32Height;
+        }
+        cx = std::max(0, cx);
+        cy = std::max(0, cy);
+        cw = std::min(cw, (int)src->u32Width - cx);
+        ch = std::min(ch, (int)src->u32Height - cy);
+        if (yuv)
+        {
+            cx &= ~1;
+            cy &= ~1;
+            cw &= ~1;
+            ch &= ~1;
+        }
+        if (cw <= 0 || ch <= 0 || dst->u32Width == 0 || dst->u32Height == 0)
+            return AX_ERR_IVPS_ILLEGAL_PARAM;
+
+        // destination rectangle
+        int ox = 0, oy = 0, ow = dst->u32Width, oh = dst->u32Height;
+        const AX_IVPS_ASPECT_RATIO_T& ar = attr->tAspectRatio;
+        if (ar.eMode == AX_IVPS_ASPECT_RATIO_AUTO)
+        {
+            if ((int64_t)cw * dst->u32Height > (int64_t)ch * dst->u32Width)
+                oh = (int)(((int64_t)ch * dst->u32Width + cw / 2) / cw);
+            else
+                ow = (int)(((int64_t)cw * dst->u32Height + ch / 2) / ch);
+            ow = std::max(1, std::min(ow, (int)dst->u32Width));
+            oh = std::max(1, std::min(oh, (int)dst->u32Height));
+            ox = align_offset(dst->u32Width - ow, ar.eAligns[0]);
+            oy = align_offset(dst->u32Height - oh, ar.eAligns[1]);
+        }
+        else if (ar.eMode == AX_IVPS_ASPECT_RATIO_MANUAL)
+        {
+            ox = std::max(0, (int)ar.tRect.nX);
+            oy = std::max(0, (int)ar.tRect.nY);
+            ow = std::min((int)ar.tRect.nW, (int)dst->u32Width - ox);
+            oh = std::min((int)ar.tRect.nH, (int)dst->u32Height - oy);
+        }
+        if (yuv)
+        {
+            ox &= ~1;
+            oy &= ~1;
+            ow &= ~1;
+            oh &= ~1;
+        }
+        if (ow <= 0 || oh <= 0)
+            return AX_ERR_IVPS_ILLEGAL_PARAM;
+
+        if (ow != (int)dst->u32Width || oh != (int)dst->u32Height)
+            fill_background(dst, ar.nBgColor);
+
+        const bool nearest = attr->eSclType == AX_IVPS_SCL_TYPE_NEAREST;
+        const AX_U32 src_stride = row_stride(src);
+        const AX_U32 dst_stride = row_stride(dst);
+        const AX_U8* s0 = host::frame_plane(src, 0);
+        AX_U8* d0 = host::frame_plane(dst, 0);
+        if (!s0 || !d0)
+            return AX_ERR_IVPS_NULL_PTR;
+
+        if (yuv)
+        {
+            const AX_U8* s1 = host::frame_plane(src, 1);
+            AX_U8* d1 = host::frame_plane(dst, 1);
+            const AX_U32 src_uv_stride = src->u32PicStride[1] ? src->u32PicStride[1] : src_stride;
+            const AX_U32 dst_uv_stride = dst->u32PicStride[1] ? dst->u32PicStride[1] : dst_stride;
+            if (!s1 || !d1)
+                return AX_ERR_IVPS_NULL_PTR;
+
+            resize_bilinear(s0 + (size_t)cy * src_stride + cx, src_stride, cw, ch,
+                            d0 + (size_t)oy * dst_stride + ox, dst_stride, ow, oh, 1, nearest);
+            resize_bilinear(s1 + (size_t)(cy / 2) * src_uv_stride + cx, src_uv_stride, cw / 2, ch / 2,
+                            d1 + (size_t)(oy / 2) * dst_uv_stride + ox, dst_uv_stride, ow / 2, oh / 2, 2, nearest);
+        }
+        else
+        {
+            const int c = packed_channels(fmt);
+            resize_bilinear(s0 + (size_t)cy * src_stride + cx * c, src_stride, cw, ch,
+                            d0 + (size_t)oy * dst_stride + ox * c, dst_stride, ow, oh, c, nearest);
+        }
+
+        dst->u64PTS = src->u64PTS;
+        dst->u64SeqNum = src->u64SeqNum;
+        return 0;
+    }
+}
+
+AX_S32 AX_IVPS_CropResizeTdp(const AX_VIDEO_FRAME_T *ptSrc, AX_VIDEO_FRAME_T *ptDst, const AX_IVPS_CROP_RESIZE_ATTR_T *ptAttr)
+{
+    if (!ptSrc)
+        return AX_ERR_IVPS_NULL_PTR;
+
+    AX_IVPS_RECT_T box;
+    box.nX = ptSrc->s16CropX;
+    box.nY = ptSrc->s16CropY;
+    box.nW = (AX_U16)ptSrc->s16CropWidth;
+    box.nH = (AX_U16)ptSrc->s16CropHeight;
+    return crop_resize(ptSrc, box, ptDst, ptAttr);
+}
+
+AX_S32 AX_IVPS_CropResizeV2Tdp(const AX_VIDEO_FRAME_T *ptSrc, const AX_IVPS_RECT_T tBox[], AX_U32 nCropNum,
+                               AX_VIDEO_FRAME_T *ptDst[], const AX_IVPS_CROP_RESIZE_ATTR_T *ptAttr)
+{
+    if (!ptSrc || !tBox || !ptDst)
+        return AX_ERR_IVPS_NULL_PTR;
+
+    for (AX_U32 i = 0; i < nCropNum; i++)
+    {
+        AX_S32 ret = crop_resize(ptSrc, tBox[i], ptDst[i], ptAttr);
+        if (0 != ret)
+            return ret;
+    }
+    return 0;
+}
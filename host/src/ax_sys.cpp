@@ -0,0 +1,505 @@
+/**************************************************************************************************
+ *
+ * Copyright (c) 2019-2023 Axera Semiconductor (Shanghai) Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Axera Semiconductor (Shanghai) Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Axera Semiconductor (Shanghai) Co., Ltd.
+ *
+ **************************************************************************************************/
+
+#include "ax_sys_api.h"
+#include "ax_sys_log.h"
+#include "ax_host_internal.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cstdarg>
+#include <algorithm>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace
+{
+    /* fake physical address space, blocks are page aligned with a guard page in between */
+    const AX_U64 HOST_CMM_PHY_BASE  = 0x40000000ULL;
+    const AX_U64 HOST_CMM_PAGE_SIZE = 0x1000ULL;
+
+    struct CmmBlock
+    {
+        AX_U8* vir;
+        AX_U32 size;
+        bool cached;
+        std::string token;
+    };
+
+    std::mutex g_cmm_lock;
+    std::map<AX_U64, CmmBlock> g_cmm_blocks;
+    AX_U64 g_cmm_next_phy = HOST_CMM_PHY_BASE;
+    int g_sys_init_cnt = 0;
+
+    struct PoolBlock
+    {
+        AX_U64 phy;
+        AX_U8* vir;
+        std::vector<AX_U8> meta;
+        AX_U32 ref_cnt;
+    };
+
+    struct Pool
+    {
+        AX_POOL_CONFIG_T config;
+        bool common;
+        std::vector<PoolBlock> blocks;
+    };
+
+    std::mutex g_pool_lock;
+    std::map<AX_POOL, Pool> g_pools;
+    AX_POOL_FLOORPLAN_T g_floorplan;
+    bool g_pool_inited = false;
+    AX_POOL g_next_pool_id = 0;
+
+    /* block handle: (pool id + 1) << 16 | (block index + 1), 0 is AX_INVALID_BLOCKID */
+    inline AX_BLK make_blk(AX_POOL pool_id, size_t index)
+    {
+        return ((AX_U32)(pool_id + 1) << 16) | (AX_U32)(index + 1);
+    }
+
+    PoolBlock* find_block(AX_BLK blk, AX_POOL* pool_id = nullptr)
+    {
+        if (blk == AX_INVALID_BLOCKID)
+            return nullptr;
+
+        AX_POOL id = (AX_POOL)(blk >> 16) - 1;
+        size_t index = (blk & 0xFFFF) - 1;
+        auto it = g_pools.find(id);
+        if (it == g_pools.end() || index >= it->second.blocks.size())
+            return nullptr;
+
+        if (pool_id)
+            *pool_id = id;
+        return &it->second.blocks[index];
+    }
+
+    AX_POOL create_pool(const AX_POOL_CONFIG_T& config, bool common)
+    {
+        if (config.BlkSize == 0 || config.BlkCnt == 0 || config.BlkCnt >= 0xFFFF)
+            return AX_INVALID_POOLID;
+
+        Pool pool;
+        pool.config = config;
+        pool.common = common;
+        pool.blocks.resize(config.BlkCnt);
+        for (auto& b : pool.blocks)
+        {
+            AX_VOID* vir = nullptr;
+            if (0 != host::cmm_alloc(&b.phy, &vir, (AX_U32)config.BlkSize, (AX_U32)HOST_CMM_PAGE_SIZE, (const AX_S8*)"pool",
+                                     config.CacheMode == AX_POOL_CACHE_MODE_CACHED))
+            {
+                for (auto& f : pool.blocks)
+                {
+                    if (f.vir)
+                        host::cmm_free(f.phy);
+                }
+                return AX_INVALID_POOLID;
+            }
+            b.vir = (AX_U8*)vir;
+            b.meta.resize(config.MetaSize);
+            b.ref_cnt = 0;
+        }
+
+        AX_POOL id = g_next_pool_id++;
+        g_pools[id] = std::move(pool);
+        return id;
+    }
+
+    void destroy_pool(std::map<AX_POOL, Pool>::iterator it)
+    {
+        for (auto& b : it->second.blocks)
+        {
+            if (b.ref_cnt > 0)
+                HLOGW(AX_ID_POOL, "pool %d destroyed with block 0x%llx still in use", it->first, (unsigned long long)b.phy);
+            host::cmm_free(b.phy);
+        }
+        g_pools.erase(it);
+    }
+
+    AX_LOG_LEVEL_E host_log_level()
+    {
+        static AX_LOG_LEVEL_E level = []() {
+            const char* env = getenv("AX_HOST_LOG_LEVEL");
+            return env ? (AX_LOG_LEVEL_E)atoi(env) : SYS_LOG_WARN;
+        }();
+        return level;
+    }
+}
+
+namespace host
+{
+    AX_U8* cmm_phy2vir(AX_U64 phy)
+    {
+        std::lock_guard<std::mutex> lg(g_cmm_lock);
+        auto it = g_cmm_blocks.upper_bound(phy);
+        if (it == g_cmm_blocks.begin())
+            return nullptr;
+        --it;
+        if (phy >= it->first + it->second.size)
+            return nullptr;
+        return it->second.vir + (phy - it->first);
+    }
+
+    AX_S32 cmm_alloc(AX_U64* phy, AX_VOID** vir, AX_U32 size, AX_U32 align, const AX_S8* token, bool cached)
+    {
+        if (!phy || !vir)
+            return AX_ERR_SYS_NULL_PTR;
+        if (size == 0)
+            return AX_ERR_SYS_ILLEGAL_PARAM;
+
+        size_t alignment = sizeof(void*);
+        while (alignment < align)
+            alignment <<= 1;
+
+        void* p = nullptr;
+        if (0 != posix_memalign(&p, alignment, size))
+            return AX_ERR_SYS_NOMEM;
+
+        std::lock_guard<std::mutex> lg(g_cmm_lock);
+        AX_U64 phy_align = alignment > HOST_CMM_PAGE_SIZE ? alignment : HOST_CMM_PAGE_SIZE;
+        AX_U64 addr = (g_cmm_next_phy + phy_align - 1) & ~(phy_align - 1);
+        g_cmm_next_phy = addr + ((size + HOST_CMM_PAGE_SIZE - 1) & ~(HOST_CMM_PAGE_SIZE - 1)) + HOST_CMM_PAGE_SIZE;
+
+        CmmBlock& block = g_cmm_blocks[addr];
+        block.vir = (AX_U8*)p;
+        block.size = size;
+        block.cached = cached;
+        block.token = token ? (const char*)token : "";
+
+        *phy = addr;
+        *vir = p;
+        return 0;
+    }
+
+    AX_S32 cmm_free(AX_U64 phy)
+    {
+        AX_U8* vir = nullptr;
+        {
+            std::lock_guard<std::mutex> lg(g_cmm_lock);
+            auto it = g_cmm_blocks.find(phy);
+            if (it == g_cmm_blocks.end())
+                return AX_ERR_SYS_UNEXIST;
+            vir = it->second.vir;
+            g_cmm_blocks.erase(it);
+        }
+        free(vir);
+        return 0;
+    }
+
+    AX_U8* frame_plane(const AX_VIDEO_FRAME_T* frame, int index)
+    {
+        AX_U8* vir = (AX_U8*)frame->u64VirAddr[index];
+        if (!vir && frame->u64PhyAddr[index])
+            vir = cmm_phy2vir(frame->u64PhyAddr[index]);
+        if (!vir && index > 0)
+        {
+            AX_U8* base = frame_plane(frame, 0);
+            AX_U32 stride = frame->u32PicStride[0] ? frame->u32PicStride[0] : frame->u32Width;
+            if (base)
+                vir = base + (AX_U64)stride * frame->u32Height;
+        }
+        return vir;
+    }
+}
+
+/* log */
+AX_VOID AX_SYS_LogPrint_Ex(AX_LOG_LEVEL_E eLv, const AX_CHAR *pszTag, AX_MOD_ID_E eModId, const AX_CHAR *pszFmt, ...)
+{
+    static const char level_chars[] = "MACEWNID";
+    if (eLv > host_log_level() || eLv < SYS_LOG_EMERG || !pszFmt)
+        return;
+
+    char msg[1024];
+    va_list args;
+    va_start(args, pszFmt);
+    vsnprintf(msg, sizeof(msg), pszFmt, args);
+    va_end(args);
+
+    size_t len = strlen(msg);
+    fprintf(stderr, "[%c][%s][%02d] %s%s", level_chars[eLv], pszTag ? pszTag : "", (int)eModId, msg,
+            (len > 0 && msg[len - 1] == '\n') ? "" : "\n");
+}
+
+/* sys */
+AX_S32 AX_SYS_Init(AX_VOID)
+{
+    std::lock_guard<std::mutex> lg(g_cmm_lock);
+    g_sys_init_cnt++;
+    return 0;
+}
+
+AX_S32 AX_SYS_Deinit(AX_VOID)
+{
+    std::lock_guard<std::mutex> lg(g_cmm_lock);
+    if (g_sys_init_cnt > 0)
+        g_sys_init_cnt--;
+    if (g_sys_init_cnt == 0 && !g_cmm_blocks.empty())
+        HLOGD(AX_ID_SYS, "%zu cmm blocks still allocated", g_cmm_blocks.size());
+    return 0;
+}
+
+AX_S32 AX_SYS_MemAlloc(AX_U64 *phyaddr, AX_VOID **pviraddr, AX_U32 size, AX_U32 align, const AX_S8 *token)
+{
+    return host::cmm_alloc(phyaddr, pviraddr, size, align, token, false);
+}
+
+AX_S32 AX_SYS_MemAllocCached(AX_U64 *phyaddr, AX_VOID **pviraddr, AX_U32 size, AX_U32 align, const AX_S8 *token)
+{
+    return host::cmm_alloc(phyaddr, pviraddr, size, align, token, true);
+}
+
+AX_S32 AX_SYS_MemFree(AX_U64 phyaddr, AX_VOID *pviraddr)
+{
+    /* looked up by physical address only, callers do not always pass the matching pointer */
+    (void)pviraddr;
+    return host::cmm_free(phyaddr);
+}
+
+AX_VOID *AX_SYS_Mmap(AX_U64 aPhyAddr, AX_U32 size)
+{
+    (void)size;
+    return host::cmm_phy2vir(aPhyAddr);
+}
+
+AX_VOID *AX_SYS_MmapCache(AX_U64 aPhyAddr, AX_U32 size)
+{
+    (void)size;
+    return host::cmm_phy2vir(aPhyAddr);
+}
+
+AX_S32 AX_SYS_Munmap(AX_VOID *pviraddr, AX_U32 size)
+{
+    (void)pviraddr;
+    (void)size;
+    return 0;
+}
+
+AX_S32 AX_SYS_MflushCache(AX_U64 phyaddr, AX_VOID *pviraddr, AX_U32 size)
+{
+    (void)phyaddr;
+    (void)pviraddr;
+    (void)size;
+    return 0;
+}
+
+AX_S32 AX_SYS_MinvalidateCache(AX_U64 phyaddr, AX_VOID *pviraddr, AX_U32 size)
+{
+    (void)phyaddr;
+    (void)pviraddr;
+    (void)size;
+    return 0;
+}
+
+AX_U64 AX_SYS_GetTickCount(AX_VOID)
+{
+    return (AX_U64)std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/* pool */
+AX_S32 AX_POOL_SetConfig(const AX_POOL_FLOORPLAN_T *pPoolFloorPlan)
+{
+    if (!pPoolFloorPlan)
+        return AX_ERR_POOL_NULL_PTR;
+
+    std::lock_guard<std::mutex> lg(g_pool_lock);
+    if (g_pool_inited)
+        return AX_ERR_POOL_NOT_PERM;
+    g_floorplan = *pPoolFloorPlan;
+    return 0;
+}
+
+AX_S32 AX_POOL_GetConfig(AX_POOL_FLOORPLAN_T *pPoolFloorPlan)
+{
+    if (!pPoolFloorPlan)
+        return AX_ERR_POOL_NULL_PTR;
+
+    std::lock_guard<std::mutex> lg(g_pool_lock);
+    *pPoolFloorPlan = g_floorplan;
+    return 0;
+}
+
+AX_S32 AX_POOL_Init(AX_VOID)
+{
+    std::lock_guard<std::mutex> lg(g_pool_lock);
+    if (g_pool_inited)
+        return 0;
+
+    for (int i = 0; i < AX_MAX_COMM_POOLS; i++)
+    {
+        const AX_POOL_CONFIG_T& config = g_floorplan.CommPool[i];
+        if (config.BlkSize == 0 || config.BlkCnt == 0)
+            continue;
+        if (AX_INVALID_POOLID == (AX_U32)create_pool(config, true))
+            return AX_ERR_POOL_NOMEM;
+    }
+
+    g_pool_inited = true;
+    return 0;
+}
+
+AX_S32 AX_POOL_Exit(AX_VOID)
+{
+    std::lock_guard<std::mutex> lg(g_pool_lock);
+    while (!g_pools.empty())
+        destroy_pool(g_pools.begin());
+    g_pool_inited = false;
+    return 0;
+}
+
+AX_POOL AX_POOL_CreatePool(AX_POOL_CONFIG_T *pPoolConfig)
+{
+    if (!pPoolConfig)
+        return AX_INVALID_POOLID;
+
+    std::lock_guard<std::mutex> lg(g_pool_lock);
+    return create_pool(*pPoolConfig, false);
+}
+
+AX_S32 AX_POOL_DestroyPool(AX_POOL PoolId)
+{
+    std::lock_guard<std::mutex> lg(g_pool_lock);
+    auto it = g_pools.find(PoolId);
+    if (it == g_pools.end())
+        return AX_ERR_POOL_UNEXIST;
+    destroy_pool(it);
+    return 0;
+}
+
+AX_BLK AX_POOL_GetBlock(AX_POOL PoolId, AX_U64 BlkSize, const AX_S8 *pPartitionName)
+{
+    (void)pPartitionName;
+    std::lock_guard<std::mutex> lg(g_pool_lock);
+
+    // best fit among common pools when no pool is given
+    std::vector<AX_POOL> candidates;
+    if ((AX_U32)PoolId == AX_INVALID_POOLID)
+    {
+        for (const auto& p : g_pools)
+        {
+            if (p.second.common && p.second.config.BlkSize >= BlkSize)
+                candidates.push_back(p.first);
+        }
+        std::sort(candidates.begin(), candidates.end(), [](AX_POOL a, AX_POOL b) {
+            return g_pools[a].config.BlkSize < g_pools[b].config.BlkSize;
+        });
+    }
+    else
+    {
+        auto it = g_pools.find(PoolId);
+        if (it == g_pools.end() || it->second.config.BlkSize < BlkSize)
+            return AX_INVALID_BLOCKID;
+        candidates.push_back(PoolId);
+    }
+
+    for (AX_POOL id : candidates)
+    {
+        auto& blocks = g_pools[id].blocks;
+        for (size_t i = 0; i < blocks.size(); i++)
+        {
+            if (blocks[i].ref_cnt == 0)
+            {
+                blocks[i].ref_cnt = 1;
+                return make_blk(id, i);
+            }
+        }
+    }
+    return AX_INVALID_BLOCKID;
+}
+
+AX_S32 AX_POOL_ReleaseBlock(AX_BLK BlockId)
+{
+    return AX_POOL_DecreaseRefCnt(BlockId);
+}
+
+AX_BLK AX_POOL_PhysAddr2Handle(AX_U64 PhysAddr)
+{
+    std::lock_guard<std::mutex> lg(g_pool_lock);
+    for (const auto& p : g_pools)
+    {
+        for (size_t i = 0; i < p.second.blocks.size(); i++)
+        {
+            const auto& b = p.second.blocks[i];
+            if (PhysAddr >= b.phy && PhysAddr < b.phy + p.second.config.BlkSize)
+                return make_blk(p.first, i);
+        }
+    }
+    return AX_INVALID_BLOCKID;
+}
+
+AX_U64 AX_POOL_Handle2PhysAddr(AX_BLK BlockId)
+{
+    std::lock_guard<std::mutex> lg(g_pool_lock);
+    PoolBlock* b = find_block(BlockId);
+    return b ? b->phy : 0;
+}
+
+AX_U64 AX_POOL_Handle2MetaPhysAddr(AX_BLK BlockId)
+{
+    // metadata lives in host memory only
+    (void)BlockId;
+    return 0;
+}
+
+AX_POOL AX_POOL_Handle2PoolId(AX_BLK BlockId)
+{
+    std::lock_guard<std::mutex> lg(g_pool_lock);
+    AX_POOL id = AX_INVALID_POOLID;
+    find_block(BlockId, &id);
+    return id;
+}
+
+AX_U64 AX_POOL_Handle2BlkSize(AX_BLK BlockId)
+{
+    std::lock_guard<std::mutex> lg(g_pool_lock);
+    AX_POOL id = AX_INVALID_POOLID;
+    if (!find_block(BlockId, &id))
+        return 0;
+    return g_pools[id].config.BlkSize;
+}
+
+AX_VOID *AX_POOL_GetBlockVirAddr(AX_BLK BlockId)
+{
+    std::lock_guard<std::mutex> lg(g_pool_lock);
+    PoolBlock* b = find_block(BlockId);
+    return b ? b->vir : nullptr;
+}
+
+AX_VOID *AX_POOL_GetMetaVirAddr(AX_BLK BlockId)
+{
+    std::lock_guard<std::mutex> lg(g_pool_lock);
+    PoolBlock* b = find_block(BlockId);
+    return (b && !b->meta.empty()) ? b->meta.data() : nullptr;
+}
+
+AX_S32 AX_POOL_IncreaseRefCnt(AX_BLK BlockId)
+{
+    std::lock_guard<std::mutex> lg(g_pool_lock);
+    PoolBlock* b = find_block(BlockId);
+    if (!b)
+        return AX_ERR_POOL_UNEXIST;
+    b->ref_cnt++;
+    return 0;
+}
+
+AX_S32 AX_POOL_DecreaseRefCnt(AX_BLK BlockId)
+{
+    std::lock_guard<std::mutex> lg(g_pool_lock);
+    PoolBlock* b = find_block(BlockId);
+    if (!b)
+        return AX_ERR_POOL_UNEXIST;
+    if (b->ref_cnt == 0)
+        return AX_ERR_POOL_NOT_PERM;
+    b->ref_cnt--;
+    return 0;
+}
@@ -0,0 +1,344 @@
+/**************************************************************************************************
+ *
+ * Copyright (c) 2019-2023 Axera Semiconductor (Shanghai) Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Axera Semiconductor (Shanghai) Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Axera Semiconductor (Shanghai) Co., Ltd.
+ *
+ **************************************************************************************************/
+
+#include "ax_vdec_api.h"
+#include "ax_sys_api.h"
+#include "ax_host_internal.h"
+
+#include <cstring>
+#include <deque>
+
+namespace
+{
+    const AX_U8 HOST_VDEC_GRAY = 0x80;
+
+    struct VdecGroup
+    {
+        bool created;
+        bool receiving;
+        AX_VDEC_GRP_ATTR_T attr;
+        AX_VDEC_GRP_PARAM_T param;
+        AX_VDEC_DISPLAY_MODE_E display_mode;
+        AX_POOL pool;
+        AX_U64 seq;
+        std::deque<AX_VIDEO_FRAME_INFO_T> frames;
+        std::condition_variable frame_cv;
+    };
+
+    std::mutex g_vdec_lock;
+    std::condition_variable g_vdec_release_cv;
+    VdecGroup g_groups[AX_VDEC_MAX_GRP_NUM];
+    bool g_vdec_inited = false;
+
+    inline AX_U32 align_up(AX_U32 v, AX_U32 a)
+    {
+        return (v + a - 1) / a * a;
+    }
+
+    inline VdecGroup* get_group(AX_VDEC_GRP grp)
+    {
+        if (grp < 0 || grp >= AX_VDEC_MAX_GRP_NUM || !g_groups[grp].created)
+            return nullptr;
+        return &g_groups[grp];
+    }
+
+    AX_BLK take_block(const VdecGroup& g, AX_U32 size)
+    {
+        if (g.attr.enVdecVbSource == AX_POOL_SOURCE_USER || g.attr.enVdecVbSource == AX_POOL_SOURCE_PRIVATE)
+        {
+            if ((AX_U32)g.pool == AX_INVALID_POOLID)
+                return AX_INVALID_BLOCKID;
+            return AX_POOL_GetBlock(g.pool, size, nullptr);
+        }
+        return AX_POOL_GetBlock(AX_INVALID_POOLID, size, nullptr);
+    }
+
+    void drop_frames(VdecGroup& g)
+    {
+        for (auto& f : g.frames)
+            AX_POOL_ReleaseBlock(f.stVFrame.u32BlkId[0]);
+        g.frames.clear();
+        g_vdec_release_cv.notify_all();
+    }
+}
+
+AX_S32 AX_VDEC_Init(const AX_VDEC_MOD_ATTR_T *pstModAttr)
+{
+    (void)pstModAttr;
+    std::lock_guard<std::mutex> lg(g_vdec_lock);
+    g_vdec_inited = true;
+    return 0;
+}
+
+AX_S32 AX_VDEC_Deinit(AX_VOID)
+{
+    std::lock_guard<std::mutex> lg(g_vdec_lock);
+    for (auto& g : g_groups)
+    {
+        if (g.created)
+            drop_frames(g);
+        g.created = false;
+    }
+    g_vdec_inited = false;
+    return 0;
+}
+
+AX_S32 AX_VDEC_CreateGrp(AX_VDEC_GRP VdGrp, const AX_VDEC_GRP_ATTR_T *pstGrpAttr)
+{
+    if (!pstGrpAttr)
+        return AX_ERR_VDEC_NULL_PTR;
+    if (VdGrp < 0 || VdGrp >= AX_VDEC_MAX_GRP_NUM)
+        return AX_ERR_VDEC_INVALID_GRPID;
+
+    std::lock_guard<std::mutex> lg(g_vdec_lock);
+    if (!g_vdec_inited)
+        return AX_ERR_VDEC_NOT_INIT;
+
+    VdecGroup& g = g_groups[VdGrp];
+    if (g.created)
+        return AX_ERR_VDEC_EXIST;
+    if (pstGrpAttr->u32PicWidth == 0 && pstGrpAttr->u32MaxPicWidth == 0)
+        return AX_ERR_VDEC_ILLEGAL_PARAM;
+
+    g.attr = *pstGrpAttr;
+    if (g.attr.u32PicWidth == 0 || g.attr.u32PicHeight == 0)
+    {
+        g.attr.u32PicWidth = g.attr.u32MaxPicWidth;
+        g.attr.u32PicHeight = g.attr.u32MaxPicHeight;
+    }
+    memset(&g.param, 0, sizeof(g.param));
+    g.display_mode = AX_VDEC_DISPLAY_MODE_PREVIEW;
+    g.pool = AX_INVALID_POOLID;
+    g.seq = 0;
+    g.receiving = false;
+    g.created = true;
+
+    if (g.attr.enVdecVbSource == AX_POOL_SOURCE_PRIVATE)
+    {
+        AX_POOL_CONFIG_T config;
+        memset(&config, 0, sizeof(config));
+        config.BlkSize = AX_VDEC_GetPicBufferSize(g.attr.u32PicWidth, g.attr.u32PicHeight, g.attr.enCodecType);
+        config.BlkCnt = g.attr.u32FrameBufCnt ? g.attr.u32FrameBufCnt : 8;
+        config.CacheMode = AX_POOL_CACHE_MODE_NONCACHE;
+        g.pool = AX_POOL_CreatePool(&config);
+    }
+    return 0;
+}
+
+AX_S32 AX_VDEC_DestroyGrp(AX_VDEC_GRP VdGrp)
+{
+    std::lock_guard<std::mutex> lg(g_vdec_lock);
+    VdecGroup* g = get_group(VdGrp);
+    if (!g)
+        return AX_ERR_VDEC_UNEXIST;
+
+    drop_frames(*g);
+    if (g->attr.enVdecVbSource == AX_POOL_SOURCE_PRIVATE && (AX_U32)g->pool != AX_INVALID_POOLID)
+        AX_POOL_DestroyPool(g->pool);
+    g->created = false;
+    g->receiving = false;
+    g->frame_cv.notify_all();
+    return 0;
+}
+
+AX_S32 AX_VDEC_GetGrpParam(AX_VDEC_GRP VdGrp, AX_VDEC_GRP_PARAM_T *pstGrpParam)
+{
+    if (!pstGrpParam)
+        return AX_ERR_VDEC_NULL_PTR;
+
+    std::lock_guard<std::mutex> lg(g_vdec_lock);
+    VdecGroup* g = get_group(VdGrp);
+    if (!g)
+        return AX_ERR_VDEC_UNEXIST;
+    *pstGrpParam = g->param;
+    return 0;
+}
+
+AX_S32 AX_VDEC_SetGrpParam(AX_VDEC_GRP VdGrp, const AX_VDEC_GRP_PARAM_T *pstGrpParam)
+{
+    if (!pstGrpParam)
+        return AX_ERR_VDEC_NULL_PTR;
+
+    std::lock_guard<std::mutex> lg(g_vdec_lock);
+    VdecGroup* g = get_group(VdGrp);
+    if (!g)
+        return AX_ERR_VDEC_UNEXIST;
+    g->param = *pstGrpParam;
+    return 0;
+}
+
+AX_S32 AX_VDEC_SetDisplayMode(AX_VDEC_GRP VdGrp, AX_VDEC_DISPLAY_MODE_E enDisplayMode)
+{
+    std::lock_guard<std::mutex> lg(g_vdec_lock);
+    VdecGroup* g = get_group(VdGrp);
+    if (!g)
+        return AX_ERR_VDEC_UNEXIST;
+    g->display_mode = enDisplayMode;
+    return 0;
+}
+
+AX_S32 AX_VDEC_AttachPool(AX_VDEC_GRP VdGrp, AX_POOL PoolId)
+{
+    std::lock_guard<std::mutex> lg(g_vdec_lock);
+    VdecGroup* g = get_group(VdGrp);
+    if (!g)
+        return AX_ERR_VDEC_UNEXIST;
+    g->pool = PoolId;
+    return 0;
+}
+
+AX_S32 AX_VDEC_DetachPool(AX_VDEC_GRP VdGrp)
+{
+    std::lock_guard<std::mutex> lg(g_vdec_lock);
+    VdecGroup* g = get_group(VdGrp);
+    if (!g)
+        return AX_ERR_VDEC_UNEXIST;
+    g->pool = AX_INVALID_POOLID;
+    return 0;
+}
+
+AX_U32 AX_VDEC_GetPicBufferSize(AX_U32 uWidth, AX_U32 uHeight, AX_PAYLOAD_TYPE_E enType)
+{
+    (void)enType;
+    return align_up(uWidth, 16) * align_up(uHeight, 16) * 3 / 2;
+}
+
+AX_S32 AX_VDEC_StartRecvStream(AX_VDEC_GRP VdGrp, const AX_VDEC_RECV_PIC_PARAM_T *pstRecvParam)
+{
+    (void)pstRecvParam;
+    std::lock_guard<std::mutex> lg(g_vdec_lock);
+    VdecGroup* g = get_group(VdGrp);
+    if (!g)
+        return AX_ERR_VDEC_UNEXIST;
+    g->receiving = true;
+    return 0;
+}
+
+AX_S32 AX_VDEC_StopRecvStream(AX_VDEC_GRP VdGrp)
+{
+    std::lock_guard<std::mutex> lg(g_vdec_lock);
+    VdecGroup* g = get_group(VdGrp);
+    if (!g)
+        return AX_ERR_VDEC_UNEXIST;
+    g->receiving = false;
+    g->frame_cv.notify_all();
+    g_vdec_release_cv.notify_all();
+    return 0;
+}
+
+AX_S32 AX_VDEC_SendStream(AX_VDEC_GRP VdGrp, const AX_VDEC_STREAM_T *pstStream, AX_S32 s32MilliSec)
+{
+    if (!pstStream)
+        return AX_ERR_VDEC_NULL_PTR;
+
+    std::unique_lock<std::mutex> lk(g_vdec_lock);
+    VdecGroup* g = get_group(VdGrp);
+    if (!g)
+        return AX_ERR_VDEC_UNEXIST;
+    if (!g->receiving)
+        return AX_ERR_VDEC_NOT_INIT;
+    if (!pstStream->pu8Addr || pstStream->u32StreamPackLen == 0)
+        return 0;
+
+    const AX_U32 width = g->attr.u32PicWidth;
+    const AX_U32 height = g->attr.u32PicHeight;
+    const AX_U32 stride = align_up(width, 16);
+    const AX_U32 size = stride * height * 3 / 2;
+
+    // the decoder stalls until a frame buffer is released, as the hardware does
+    AX_BLK blk = AX_INVALID_BLOCKID;
+    bool got = host::wait_for(lk, g_vdec_release_cv, s32MilliSec, [&]() {
+        if (!g->created || !g->receiving)
+            return true;
+        blk = take_block(*g, size);
+        return blk != AX_INVALID_BLOCKID;
+    });
+    if (!g->created || !g->receiving)
+    {
+        if (blk != AX_INVALID_BLOCKID)
+            AX_POOL_ReleaseBlock(blk);
+        return AX_ERR_VDEC_NOT_INIT;
+    }
+    if (!got || blk == AX_INVALID_BLOCKID)
+        return AX_ERR_VDEC_TIMED_OUT;
+
+    AX_U8* dst = (AX_U8*)AX_POOL_GetBlockVirAddr(blk);
+    if (pstStream->u32StreamPackLen == width * height * 3 / 2)
+    {
+        const AX_U8* src = pstStream->pu8Addr;
+        for (AX_U32 y = 0; y < height * 3 / 2; y++)
+            memcpy(dst + (size_t)y * stride, src + (size_t)y * width, width);
+    }
+    else
+    {
+        memset(dst, HOST_VDEC_GRAY, size);
+    }
+
+    AX_VIDEO_FRAME_INFO_T info;
+    memset(&info, 0, sizeof(info));
+    AX_VIDEO_FRAME_T& f = info.stVFrame;
+    f.u32Width = width;
+    f.u32Height = height;
+    f.enImgFormat = AX_FORMAT_YUV420_SEMIPLANAR;
+    f.u32PicStride[0] = stride;
+    f.u32PicStride[1] = stride;
+    f.u64PhyAddr[0] = AX_POOL_Handle2PhysAddr(blk);
+    f.u64PhyAddr[1] = f.u64PhyAddr[0] + (AX_U64)stride * height;
+    f.u64VirAddr[0] = (AX_U64)dst;
+    f.u64VirAddr[1] = f.u64VirAddr[0] + (AX_U64)stride * height;
+    f.u32BlkId[0] = blk;
+    f.u64PTS = pstStream->u64PTS;
+    f.u64SeqNum = g->seq++;
+    f.u64UserData = pstStream->u64UserData;
+    f.u32FrameSize = size;
+    info.enModId = AX_ID_VDEC;
+    info.bEndOfStream = pstStream->bEndOfStream;
+
+    g->frames.push_back(info);
+    g->frame_cv.notify_one();
+    return 0;
+}
+
+AX_S32 AX_VDEC_GetFrame(AX_VDEC_GRP VdGrp, AX_VIDEO_FRAME_INFO_T *pstFrameInfo, AX_S32 s32MilliSec)
+{
+    if (!pstFrameInfo)
+        return AX_ERR_VDEC_NULL_PTR;
+
+    std::unique_lock<std::mutex> lk(g_vdec_lock);
+    VdecGroup* g = get_group(VdGrp);
+    if (!g)
+        return AX_ERR_VDEC_UNEXIST;
+
+    bool got = host::wait_for(lk, g->frame_cv, s32MilliSec, [g]() {
+        return !g->frames.empty() || !g->created || !g->receiving;
+    });
+    if (!g->created)
+        return AX_ERR_VDEC_UNEXIST;
+    if (g->frames.empty())
+        return got ? AX_ERR_VDEC_BUF_EMPTY : AX_ERR_VDEC_TIMED_OUT;
+
+    *pstFrameInfo = g->frames.front();
+    g->frames.pop_front();
+    return 0;
+}
+
+AX_S32 AX_VDEC_ReleaseFrame(AX_VDEC_GRP VdGrp, const AX_VIDEO_FRAME_INFO_T *pstFrameInfo)
+{
+    if (!pstFrameInfo)
+        return AX_ERR_VDEC_NULL_PTR;
+
+    std::lock_guard<std::mutex> lg(g_vdec_lock);
+    if (VdGrp < 0 || VdGrp >= AX_VDEC_MAX_GRP_NUM)
+        return AX_ERR_VDEC_INVALID_GRPID;
+
+    AX_S32 ret = AX_POOL_ReleaseBlock(pstFrameInfo->stVFrame.u32BlkId[0]);
+    g_vdec_release_cv.notify_all();
+    return ret;
+}
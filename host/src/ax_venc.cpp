@@ -0,0 +1,251 @@
+/**************************************************************************************************
+ *
+ * Copyright (c) 2019-2023 Axera Semiconductor (Shanghai) Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Axera Semiconductor (Shanghai) Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Axera Semiconductor (Shanghai) Co., Ltd.
+ *
+ **************************************************************************************************/
+
+#include "ax_venc_api.h"
+#include "ax_host_internal.h"
+
+#include <cstring>
+#include <deque>
+#include <map>
+
+namespace
+{
+    const AX_U32 HOST_VENC_DEFAULT_FIFO = 4;
+
+    struct VencChannel
+    {
+        bool created;
+        bool receiving;
+        AX_VENC_CHN_ATTR_T attr;
+        AX_U32 seq;
+        std::deque<AX_VENC_STREAM_T> streams;
+        std::map<AX_U64, AX_U8*> outstanding;
+        std::condition_variable stream_cv;
+        std::condition_variable space_cv;
+    };
+
+    std::mutex g_venc_lock;
+    VencChannel g_channels[AX_VENC_MAX_CHN_NUM];
+    bool g_venc_inited = false;
+
+    inline VencChannel* get_channel(VENC_CHN chn)
+    {
+        if (chn < 0 || chn >= AX_VENC_MAX_CHN_NUM || !g_channels[chn].created)
+            return nullptr;
+        return &g_channels[chn];
+    }
+
+    inline AX_U32 fifo_depth(const VencChannel& c)
+    {
+        return c.attr.stVencAttr.u8OutFifoDepth ? c.attr.stVencAttr.u8OutFifoDepth : HOST_VENC_DEFAULT_FIFO;
+    }
+
+    void drop_streams(VencChannel& c)
+    {
+        for (auto& s : c.streams)
+            host::cmm_free(s.stPack.ulPhyAddr);
+        c.streams.clear();
+        for (auto& o : c.outstanding)
+            host::cmm_free(o.first);
+        c.outstanding.clear();
+    }
+
+    /// @brief copy the visible picture, planes tightly packed
+    AX_U32 pack_frame(const AX_VIDEO_FRAME_T& f, AX_U8* dst)
+    {
+        const AX_U32 w = f.u32Width, h = f.u32Height;
+        const AX_U32 stride = f.u32PicStride[0] ? f.u32PicStride[0] : w;
+        AX_U32 len = 0;
+
+        const AX_U8* y = host::frame_plane(&f, 0);
+        for (AX_U32 r = 0; r < h; r++, len += w)
+            memcpy(dst + len, y + (size_t)r * stride, w);
+
+        if (f.enImgFormat == AX_FORMAT_YUV420_SEMIPLANAR || f.enImgFormat == AX_FORMAT_YUV420_SEMIPLANAR_VU)
+        {
+            const AX_U8* uv = host::frame_plane(&f, 1);
+            const AX_U32 uv_stride = f.u32PicStride[1] ? f.u32PicStride[1] : stride;
+            for (AX_U32 r = 0; r < h / 2; r++, len += w)
+                memcpy(dst + len, uv + (size_t)r * uv_stride, w);
+        }
+        return len;
+    }
+}
+
+AX_S32 AX_VENC_Init(const AX_VENC_MOD_ATTR_T *pstModAttr)
+{
+    (void)pstModAttr;
+    std::lock_guard<std::mutex> lg(g_venc_lock);
+    g_venc_inited = true;
+    return 0;
+}
+
+AX_S32 AX_VENC_Deinit(AX_VOID)
+{
+    std::lock_guard<std::mutex> lg(g_venc_lock);
+    for (auto& c : g_channels)
+    {
+        if (c.created)
+            drop_streams(c);
+        c.created = false;
+    }
+    g_venc_inited = false;
+    return 0;
+}
+
+AX_S32 AX_VENC_CreateChn(VENC_CHN VeChn, const AX_VENC_CHN_ATTR_T *pstAttr)
+{
+    if (!pstAttr)
+        return AX_ERR_VENC_NULL_PTR;
+    if (VeChn < 0 || VeChn >= AX_VENC_MAX_CHN_NUM)
+        return AX_ERR_VENC_INVALID_CHNID;
+
+    std::lock_guard<std::mutex> lg(g_venc_lock);
+    if (!g_venc_inited)
+        return AX_ERR_VENC_NOT_INIT;
+
+    VencChannel& c = g_channels[VeChn];
+    if (c.created)
+        return AX_ERR_VENC_EXIST;
+
+    c.attr = *pstAttr;
+    c.seq = 0;
+    c.receiving = false;
+    c.created = true;
+    return 0;
+}
+
+AX_S32 AX_VENC_DestroyChn(VENC_CHN VeChn)
+{
+    std::lock_guard<std::mutex> lg(g_venc_lock);
+    VencChannel* c = get_channel(VeChn);
+    if (!c)
+        return AX_ERR_VENC_UNEXIST;
+
+    drop_streams(*c);
+    c->created = false;
+    c->receiving = false;
+    c->stream_cv.notify_all();
+    c->space_cv.notify_all();
+    return 0;
+}
+
+AX_S32 AX_VENC_StartRecvFrame(VENC_CHN VeChn, const AX_VENC_RECV_PIC_PARAM_T *pstRecvParam)
+{
+    (void)pstRecvParam;
+    std::lock_guard<std::mutex> lg(g_venc_lock);
+    VencChannel* c = get_channel(VeChn);
+    if (!c)
+        return AX_ERR_VENC_UNEXIST;
+    c->receiving = true;
+    return 0;
+}
+
+AX_S32 AX_VENC_StopRecvFrame(VENC_CHN VeChn)
+{
+    std::lock_guard<std::mutex> lg(g_venc_lock);
+    VencChannel* c = get_channel(VeChn);
+    if (!c)
+        return AX_ERR_VENC_UNEXIST;
+    c->receiving = false;
+    c->stream_cv.notify_all();
+    c->space_cv.notify_all();
+    return 0;
+}
+
+AX_S32 AX_VENC_SendFrame(VENC_CHN VeChn, const AX_VIDEO_FRAME_INFO_T *pstFrame, AX_S32 s32MilliSec)
+{
+    if (!pstFrame)
+        return AX_ERR_VENC_NULL_PTR;
+
+    std::unique_lock<std::mutex> lk(g_venc_lock);
+    VencChannel* c = get_channel(VeChn);
+    if (!c)
+        return AX_ERR_VENC_UNEXIST;
+    if (!c->receiving)
+        return AX_ERR_VENC_NOT_INIT;
+
+    const AX_VIDEO_FRAME_T& f = pstFrame->stVFrame;
+    if (f.u32Width == 0 || f.u32Height == 0 || !host::frame_plane(&f, 0))
+        return AX_ERR_VENC_ILLEGAL_PARAM;
+
+    bool space = host::wait_for(lk, c->space_cv, s32MilliSec, [c]() {
+        return c->streams.size() < fifo_depth(*c) || !c->created || !c->receiving;
+    });
+    if (!c->created || !c->receiving)
+        return AX_ERR_VENC_NOT_INIT;
+    if (!space)
+        return AX_ERR_VENC_BUF_FULL;
+
+    const AX_U32 size = f.u32Width * f.u32Height * 3 / 2;
+    AX_U64 phy = 0;
+    AX_VOID* vir = nullptr;
+    if (0 != host::cmm_alloc(&phy, &vir, size, 64, (const AX_S8*)"venc", false))
+        return AX_ERR_VENC_NOMEM;
+
+    AX_VENC_STREAM_T stream;
+    memset(&stream, 0, sizeof(stream));
+    stream.stPack.ulPhyAddr = phy;
+    stream.stPack.pu8Addr = (AX_U8*)vir;
+    stream.stPack.u32Len = pack_frame(f, (AX_U8*)vir);
+    stream.stPack.u64PTS = f.u64PTS;
+    stream.stPack.u64SeqNum = f.u64SeqNum;
+    stream.stPack.u64UserData = f.u64UserData;
+    stream.stPack.enType = c->attr.stVencAttr.enType;
+    stream.stPack.bFrameEnd = AX_TRUE;
+    stream.u32Seq = c->seq++;
+
+    c->streams.push_back(stream);
+    c->stream_cv.notify_one();
+    return 0;
+}
+
+AX_S32 AX_VENC_GetStream(VENC_CHN VeChn, AX_VENC_STREAM_T *pstStream, AX_S32 s32MilliSec)
+{
+    if (!pstStream)
+        return AX_ERR_VENC_NULL_PTR;
+
+    std::unique_lock<std::mutex> lk(g_venc_lock);
+    VencChannel* c = get_channel(VeChn);
+    if (!c)
+        return AX_ERR_VENC_UNEXIST;
+
+    bool got = host::wait_for(lk, c->stream_cv, s32MilliSec, [c]() {
+        return !c->streams.empty() || !c->created || !c->receiving;
+    });
+    if (!c->created)
+        return AX_ERR_VENC_UNEXIST;
+    if (c->streams.empty())
+        return got ? AX_ERR_VENC_NOT_INIT : AX_ERR_VENC_TIMED_OUT;
+
+    *pstStream = c->streams.front();
+    c->streams.pop_front();
+    c->outstanding[pstStream->stPack.ulPhyAddr] = pstStream->stPack.pu8Addr;
+    c->space_cv.notify_one();
+    return 0;
+}
+
+AX_S32 AX_VENC_ReleaseStream(VENC_CHN VeChn, const AX_VENC_STREAM_T *pstStream)
+{
+    if (!pstStream)
+        return AX_ERR_VENC_NULL_PTR;
+
+    std::lock_guard<std::mutex> lg(g_venc_lock);
+    VencChannel* c = get_channel(VeChn);
+    if (!c)
+        return AX_ERR_VENC_UNEXIST;
+
+    auto it = c->outstanding.find(pstStream->stPack.ulPhyAddr);
+    if (it == c->outstanding.end())
+        return AX_ERR_VENC_ILLEGAL_PARAM;
+    host::cmm_free(it->first);
+    c->outstanding.erase(it);
+    return 0;
+}
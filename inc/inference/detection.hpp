@@ -20,15 +20,20 @@
 #pragma once
 
 #include <algorithm>
+#include <cfloat>
 #include <cmath>
 #include <cstdint>
 #include <string>
+#include <type_traits>
 #include <vector>
 
 #include "ax_global_type.h"
 #include "ax_engine_type.h"
 #include "opencv2/core.hpp"
 
+#include "inference/nms.hpp"
+#include "utils/simd_utils.hpp"
+
 namespace detection {
 typedef struct {
     int grid0;
@@ -96,6 +101,59 @@ typedef struct _detResult {
     }
 } DetResult;
 
+// Compact detection record used from proposal generation through NMS and rescale, so crowded
+// frames do not construct an Object (with its strings and vectors) per candidate.
+typedef struct {
+    float x, y, w, h;
+    float prob;
+    int label;
+    int index;      // row in the arena side tables, set at generation time
+} Proposal;
+
+static_assert(std::is_trivially_copyable<Proposal>::value, "Proposal must stay POD");
+
+// Per-detector storage reused across frames; side tables are only filled by models that have them
+typedef struct _ProposalArena {
+    std::vector<Proposal> proposals;
+    std::vector<ai_point_t> points;     // num_points per proposal, row Proposal::index
+    int num_points;
+    NmsBoxes nms;
+    std::vector<int> picked;
+
+    _ProposalArena() {
+        num_points = 0;
+    }
+
+    void reset(int num_points_ = 0) {
+        proposals.clear();
+        points.clear();
+        num_points = num_points_;
+    }
+} ProposalArena;
+
+static inline void push_proposal(std::vector<Proposal>& proposals, float x, float y, float w, float h, float prob, int label) {
+    Proposal p;
+    p.x = x;
+    p.y = y;
+    p.w = w;
+    p.h = h;
+    p.prob = prob;
+    p.label = label;
+    p.index = (int)proposals.size();
+    proposals.push_back(p);
+}
+
+static inline void to_objects(const std::vector<Proposal>& proposals, std::vector<Object>& objects) {
+    size_t base = objects.size();
+    objects.resize(base + proposals.size());
+    for (size_t i = 0; i < proposals.size(); i++) {
+        const Proposal& p = proposals[i];
+        objects[base + i].rect = cv::Rect_<float>(p.x, p.y, p.w, p.h);
+        objects[base + i].prob = p.prob;
+        objects[base + i].label = p.label;
+    }
+}
+
 static inline float sigmoid(float x) {
     return static_cast<float>(1.f / (1.f + exp(-x)));
 }
@@ -105,69 +163,54 @@ static inline float intersection_area(const Object& a, const Object& b) {
     return inter.area();
 }
 
-static inline void qsort_descent_inplace(std::vector<Object>& faceobjects, int left, int right) {
-    int i = left;
-    int j = right;
-    float p = faceobjects[(left + right) / 2].prob;
-
-    while (i <= j) {
-        while (faceobjects[i].prob > p) i++;
-
-        while (faceobjects[j].prob < p) j--;
-
-        if (i <= j) {
-            // swap
-            std::swap(faceobjects[i], faceobjects[j]);
+static inline void qsort_descent_inplace(std::vector<Object>& faceobjects) {
+    if (faceobjects.size() < 2) return;
+
+    // sort indices and move every object once instead of swapping the fat struct around
+    std::vector<float> scores(faceobjects.size());
+    for (size_t i = 0; i < faceobjects.size(); i++) scores[i] = faceobjects[i].prob;
+    std::vector<int> order;
+    nms_sort_indices(scores.data(), (int)scores.size(), 0, order);
+
+    std::vector<Object> sorted;
+    sorted.reserve(faceobjects.size());
+    for (int i : order) sorted.push_back(std::move(faceobjects[i]));
+    faceobjects.swap(sorted);
+}
 
-            i++;
-            j--;
-        }
-    }
-//#pragma omp parallel sections
-    {
-//#pragma omp section
-        {
-            if (left < j) qsort_descent_inplace(faceobjects, left, j);
-        }
-//#pragma omp section
-        {
-            if (i < right) qsort_descent_inplace(faceobjects, i, right);
-        }
+static inline void to_nms_boxes(const std::vector<Object>& objects, NmsBoxes& boxes) {
+    boxes.clear();
+    boxes.reserve(objects.size());
+    for (const Object& obj : objects) {
+        boxes.push(obj.rect.x, obj.rect.y, obj.rect.width, obj.rect.height, obj.prob, obj.label);
     }
 }
 
-static inline void qsort_descent_inplace(std::vector<Object>& faceobjects) {
-    if (faceobjects.empty()) return;
-
-    qsort_descent_inplace(faceobjects, 0, faceobjects.size() - 1);
+static inline void to_nms_boxes(const std::vector<Proposal>& proposals, NmsBoxes& boxes) {
+    boxes.clear();
+    boxes.reserve(proposals.size());
+    for (const Proposal& p : proposals) {
+        boxes.push(p.x, p.y, p.w, p.h, p.prob, p.label);
+    }
 }
 
-static inline void nms_sorted_bboxes(const std::vector<Object>& faceobjects, std::vector<int>& picked, float nms_threshold) {
-    picked.clear();
-
-    const int n = faceobjects.size();
-
-    std::vector<float> areas(n);
-    for (int i = 0; i < n; i++) {
-        areas[i] = faceobjects[i].rect.area();
+/// @brief NMS on unsorted objects, picked holds indices into objects in descending score order.
+///        Soft NMS writes the decayed scores back to prob.
+static inline void nms_objects(std::vector<Object>& objects, std::vector<int>& picked, const NmsParams& params,
+                               NmsBoxes* workspace = nullptr) {
+    NmsBoxes local;
+    NmsBoxes& boxes = workspace ? *workspace : local;
+    to_nms_boxes(objects, boxes);
+    nms(boxes, params, picked);
+    if (params.method == NMS_SOFT_LINEAR || params.method == NMS_SOFT_GAUSSIAN) {
+        for (int i : picked) objects[i].prob = boxes.score[i];
     }
+}
 
-    for (int i = 0; i < n; i++) {
-        const Object& a = faceobjects[i];
-
-        int keep = 1;
-        for (int j = 0; j < (int)picked.size(); j++) {
-            const Object& b = faceobjects[picked[j]];
-
-            // intersection over union
-            float inter_area = intersection_area(a, b);
-            float union_area = areas[i] + areas[picked[j]] - inter_area;
-            // float IoU = inter_area / union_area
-            if (inter_area / union_area > nms_threshold) keep = 0;
-        }
-
-        if (keep) picked.push_back(i);
-    }
+static inline void nms_sorted_bboxes(const std::vector<Object>& faceobjects, std::vector<int>& picked, float nms_threshold) {
+    NmsBoxes boxes;
+    to_nms_boxes(faceobjects, boxes);
+    nms_sorted(boxes, NmsParams(nms_threshold), picked);
 }
 
 static inline void hvc_nms_sorted_bboxes(const std::vector<Object>& faceobjects,
@@ -175,52 +218,21 @@ static inline void hvc_nms_sorted_bboxes(const std::vector<Object>& faceobjects,
                                                     const float nms_threshold,
                                                     const float nms_bbox_overlap_ratio,
                                                     int nums_class) {
-    picked.clear();
-
-    const int n = faceobjects.size();
-
-    std::vector<float> areas(n);
-    for (int i = 0; i < n; i++) {
-        areas[i] = faceobjects[i].rect.area();
-    }
-
-    for (int c = 0; c < nums_class; ++c) {
-        for (int i = 0; i < n; i++) {
-            const Object& a = faceobjects[i];
-
-            if (a.label != c) {
-                continue;
-            }
-
-            int keep = 1;
-
-            for (int j = 0; j < (int)picked.size(); j++) {
-                const Object& b = faceobjects[picked[j]];
-                if (b.label != c) {
-                    continue;
-                }
-                // intersection over union
-
-                float inter_area = intersection_area(a, b);
-                float union_area = areas[i] + areas[picked[j]] - inter_area;
-
-                // float IoU = inter_area / union_area
-                if (inter_area / union_area > nms_threshold) {
-                    keep = 0;
-                }
-
-                // suppress bigger contina smaller
-                if ((inter_area > nms_bbox_overlap_ratio * areas[i])
-                    || (inter_area > nms_bbox_overlap_ratio * areas[picked[j]])) {
-                    keep = 0;
-                }
-            }
-
-            if (keep) {
-                picked.push_back(i);
-            }
-        }
-    }
+    NmsBoxes boxes;
+    to_nms_boxes(faceobjects, boxes);
+
+    NmsParams params(nms_threshold);
+    params.overlap_ratio = nms_bbox_overlap_ratio;
+    params.class_aware = true;
+    nms_sorted(boxes, params, picked);
+
+    // one pass over all classes, then grouped by class as callers expect
+    picked.erase(std::remove_if(picked.begin(), picked.end(), [&](int i) {
+        return faceobjects[i].label < 0 || faceobjects[i].label >= nums_class;
+    }), picked.end());
+    std::stable_sort(picked.begin(), picked.end(), [&](int a, int b) {
+        return faceobjects[a].label < faceobjects[b].label;
+    });
 }
 
 static inline void generate_grids_and_stride(const int target_w, const int target_h, std::vector<int>& strides,
@@ -242,30 +254,18 @@ static inline void generate_grids_and_stride(const int target_w, const int targe
 
 static inline void nhwc2nchw(float* src, int n, int h, int w, int c, float* dst)
 {
-    int c_stride = h * w;
-    int h_stride = w * c;
     int n_stride = c * h * w;
     for (int i = 0; i < n; i++)
     {
-        float* _src = src + i * n_stride;
-        for (int j = 0; j < h; j++)
-        {
-            for (int k = 0; k < w; k++)
-            {
-                for (int l = 0; l < c; l++)
-                {
-                    dst[i * n_stride + l * c_stride + j * w + k] = _src[j * h_stride + k * c + l];
-                }
-            }
-        }
+        utils::nhwc2nchw(src + i * n_stride, h, w, c, dst + i * n_stride);
     }
 }
 
-static inline void generate_yolox_proposals(std::vector<GridAndStride> grid_strides, 
+static inline void generate_yolox_proposals(const std::vector<GridAndStride>& grid_strides, 
                         const AX_ENGINE_IOMETA_T& output_info, 
-                        float* feat_ptr, 
+                        const float* feat_ptr, 
                         float obj_thresh, float cls_thresh, const cv::Size& min_size, 
-                        std::vector<Object> &objects) {
+                        std::vector<Proposal> &proposals) {
     const int num_anchors = grid_strides.size();
 
     int feat_c = output_info.pShape[1];
@@ -273,57 +273,199 @@ static inline void generate_yolox_proposals(std::vector<GridAndStride> grid_stri
     int feat_w = output_info.pShape[3];
     int c_stride = feat_h * feat_w;
     int num_classes = feat_c - 5;
-    printf("c h w num_cls num_anchors: %d %d %d %d %d\n", feat_c, feat_h, feat_w, num_classes, num_anchors);
 
     // x_center y_center w h obj cls0 cls1 ...
-    float* feat_ptr_x_center = feat_ptr;
-    float* feat_ptr_y_center = feat_ptr + c_stride;
-    float* feat_ptr_w = feat_ptr + 2 * c_stride;
-    float* feat_ptr_h = feat_ptr + 3 * c_stride;
-    float* feat_ptr_objectness = feat_ptr + 4 * c_stride;
-
-    for (int anchor_idx = 0; anchor_idx < num_anchors; anchor_idx++) {
-        float box_objectness = feat_ptr_objectness[anchor_idx];
-        // printf("obj: %f\n", box_objectness);
-        
-        if (box_objectness > obj_thresh) {
+    const float* feat_ptr_x_center = feat_ptr;
+    const float* feat_ptr_y_center = feat_ptr + c_stride;
+    const float* feat_ptr_w = feat_ptr + 2 * c_stride;
+    const float* feat_ptr_h = feat_ptr + 3 * c_stride;
+    const float* feat_ptr_objectness = feat_ptr + 4 * c_stride;
+    const float* feat_ptr_cls = feat_ptr + 5 * c_stride;
+
+    // anchors are scanned in blocks: objectness first, then the class planes only when the
+    // block is dense enough for a contiguous class max to beat strided per-anchor loads
+    const int block = 64;
+    int cand[block];
+    float cls_max[block];
+    int cls_arg[block];
+
+    for (int base = 0; base < num_anchors; base += block) {
+        const int n = std::min(block, num_anchors - base);
+        int num_cand = utils::select_gt_f32(feat_ptr_objectness + base, n, obj_thresh, cand);
+        if (num_cand == 0)
+            continue;
+
+        const bool dense = num_cand * 4 > n;
+        if (dense)
+            utils::class_max_nchw_f32(feat_ptr_cls + base, n, c_stride, num_classes, cls_max, cls_arg);
+
+        for (int c = 0; c < num_cand; c++) {
+            const int anchor_idx = base + cand[c];
+            if (dense && !(cls_max[cand[c]] > cls_thresh))
+                continue;
+
+            const int grid0 = grid_strides[anchor_idx].grid0; // 0
+            const int grid1 = grid_strides[anchor_idx].grid1; // 0
+            const int stride = grid_strides[anchor_idx].stride; // 8
+            // yolox/models/yolo_head.py decode logic
+            //  outputs[..., :2] = (outputs[..., :2] + grids) * strides
+            //  outputs[..., 2:4] = torch.exp(outputs[..., 2:4]) * strides
+            float x_center = (feat_ptr_x_center[anchor_idx] + grid0) * stride;
+            float y_center = (feat_ptr_y_center[anchor_idx] + grid1) * stride;
+            float w = exp(feat_ptr_w[anchor_idx]) * stride;
+            float h = exp(feat_ptr_h[anchor_idx]) * stride;
+            if (w < min_size.width || h < min_size.height)
+                continue;
+            float x0 = x_center - w * 0.5f;
+            float y0 = y_center - h * 0.5f;
+
             for (int class_idx = 0; class_idx < num_classes; class_idx++) {
-                float box_cls_score = feat_ptr[(5 + class_idx) * c_stride + anchor_idx];
+                float box_cls_score = feat_ptr_cls[class_idx * c_stride + anchor_idx];
                 if (box_cls_score > cls_thresh) {
-                    // float box_prob = box_objectness * box_cls_score;
-                    // if (box_prob > cls_thresh) {
-                        Object obj;
-                        // printf("%d,%d\n",num_anchors,anchor_idx);
-                        const int grid0 = grid_strides[anchor_idx].grid0; // 0
-                        const int grid1 = grid_strides[anchor_idx].grid1; // 0
-                        const int stride = grid_strides[anchor_idx].stride; // 8
-                        // yolox/models/yolo_head.py decode logic
-                        //  outputs[..., :2] = (outputs[..., :2] + grids) * strides
-                        //  outputs[..., 2:4] = torch.exp(outputs[..., 2:4]) * strides
-                        float x_center = (feat_ptr_x_center[anchor_idx] + grid0) * stride;
-                        float y_center = (feat_ptr_y_center[anchor_idx] + grid1) * stride;
-                        float w = exp(feat_ptr_w[anchor_idx]) * stride;
-                        float h = exp(feat_ptr_h[anchor_idx]) * stride;
-                        float x0 = x_center - w * 0.5f;
-                        float y0 = y_center - h * 0.5f;
-
-                        obj.rect = cv::Rect_<float>(x0, y0, w, h);
-                        obj.label = class_idx;
-                        obj.prob = box_cls_score;
-
-                        if (w < min_size.width || h < min_size.height)
-                            continue;
-
-                        // printf("proposal: %.2f %.2f %.2f %.2f %.2f\n", box_prob, x0, y0, w, h);
-
-                        objects.push_back(obj);
-                    // }
+                    push_proposal(proposals, x0, y0, w, h, box_cls_score, class_idx);
                 }
             }
         }
     } // point anchor loop
 }
 
+static inline void generate_yolox_proposals(const std::vector<GridAndStride>& grid_strides, 
+                        const AX_ENGINE_IOMETA_T& output_info, 
+                        float* feat_ptr, 
+                        float obj_thresh, float cls_thresh, const cv::Size& min_size, 
+                        std::vector<Object> &objects) {
+    std::vector<Proposal> proposals;
+    generate_yolox_proposals(grid_strides, output_info, feat_ptr, obj_thresh, cls_thresh, min_size, proposals);
+    to_objects(proposals, objects);
+}
+
+// Anchor table of one YoloX head, built once per model: grid offsets and stride of every anchor as floats
+typedef struct {
+    std::vector<float> grid_x;
+    std::vector<float> grid_y;
+    std::vector<float> stride;
+} YoloXAnchors;
+
+static inline void generate_yolox_anchors(const int target_w, const int target_h, const std::vector<int>& strides,
+                                          YoloXAnchors& anchors) {
+    anchors.grid_x.clear();
+    anchors.grid_y.clear();
+    anchors.stride.clear();
+    for (auto stride : strides) {
+        int num_grid_w = target_w / stride;
+        int num_grid_h = target_h / stride;
+        for (int g1 = 0; g1 < num_grid_h; g1++) {
+            for (int g0 = 0; g0 < num_grid_w; g0++) {
+                anchors.grid_x.push_back((float)g0);
+                anchors.grid_y.push_back((float)g1);
+                anchors.stride.push_back((float)stride);
+            }
+        }
+    }
+}
+
+// float heads are read as is, u8 heads through a 256 entry dequant table
+static inline float yolox_value(float v, const float*) { return v; }
+static inline float yolox_value(AX_U8 v, const float* lut) { return lut[v]; }
+
+static inline int yolox_select(const float* v, int n, float thresh, int, int* cand) {
+    return utils::select_gt_f32(v, n, thresh, cand);
+}
+
+static inline int yolox_select(const AX_U8* v, int n, float, int raw_thresh, int* cand) {
+    return raw_thresh > 255 ? 0 : utils::select_ge_u8(v, n, (AX_U8)raw_thresh, cand);
+}
+
+static inline void yolox_class_max(const float* cls, int n, int c_stride, int num_classes, const float*, float* max, int* arg) {
+    utils::class_max_nchw_f32(cls, n, c_stride, num_classes, max, arg);
+}
+
+static inline void yolox_class_max(const AX_U8* cls, int n, int c_stride, int num_classes, const float* lut, float* max, int* arg) {
+    AX_U8 raw_max[64], raw_arg[64];
+    utils::class_max_nchw_u8(cls, n, c_stride, num_classes, raw_max, raw_arg);
+    for (int i = 0; i < n; i++) {
+        max[i] = lut[raw_max[i]];
+        arg[i] = raw_arg[i];
+    }
+}
+
+/// @brief Decode one YoloX NCHW head (x y w h obj cls...), float or u8 quantized with zero_point/scale.
+///        u8 heads support up to 256 classes.
+template <typename T>
+static inline void generate_yolox_proposals(const YoloXAnchors& anchors, const AX_ENGINE_IOMETA_T& output_info, const T* feat_ptr,
+                        float obj_thresh, float cls_thresh, const cv::Size& min_size, std::vector<Proposal>& proposals,
+                        float zero_point = 0.f, float scale = 1.f) {
+    const int num_anchors = (int)anchors.stride.size();
+    const int feat_c = output_info.pShape[1];
+    const int c_stride = output_info.pShape[2] * output_info.pShape[3];
+    const int num_classes = feat_c - 5;
+
+    float lut[256];
+    int obj_raw = 256;
+    if (std::is_same<T, AX_U8>::value) {
+        for (int r = 0; r < 256; r++) lut[r] = ((float)r - zero_point) * scale;
+        // first raw value above the threshold, the table is increasing
+        obj_raw = 0;
+        while (obj_raw < 256 && !(lut[obj_raw] > obj_thresh)) obj_raw++;
+    }
+
+    const T* feat_ptr_x_center = feat_ptr;
+    const T* feat_ptr_y_center = feat_ptr + c_stride;
+    const T* feat_ptr_w = feat_ptr + 2 * c_stride;
+    const T* feat_ptr_h = feat_ptr + 3 * c_stride;
+    const T* feat_ptr_objectness = feat_ptr + 4 * c_stride;
+    const T* feat_ptr_cls = feat_ptr + 5 * c_stride;
+
+    const int block = 64;
+    int cand[block];
+    float cls_max[block];
+    int cls_arg[block];
+    float tw[block], th[block];
+
+    for (int base = 0; base < num_anchors; base += block) {
+        const int n = std::min(block, num_anchors - base);
+        int num_cand = yolox_select(feat_ptr_objectness + base, n, obj_thresh, obj_raw, cand);
+        if (num_cand == 0)
+            continue;
+
+        // dense blocks drop anchors without a passing class before decoding
+        if (num_cand * 4 > n) {
+            yolox_class_max(feat_ptr_cls + base, n, c_stride, num_classes, lut, cls_max, cls_arg);
+            int num_keep = 0;
+            for (int c = 0; c < num_cand; c++) {
+                if (cls_max[cand[c]] > cls_thresh)
+                    cand[num_keep++] = cand[c];
+            }
+            num_cand = num_keep;
+        }
+
+        for (int c = 0; c < num_cand; c++) {
+            tw[c] = yolox_value(feat_ptr_w[base + cand[c]], lut);
+            th[c] = yolox_value(feat_ptr_h[base + cand[c]], lut);
+        }
+        utils::exp_f32(tw, tw, num_cand);
+        utils::exp_f32(th, th, num_cand);
+
+        for (int c = 0; c < num_cand; c++) {
+            const int anchor_idx = base + cand[c];
+            const float stride = anchors.stride[anchor_idx];
+            float w = tw[c] * stride;
+            float h = th[c] * stride;
+            if (w < min_size.width || h < min_size.height)
+                continue;
+            float x0 = (yolox_value(feat_ptr_x_center[anchor_idx], lut) + anchors.grid_x[anchor_idx]) * stride - w * 0.5f;
+            float y0 = (yolox_value(feat_ptr_y_center[anchor_idx], lut) + anchors.grid_y[anchor_idx]) * stride - h * 0.5f;
+
+            for (int class_idx = 0; class_idx < num_classes; class_idx++) {
+                float box_cls_score = yolox_value(feat_ptr_cls[class_idx * c_stride + anchor_idx], lut);
+                if (box_cls_score > cls_thresh) {
+                    push_proposal(proposals, x0, y0, w, h, box_cls_score, class_idx);
+                }
+            }
+        }
+    }
+}
+
 static inline void softmax(AX_U8* src, float* dst, int length, float zero_point, float scale)
 {
     AX_U8 max_value = *std::max_element(src, src + length);
@@ -340,10 +482,35 @@ static inline void softmax(AX_U8* src, float* dst, int length, float zero_point,
     }
 }
 
-static inline void generate_pico_proposals(AX_U8* pred_80_32_nhwc, int stride,
-                                   const int& model_h, const int& model_w, float prob_threshold, std::vector<Object>& objects, int num_class = 80, float scale = 1.0, float zero_point = 0) 
+// Pico heads are quantized as prob^2 (raw = prob^2 / scale + zp), so the class threshold and the
+// argmax are done on raw u8 values and only the survivors are dequantized.
+struct PicoQuantHead
 {
-    prob_threshold = sqrt(prob_threshold * prob_threshold / scale + zero_point + 1e-9);
+    int thresh;             // raw >= thresh passes, 256: nothing passes
+    float scale;
+    float zero_point;
+    float exp_lut[256];     // exp(-d * scale), softmax of the DFL bins relative to their max
+
+    void init(float prob_threshold, float scale_, float zero_point_)
+    {
+        scale = scale_;
+        zero_point = zero_point_;
+        float t = std::ceil(prob_threshold * prob_threshold / scale + zero_point);
+        thresh = t <= 0.f ? 0 : (t > 255.f ? 256 : (int)t);
+        for (int d = 0; d < 256; d++)
+        {
+            exp_lut[d] = std::exp(-d * scale);
+        }
+    }
+};
+
+static inline void generate_pico_proposals(const AX_U8* pred_80_32_nhwc, int stride,
+                                   const int& model_h, const int& model_w, const PicoQuantHead& head, std::vector<Proposal>& proposals, int num_class = 80)
+{
+    if (head.thresh > 255)
+        return;
+
+    const AX_U8 thresh = (AX_U8)head.thresh;
     const int num_grid_x = model_w / stride;
     const int num_grid_y = model_h / stride;
     // Discrete distribution parameter, see the following resources for more details:
@@ -352,56 +519,222 @@ static inline void generate_pico_proposals(AX_U8* pred_80_32_nhwc, int stride,
     const int reg_max_1 = 8; // 32 / 4;
     const int channel = num_class + reg_max_1 * 4;
 
-    for (int i = 0; i < num_grid_y; i++)
+    // class max over blocks of cells, most cells are rejected in the u8 domain here
+    const int num_cells = num_grid_x * num_grid_y;
+    const int block = 64;
+    int cand[block];
+    AX_U8 cand_max[block];
+
+    for (int base = 0; base < num_cells; base += block)
     {
-        for (int j = 0; j < num_grid_x; j++)
+        const int n = std::min(block, num_cells - base);
+        const int num_cand = utils::class_max_nhwc_u8(pred_80_32_nhwc + (size_t)base * channel, n, channel, num_class,
+                                                      thresh, cand, cand_max);
+        for (int c = 0; c < num_cand; c++)
         {
-            const int idx = i * num_grid_x + j;
-            AX_U8* scores = pred_80_32_nhwc + idx * channel;
-            // find label with max score
-            int label = -1;
-            float score = -FLT_MAX;
-
-            for (int k = 0; k < num_class; k++)
+            const int idx = base + cand[c];
+            const int i = idx / num_grid_x;
+            const int j = idx % num_grid_x;
+            const AX_U8* scores = pred_80_32_nhwc + (size_t)idx * channel;
+            const AX_U8 max_score = cand_max[c];
+
+            int label = 0;
+            while (scores[label] != max_score)
+                label++;
+
+            float pred_ltrb[4];
+            for (int k = 0; k < 4; k++)
             {
-                if (scores[k] > score)
+                // predicted distance distribution after softmax, integral on it
+                const AX_U8* bins = scores + num_class + k * reg_max_1;
+                AX_U8 max_bin = *std::max_element(bins, bins + reg_max_1);
+                float denominator = 0.f;
+                float dis = 0.f;
+                for (int l = 0; l < reg_max_1; l++)
                 {
-                    label = k;
-                    score = scores[k];
+                    float e = head.exp_lut[max_bin - bins[l]];
+                    denominator += e;
+                    dis += l * e;
                 }
+                pred_ltrb[k] = dis / denominator * stride;
             }
-            score = sqrt(score + 1e-9);
-            if (score >= prob_threshold)
-            {
-                float pred_ltrb[4];
-                for (int k = 0; k < 4; k++)
-                {
+            // predict box center point
+            float pb_cx = (j + 0.5f) * stride;
+            float pb_cy = (i + 0.5f) * stride;
+            float x0 = pb_cx - pred_ltrb[0]; // left
+            float y0 = pb_cy - pred_ltrb[1]; // top
+            float x1 = pb_cx + pred_ltrb[2]; // right
+            float y1 = pb_cy + pred_ltrb[3]; // bottom
+
+            push_proposal(proposals, x0, y0, x1 - x0, y1 - y0, sqrt((max_score - head.zero_point) * head.scale), label);
+        }
+    }
+}
+
+static inline void generate_pico_proposals(const AX_U8* pred_80_32_nhwc, int stride,
+                                   const int& model_h, const int& model_w, const PicoQuantHead& head, std::vector<Object>& objects, int num_class = 80)
+{
+    std::vector<Proposal> proposals;
+    generate_pico_proposals(pred_80_32_nhwc, stride, model_h, model_w, head, proposals, num_class);
+    to_objects(proposals, objects);
+}
+
+static inline void generate_pico_proposals(AX_U8* pred_80_32_nhwc, int stride,
+                                   const int& model_h, const int& model_w, float prob_threshold, std::vector<Object>& objects, int num_class = 80, float scale = 1.0, float zero_point = 0) 
+{
+    PicoQuantHead head;
+    head.init(prob_threshold, scale, zero_point);
+    generate_pico_proposals(pred_80_32_nhwc, stride, model_h, model_w, head, objects, num_class);
+}
+
+// Per-head decode parameters of the YOLOv5/v8 decoders, built once from the config.
+// Scores are thresholded in the raw domain: u8 through act_lut, float against the threshold's logit.
+struct YoloHead {
+    float zero_point;
+    float scale;
+    bool sigmoid;           // head outputs logits, apply sigmoid to scores (and v5 boxes)
+    float score_thresh;
+    int score_raw;          // u8: raw >= score_raw passes, 256: nothing passes
+    float score_logit;      // float: raw > score_logit passes
+    float act_lut[256];     // u8: activated value of every raw value
+
+    void init(float score_thresh_, bool sigmoid_, float zero_point_ = 0.f, float scale_ = 1.f) {
+        zero_point = zero_point_;
+        scale = scale_;
+        sigmoid = sigmoid_;
+        score_thresh = score_thresh_;
+        for (int r = 0; r < 256; r++) {
+            float v = ((float)r - zero_point) * scale;
+            act_lut[r] = sigmoid ? 1.f / (1.f + std::exp(-v)) : v;
+        }
+        score_raw = 0;
+        while (score_raw < 256 && !(act_lut[score_raw] > score_thresh)) score_raw++;
+        if (!sigmoid)
+            score_logit = score_thresh;
+        else if (score_thresh <= 0.f)
+            score_logit = -FLT_MAX;
+        else if (score_thresh >= 1.f)
+            score_logit = FLT_MAX;
+        else
+            score_logit = std::log(score_thresh / (1.f - score_thresh));
+    }
+
+    float value(AX_U8 v) const { return ((float)v - zero_point) * scale; }
+    float value(float v) const { return v; }
+    float act(AX_U8 v) const { return act_lut[v]; }
+    float act(float v) const { return sigmoid ? 1.f / (1.f + std::exp(-v)) : v; }
+    bool pass(AX_U8 v) const { return (int)v >= score_raw; }
+    bool pass(float v) const { return v > score_logit; }
+};
+
+static inline AX_U8 yolo_hmax(const AX_U8* v, int n) { return utils::hmax_u8(v, n); }
+static inline float yolo_hmax(const float* v, int n) { return utils::hmax_f32(v, n); }
+
+/// @brief YOLOv8 anchor-free head, NHWC [1, h, w, 4 * reg_max + num_class], box before classes.
+///        reg_max > 1: DFL bins per side; reg_max <= 1: the head already outputs ltrb distances (grid units).
+template <typename T>
+static inline void generate_yolov8_proposals(const T* feat, int feat_h, int feat_w, int stride, int num_class, int reg_max,
+                                             const YoloHead& head, std::vector<Proposal>& proposals) {
+    if (head.score_raw > 255)
+        return;
+
+    const int num_box = reg_max > 1 ? 4 * reg_max : 4;
+    const int channel = num_box + num_class;
+    float dfl[4 * 32];
+
+    for (int i = 0; i < feat_h; i++) {
+        for (int j = 0; j < feat_w; j++) {
+            const T* cell = feat + (size_t)(i * feat_w + j) * channel;
+            const T* scores = cell + num_box;
+            T max_score = yolo_hmax(scores, num_class);
+            if (!head.pass(max_score))
+                continue;
+
+            int label = 0;
+            while (scores[label] != max_score)
+                label++;
+
+            float ltrb[4];
+            if (reg_max > 1) {
+                // softmax of every side relative to its max, one vectorised exp for all bins
+                for (int k = 0; k < 4; k++) {
+                    const T* bins = cell + k * reg_max;
+                    float m = head.value(yolo_hmax(bins, reg_max));
+                    for (int l = 0; l < reg_max; l++)
+                        dfl[k * reg_max + l] = head.value(bins[l]) - m;
+                }
+                utils::exp_f32(dfl, dfl, 4 * reg_max);
+                for (int k = 0; k < 4; k++) {
+                    float denominator = 0.f;
                     float dis = 0.f;
-                    // predicted distance distribution after softmax
-                    float dis_after_sm[8] = {0.};
-                    softmax(scores + num_class + k * reg_max_1, dis_after_sm, 8, zero_point, scale);
-                    // integral on predicted discrete distribution
-                    for (int l = 0; l < reg_max_1; l++)
-                    {
-                        dis += l * dis_after_sm[l];
-                        //printf("%2.6f ", dis_after_sm[l]);
+                    for (int l = 0; l < reg_max; l++) {
+                        denominator += dfl[k * reg_max + l];
+                        dis += l * dfl[k * reg_max + l];
                     }
-                    //printf("\n");
-                    pred_ltrb[k] = dis * stride;
+                    ltrb[k] = dis / denominator;
+                }
+            } else {
+                for (int k = 0; k < 4; k++)
+                    ltrb[k] = head.value(cell[k]);
+            }
+
+            float cx = j + 0.5f;
+            float cy = i + 0.5f;
+            float x0 = (cx - ltrb[0]) * stride;
+            float y0 = (cy - ltrb[1]) * stride;
+            float x1 = (cx + ltrb[2]) * stride;
+            float y1 = (cy + ltrb[3]) * stride;
+            push_proposal(proposals, x0, y0, x1 - x0, y1 - y0, head.act(max_score), label);
+        }
+    }
+}
+
+/// @brief YOLOv5 anchor-based head, NHWC [1, h, w, num_anchor * (5 + num_class)], anchors as (w, h) pairs in input pixels.
+///        score = obj * cls, the objectness alone is checked first since cls <= 1.
+template <typename T>
+static inline void generate_yolov5_proposals(const T* feat, int feat_h, int feat_w, int stride, int num_class,
+                                             const std::vector<float>& anchors, const YoloHead& head, std::vector<Proposal>& proposals) {
+    if (head.score_raw > 255)
+        return;
+
+    const int num_anchor = (int)anchors.size() / 2;
+    const int per_anchor = 5 + num_class;
+
+    for (int i = 0; i < feat_h; i++) {
+        for (int j = 0; j < feat_w; j++) {
+            const T* cell = feat + (size_t)(i * feat_w + j) * num_anchor * per_anchor;
+            for (int a = 0; a < num_anchor; a++) {
+                const T* pred = cell + a * per_anchor;
+                if (!head.pass(pred[4]))
+                    continue;
+
+                const T* scores = pred + 5;
+                T max_score = yolo_hmax(scores, num_class);
+                float prob = head.act(pred[4]) * head.act(max_score);
+                if (!(prob > head.score_thresh))
+                    continue;
+
+                int label = 0;
+                while (scores[label] != max_score)
+                    label++;
+
+                float cx, cy, w, h;
+                if (head.sigmoid) {
+                    // yolov5 detect head: xy = (2 * sig - 0.5 + grid) * stride, wh = (2 * sig)^2 * anchor
+                    float tw = head.act(pred[2]) * 2.f;
+                    float th = head.act(pred[3]) * 2.f;
+                    cx = (head.act(pred[0]) * 2.f - 0.5f + j) * stride;
+                    cy = (head.act(pred[1]) * 2.f - 0.5f + i) * stride;
+                    w = tw * tw * anchors[2 * a];
+                    h = th * th * anchors[2 * a + 1];
+                } else {
+                    // decoded in the model, boxes are center/size in input pixels
+                    cx = head.value(pred[0]);
+                    cy = head.value(pred[1]);
+                    w = head.value(pred[2]);
+                    h = head.value(pred[3]);
                 }
-                // predict box center point
-                float pb_cx = (j + 0.5f) * stride;
-                float pb_cy = (i + 0.5f) * stride;
-                float x0 = pb_cx - pred_ltrb[0]; // left
-                float y0 = pb_cy - pred_ltrb[1]; // top
-                float x1 = pb_cx + pred_ltrb[2]; // right
-                float y1 = pb_cy + pred_ltrb[3]; // bottom
-
-                Object obj;
-                obj.label = label;
-                obj.rect = cv::Rect_<float>(x0, y0, x1 - x0, y1 - y0);
-                obj.prob = sqrt((score * score - zero_point) * scale);
-                objects.push_back(obj);
+                push_proposal(proposals, cx - w * 0.5f, cy - h * 0.5f, w, h, prob, label);
             }
         }
     }
@@ -453,11 +786,67 @@ static inline void reverse_letterbox(std::vector<Object>& proposal, std::vector<
     }
 }
 
+/// @brief Map the proposals from begin on (and their points) from a model input to frame coords: (v - pad) / scale + offset
+static inline void map_proposals(ProposalArena& arena, size_t begin, float scale, float pad_x, float pad_y, float off_x, float off_y) {
+    float inv_scale = 1.f / scale;
+    for (size_t i = begin; i < arena.proposals.size(); i++) {
+        Proposal& p = arena.proposals[i];
+        p.x = (p.x - pad_x) * inv_scale + off_x;
+        p.y = (p.y - pad_y) * inv_scale + off_y;
+        p.w *= inv_scale;
+        p.h *= inv_scale;
+
+        if (arena.num_points > 0) {
+            ai_point_t* pts = &arena.points[(size_t)p.index * arena.num_points];
+            for (int k = 0; k < arena.num_points; k++) {
+                pts[k].x = (pts[k].x - pad_x) * inv_scale + off_x;
+                pts[k].y = (pts[k].y - pad_y) * inv_scale + off_y;
+            }
+        }
+    }
+}
+
+/// @brief NMS the arena proposals, already in frame coords (see map_proposals), and clip the survivors into objects (appended)
+static inline void get_out_bbox(ProposalArena& arena, std::vector<Object>& objects, const NmsParams& params, int src_rows, int src_cols) {
+    to_nms_boxes(arena.proposals, arena.nms);
+    nms(arena.nms, params, arena.picked);
+
+    size_t base = objects.size();
+    objects.resize(base + arena.picked.size());
+    for (size_t i = 0; i < arena.picked.size(); i++) {
+        const Proposal& p = arena.proposals[arena.picked[i]];
+        Object& obj = objects[base + i];
+        float x0 = std::max(std::min(p.x, (float)(src_cols - 1)), 0.f);
+        float y0 = std::max(std::min(p.y, (float)(src_rows - 1)), 0.f);
+        float x1 = std::max(std::min(p.x + p.w, (float)(src_cols - 1)), 0.f);
+        float y1 = std::max(std::min(p.y + p.h, (float)(src_rows - 1)), 0.f);
+
+        obj.rect = cv::Rect_<float>(x0, y0, x1 - x0, y1 - y0);
+        obj.iou_rect = obj.rect;
+        obj.prob = arena.nms.score[arena.picked[i]];
+        obj.label = p.label;
+
+        if (arena.num_points > 0) {
+            const ai_point_t* pts = &arena.points[(size_t)p.index * arena.num_points];
+            obj.points.assign(pts, pts + arena.num_points);
+        }
+    }
+}
+
+/// @brief Drop the objects whose label is not in want_classes, an empty list keeps everything
+static inline void filter_classes(std::vector<Object>& objects, const std::vector<int>& want_classes) {
+    if (want_classes.empty())
+        return;
+
+    objects.erase(std::remove_if(objects.begin(), objects.end(), [&want_classes](const Object& obj) {
+        return std::find(want_classes.begin(), want_classes.end(), obj.label) == want_classes.end();
+    }), objects.end());
+}
+
 static inline void get_out_bbox(std::vector<Object>& proposals, std::vector<Object>& objects, const float nms_threshold, int letterbox_rows,
                   int letterbox_cols, int src_rows, int src_cols) {
-    qsort_descent_inplace(proposals);
     std::vector<int> picked;
-    nms_sorted_bboxes(proposals, picked, nms_threshold);
+    nms_objects(proposals, picked, NmsParams(nms_threshold));
 
     float ratio_x = (float)src_rows / letterbox_rows;
     float ratio_y = (float)src_cols / letterbox_cols;
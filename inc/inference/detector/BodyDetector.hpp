@@ -10,8 +10,6 @@
 
 #pragma once
 
-#if 0
-
 #include "inference/detector/yolox.hpp"
 
 namespace infer
@@ -33,6 +31,4 @@ namespace infer
 
         ~BodyDetector() = default;
     };
-}
-
-#endif
\ No newline at end of file
+}
\ No newline at end of file
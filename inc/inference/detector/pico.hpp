@@ -39,9 +39,24 @@ namespace infer
 
         ~Pico() = default;
 
-        void SetConfig(const PicoConfig& config)
+        int Init(const std::string& strModelPath)
+        {
+            int ret = EngineWrapper::Init(strModelPath);
+            if (ret != 0)
+                return ret;
+
+            // no config yet, SetConfig builds them
+            if (m_config.strides.empty())
+                return 0;
+            return CreateHeads();
+        }
+
+        int SetConfig(const PicoConfig& config)
         {
             m_config = config;
+            if (m_hasInit)
+                return CreateHeads();
+            return 0;
         }
 
         PicoConfig GetConfig() const
@@ -52,58 +67,94 @@ namespace infer
         int Detect(const AX_VIDEO_FRAME_T& img, 
                 std::vector<detection::Object>& outputs)
         {
-            if (!m_hasInit)
+            m_arena.reset();
+            int ret = Propose(img, cv::Rect(), m_arena);
+            if (ret != 0)
+                return ret;
+
+            // nms & clip coords & select class
+            outputs.clear();
+            detection::get_out_bbox(m_arena, outputs, detection::NmsParams(m_config.nms_thresh), img.u32Height, img.u32Width);
+            detection::filter_classes(outputs, m_config.want_classes);
+
+            return 0;
+        }
+
+        /// @brief Append the proposals of crop_rect of img (empty: whole frame) to arena in frame coords, no NMS
+        int Propose(const AX_VIDEO_FRAME_T& img, const cv::Rect& crop_rect, detection::ProposalArena& arena)
+        {
+            if (!m_hasInit || m_heads.size() != (size_t)m_output_num)
                 return -1;
 
-            int ret = 0;
+            int ret = Preprocess(img, crop_rect);
+            if (ret != 0)
+                return ret;
 
-            AX_VIDEO_FRAME_T dst;
-            ret = Preprocess(img, dst);
+            ret = Run();
             if (ret != 0)
-            {
-                utils::FreeFrame(dst);
                 return ret;
-            }
 
-            ret = Run(dst);
+            Decode(utils::GetCropResizeMap(img, cv::Size(m_input_size[1], m_input_size[0]), crop_rect), arena);
+            return 0;
+        }
+
+        /// @brief Same on an input the caller already cropped & resized, map takes it back to the frame
+        int Propose(const AX_VIDEO_FRAME_T& input, const utils::CropResizeMap& map, detection::ProposalArena& arena)
+        {
+            if (!m_hasInit || m_heads.size() != (size_t)m_output_num)
+                return -1;
+
+            int ret = Run(input);
             if (ret != 0)
-            {
-                utils::FreeFrame(dst);
                 return ret;
-            }
-            
-            utils::FreeFrame(dst);
 
-            // generate proposals
-            std::vector<detection::Object> proposals;
-            for (int i = 0; i < m_output_num; i++)
-            {
-                auto& buf = m_io.pOutputs[i];
-                axALGO::cache_io_flush(&buf);
+            Decode(map, arena);
+            return 0;
+        }
 
-                AX_U8* puBuf = (AX_U8*)buf.pVirAddr;
-                detection::generate_pico_proposals(puBuf, m_config.strides[i], m_input_size[0], m_input_size[1], m_config.cls_thresh, proposals, m_config.num_class, m_config.scales[i], m_config.zps[i]);
+    protected:
+        /// @brief Check the outputs against the config and build the per head decode parameters
+        int CreateHeads()
+        {
+            m_heads.clear();
+            if (m_config.strides.size() < (size_t)m_output_num
+                || m_config.zps.size() < (size_t)m_output_num || m_config.scales.size() < (size_t)m_output_num)
+            {
+                printf("Pico: %d outputs but %d strides, %d zps, %d scales\n", m_output_num,
+                       (int)m_config.strides.size(), (int)m_config.zps.size(), (int)m_config.scales.size());
+                return -1;
             }
 
-            // nms & rescale coords & select class
-            outputs.clear();
-            detection::get_out_bbox(proposals, outputs, m_config.nms_thresh, m_input_size[0], m_input_size[1], img.u32Height, img.u32Width);
-
-            if (!m_config.want_classes.empty())
+            std::vector<detection::PicoQuantHead> heads(m_output_num);
+            for (int i = 0; i < m_output_num; i++)
             {
-                for (auto it = outputs.begin(); it != outputs.end(); )
+                if (m_io_info->pOutputs[i].eDataType != AX_ENGINE_DT_UINT8)
                 {
-                    if (std::find(m_config.want_classes.begin(), m_config.want_classes.end(), it->label) == m_config.want_classes.end())
-                        it = outputs.erase(it);
-                    else
-                        it++;
+                    printf("Pico: output %d is not quantized\n", i);
+                    return -1;
                 }
+                heads[i].init(m_config.cls_thresh, m_config.scales[i], m_config.zps[i]);
             }
-
+            m_heads.swap(heads);
             return 0;
         }
 
-    protected:
+        void Decode(const utils::CropResizeMap& map, detection::ProposalArena& arena)
+        {
+            size_t begin = arena.proposals.size();
+            for (int i = 0; i < m_output_num; i++)
+            {
+                auto& buf = m_io.pOutputs[i];
+                axALGO::cache_io_flush(&buf);
+
+                AX_U8* puBuf = (AX_U8*)buf.pVirAddr;
+                detection::generate_pico_proposals(puBuf, m_config.strides[i], m_input_size[0], m_input_size[1], m_heads[i], arena.proposals, m_config.num_class);
+            }
+            detection::map_proposals(arena, begin, map.scale, map.pad_x, map.pad_y, map.crop_x, map.crop_y);
+        }
+
         PicoConfig m_config;
+        std::vector<detection::PicoQuantHead> m_heads;
+        detection::ProposalArena m_arena;
     };
 }
\ No newline at end of file
@@ -0,0 +1,287 @@
+/**************************************************************************************************
+ *
+ * Copyright (c) 2019-2023 Axera Semiconductor (Shanghai) Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Axera Semiconductor (Shanghai) Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Axera Semiconductor (Shanghai) Co., Ltd.
+ *
+ **************************************************************************************************/
+
+#pragma once
+
+#include "inference/engine_wrapper.hpp"
+#include "inference/detection.hpp"
+
+#include "utils/io.hpp"
+#include "utils/frame_utils.hpp"
+#include "utils/frame_pool.hpp"
+
+#include "opencv2/core.hpp"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+#define TILE_CROP_RING      16      // tiles prepared per IVPS batch
+
+namespace infer
+{
+    struct TileConfig
+    {
+        int rows;                   // grid over the frame, 1x1 is the plain full frame detector
+        int cols;
+        float overlap;              // fraction of a tile shared with its neighbour, so objects on a seam are whole in one tile
+        bool full_frame;            // also run the whole frame, for objects larger than a tile
+        float nms_thresh;           // cross-tile merge, class aware
+        float overlap_ratio;        // > 0: also merge boxes covering this ratio of each other, the parts cut at a seam
+        float cut_penalty;          // merge score factor of boxes touching a seam of their tile, so whole boxes of a neighbour
+                                    // tile or the full frame win the merge; outputs keep their own score. 1: off
+        int max_detections;         // <= 0: no limit
+
+        TileConfig():
+            rows(2),
+            cols(2),
+            overlap(0.2f),
+            full_frame(true),
+            nms_thresh(0.5f),
+            overlap_ratio(0.7f),
+            cut_penalty(0.5f),
+            max_detections(0)
+        { }
+    };
+
+    /// @brief Runs any detector with Propose() (Pico, YoloX, Yolo and their children) on overlapping tiles
+    ///        or caller given rois of the frame, so small objects keep their pixels instead of being
+    ///        letterboxed down with the full frame. Crops go through one IVPS batch into a pre-allocated ring,
+    ///        the npu runs on them back to back and one NMS merges the proposals of every tile.
+    template <typename Detector>
+    class TiledDetector : public Detector
+    {
+    public:
+        TiledDetector():
+            m_tile_ring_ready(false)
+        {
+            SetTileConfig(TileConfig());
+        }
+
+        ~TiledDetector() = default;
+
+        void SetTileConfig(const TileConfig& config)
+        {
+            m_tile_config = config;
+            m_tile_config.rows = std::max(config.rows, 1);
+            m_tile_config.cols = std::max(config.cols, 1);
+            m_tile_config.overlap = std::max(std::min(config.overlap, 0.9f), 0.f);
+
+            m_tile_nms = detection::NmsParams(m_tile_config.nms_thresh);
+            m_tile_nms.overlap_ratio = m_tile_config.overlap_ratio;
+            m_tile_nms.max_detections = m_tile_config.max_detections;
+            m_tile_nms.class_aware = true;
+        }
+
+        TileConfig GetTileConfig() const
+        {
+            return m_tile_config;
+        }
+
+        /// @brief rows x cols tiles covering frame_size, neighbours share overlap of a tile, outer tiles touch the borders
+        static void MakeTiles(const cv::Size& frame_size, int rows, int cols, float overlap, std::vector<cv::Rect>& tiles)
+        {
+            tiles.clear();
+            int tile_w = (int)std::ceil(frame_size.width / (cols - (cols - 1) * overlap));
+            int tile_h = (int)std::ceil(frame_size.height / (rows - (rows - 1) * overlap));
+            tile_w = std::min(tile_w, frame_size.width);
+            tile_h = std::min(tile_h, frame_size.height);
+
+            for (int r = 0; r < rows; r++)
+            {
+                int y = rows > 1 ? (int)std::lround((double)r * (frame_size.height - tile_h) / (rows - 1)) : 0;
+                for (int c = 0; c < cols; c++)
+                {
+                    int x = cols > 1 ? (int)std::lround((double)c * (frame_size.width - tile_w) / (cols - 1)) : 0;
+                    tiles.push_back(cv::Rect(x, y, tile_w, tile_h));
+                }
+            }
+        }
+
+        /// @brief Turn regions of interest (motion blobs, predicted tracks) into rois worth a model run:
+        ///        each is grown by context of its size, made at least min_size, clipped to the frame,
+        ///        and rois that cover less together than apart are merged.
+        static void MakeRois(const std::vector<cv::Rect>& regions, const cv::Size& frame_size, float context, const cv::Size& min_size, std::vector<cv::Rect>& rois)
+        {
+            rois.clear();
+            const cv::Rect frame_rect(0, 0, frame_size.width, frame_size.height);
+            for (const auto& region : regions)
+            {
+                int w = std::max((int)std::lround(region.width * (1.f + 2 * context)), min_size.width);
+                int h = std::max((int)std::lround(region.height * (1.f + 2 * context)), min_size.height);
+                w = std::min(w, frame_size.width);
+                h = std::min(h, frame_size.height);
+                int x = std::max(std::min(region.x + region.width / 2 - w / 2, frame_size.width - w), 0);
+                int y = std::max(std::min(region.y + region.height / 2 - h / 2, frame_size.height - h), 0);
+                cv::Rect roi = cv::Rect(x, y, w, h) & frame_rect;
+                if (roi.area() > 0)
+                    rois.push_back(roi);
+            }
+
+            bool merged = true;
+            while (merged)
+            {
+                merged = false;
+                for (size_t i = 0; i < rois.size() && !merged; i++)
+                {
+                    for (size_t j = i + 1; j < rois.size(); j++)
+                    {
+                        cv::Rect u = rois[i] | rois[j];
+                        if (u.area() <= rois[i].area() + rois[j].area())
+                        {
+                            rois[i] = u;
+                            rois.erase(rois.begin() + j);
+                            merged = true;
+                            break;
+                        }
+                    }
+                }
+            }
+        }
+
+        /// @brief Detect on the configured grid of tiles
+        int Detect(const AX_VIDEO_FRAME_T& img,
+                std::vector<detection::Object>& outputs)
+        {
+            MakeTiles(cv::Size(img.u32Width, img.u32Height), m_tile_config.rows, m_tile_config.cols, m_tile_config.overlap, m_tiles);
+            if (m_tile_config.full_frame && m_tiles.size() > 1)
+                m_tiles.push_back(cv::Rect(0, 0, img.u32Width, img.u32Height));
+            return DetectRois(img, m_tiles, outputs);
+        }
+
+        /// @brief Detect on the given rois only, merged across rois. Rois outside img are skipped.
+        int DetectRois(const AX_VIDEO_FRAME_T& img,
+                const std::vector<cv::Rect>& rois,
+                std::vector<detection::Object>& outputs)
+        {
+            if (!this->m_hasInit)
+                return -1;
+
+            if (img.enImgFormat != this->m_input_format)
+            {
+                printf("DetectRois: frame format 0x%02X, model expects 0x%02X\n", img.enImgFormat, this->m_input_format);
+                return AX_ERR_ALGO_ILLEGAL_PARAM;
+            }
+
+            const cv::Size input_size(this->m_input_size[1], this->m_input_size[0]);
+            if (!m_tile_ring_ready)
+            {
+                int ret = m_tile_ring.Reserve(input_size, this->m_input_format, TILE_CROP_RING);
+                if (ret != 0)
+                    return ret;
+                m_tile_ring_ready = true;
+            }
+
+            const cv::Size frame_size(img.u32Width, img.u32Height);
+            const cv::Rect frame_rect(0, 0, img.u32Width, img.u32Height);
+            m_tile_arena.reset();
+            m_tile_prob.clear();
+
+            int ret = 0;
+            for (size_t base = 0; base < rois.size() && ret == 0; base += TILE_CROP_RING)
+            {
+                cv::Rect rects[TILE_CROP_RING];
+                AX_VIDEO_FRAME_T crops[TILE_CROP_RING];
+                AX_VIDEO_FRAME_T* dsts[TILE_CROP_RING];
+                int num = 0;
+
+                size_t end = std::min(rois.size(), base + TILE_CROP_RING);
+                for (size_t i = base; i < end; i++)
+                {
+                    cv::Rect rect = rois[i] & frame_rect;
+                    if (rect.width < 2 || rect.height < 2)
+                        continue;
+
+                    ret = m_tile_ring.Acquire(crops[num], input_size, this->m_input_format);
+                    if (ret != 0)
+                        break;
+                    rects[num] = rect;
+                    dsts[num] = &crops[num];
+                    num++;
+                }
+
+                if (ret == 0 && num > 0)
+                    ret = utils::CropResizeToFrames(img, rects, dsts, num);
+
+                for (int k = 0; k < num && ret == 0; k++)
+                {
+                    cv::Rect aligned = utils::AlignCropRect(rects[k], frame_size);
+                    size_t begin = m_tile_arena.proposals.size();
+                    ret = Detector::Propose(crops[k], utils::GetCropResizeMap(aligned, input_size), m_tile_arena);
+                    if (ret == 0)
+                        PenalizeCut(aligned, frame_size, begin);
+                }
+
+                for (int k = 0; k < num; k++)
+                {
+                    m_tile_ring.Recycle(crops[k]);
+                }
+            }
+
+            // Preprocess targets the own input buffer again
+            this->ResetInputs();
+            if (ret != 0)
+                return ret;
+
+            // one nms over every tile & clip coords & select class
+            outputs.clear();
+            detection::get_out_bbox(m_tile_arena, outputs, m_tile_nms, img.u32Height, img.u32Width);
+            // the cut penalty only ranks the merge, the survivors keep their own score
+            for (size_t i = 0; i < m_tile_arena.picked.size(); i++)
+            {
+                outputs[i].prob = m_tile_prob[m_tile_arena.picked[i]];
+            }
+            detection::filter_classes(outputs, this->m_config.want_classes);
+
+            return 0;
+        }
+
+        int Release()
+        {
+            m_tile_ring.Destroy();
+            m_tile_ring_ready = false;
+            return Detector::Release();
+        }
+
+    protected:
+        /// @brief Lower the merge score of the proposals from begin on that touch a side of tile inside the frame,
+        ///        their scores are kept in m_tile_prob first
+        void PenalizeCut(const cv::Rect& tile, const cv::Size& frame_size, size_t begin)
+        {
+            m_tile_prob.resize(m_tile_arena.proposals.size());
+            for (size_t i = begin; i < m_tile_arena.proposals.size(); i++)
+            {
+                m_tile_prob[i] = m_tile_arena.proposals[i].prob;
+            }
+            if (m_tile_config.cut_penalty >= 1.f)
+                return;
+
+            const float margin = 2.f;
+            const float left = tile.x > 0 ? tile.x + margin : -FLT_MAX;
+            const float top = tile.y > 0 ? tile.y + margin : -FLT_MAX;
+            const float right = tile.x + tile.width < frame_size.width ? tile.x + tile.width - margin : FLT_MAX;
+            const float bottom = tile.y + tile.height < frame_size.height ? tile.y + tile.height - margin : FLT_MAX;
+            for (size_t i = begin; i < m_tile_arena.proposals.size(); i++)
+            {
+                detection::Proposal& p = m_tile_arena.proposals[i];
+                if (p.x <= left || p.y <= top || p.x + p.w >= right || p.y + p.h >= bottom)
+                    p.prob *= m_tile_config.cut_penalty;
+            }
+        }
+
+        TileConfig m_tile_config;
+        detection::NmsParams m_tile_nms;
+        detection::ProposalArena m_tile_arena;
+        std::vector<float> m_tile_prob;     // unpenalised score per arena proposal
+        std::vector<cv::Rect> m_tiles;
+        utils::FramePool m_tile_ring;
+        bool m_tile_ring_ready;
+    };
+}
@@ -0,0 +1,245 @@
+/**************************************************************************************************
+ *
+ * Copyright (c) 2019-2023 Axera Semiconductor (Shanghai) Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Axera Semiconductor (Shanghai) Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Axera Semiconductor (Shanghai) Co., Ltd.
+ *
+ **************************************************************************************************/
+
+#pragma once
+
+#include "inference/engine_wrapper.hpp"
+#include "inference/detection.hpp"
+
+#include "utils/io.hpp"
+#include "utils/frame_utils.hpp"
+
+#include <algorithm>
+
+namespace infer
+{
+    enum YoloHeadType
+    {
+        YOLO_HEAD_V5 = 0,       // anchor based, [x y w h obj cls...] per anchor
+        YOLO_HEAD_V8,           // anchor free, [DFL bins (or ltrb) cls...]
+    };
+
+    /// @brief One NHWC output per stride, in strides order; u8 outputs are decoded with zps/scales
+    struct YoloConfig
+    {
+        YoloHeadType head_type;
+        std::vector<int> strides;
+        std::vector<std::vector<float>> anchors;    // v5: (w, h) pairs per output, input pixels
+        int num_class;
+        int reg_max;                                // v8: DFL bins per side (<= 32), <= 1 when the model outputs distances
+        bool sigmoid;                               // outputs are logits, v5 boxes not decoded yet
+        float cls_thresh;
+        float nms_thresh;
+        bool class_aware_nms;
+        int top_k;                                  // proposals kept for NMS, <= 0: all
+        int max_detections;                         // <= 0: no limit
+        std::vector<float> zps;
+        std::vector<float> scales;
+        std::vector<int> want_classes;
+
+        YoloConfig():
+            head_type(YOLO_HEAD_V8),
+            num_class(80),
+            reg_max(16),
+            sigmoid(true),
+            cls_thresh(0.25f),
+            nms_thresh(0.45f),
+            class_aware_nms(true),
+            top_k(0),
+            max_detections(300)
+        { }
+    };
+
+    class Yolo : public EngineWrapper
+    {
+    public:
+        Yolo()
+        { }
+
+        ~Yolo() = default;
+
+        int Init(const std::string& strModelPath)
+        {
+            int ret = EngineWrapper::Init(strModelPath);
+            if (ret != 0)
+                return ret;
+
+            // no config yet, SetConfig builds them
+            if (m_config.strides.empty())
+                return 0;
+            return CreateHeads();
+        }
+
+        int SetConfig(const YoloConfig& config)
+        {
+            m_config = config;
+            if (m_hasInit)
+                return CreateHeads();
+            return 0;
+        }
+
+        YoloConfig GetConfig() const
+        {
+            return m_config;
+        }
+
+        int Detect(const AX_VIDEO_FRAME_T& img,
+                std::vector<detection::Object>& outputs)
+        {
+            m_arena.reset();
+            int ret = Propose(img, cv::Rect(), m_arena);
+            if (ret != 0)
+                return ret;
+
+            // nms & clip coords & select class
+            outputs.clear();
+            detection::get_out_bbox(m_arena, outputs, m_nms, img.u32Height, img.u32Width);
+            detection::filter_classes(outputs, m_config.want_classes);
+
+            return 0;
+        }
+
+        /// @brief Append the proposals of crop_rect of img (empty: whole frame) to arena in frame coords, no NMS
+        int Propose(const AX_VIDEO_FRAME_T& img, const cv::Rect& crop_rect, detection::ProposalArena& arena)
+        {
+            if (!m_hasInit || m_heads.size() != (size_t)m_output_num)
+                return -1;
+
+            int ret = Preprocess(img, crop_rect);
+            if (ret != 0)
+                return ret;
+
+            ret = Run();
+            if (ret != 0)
+                return ret;
+
+            Decode(utils::GetCropResizeMap(img, cv::Size(m_input_size[1], m_input_size[0]), crop_rect), arena);
+            return 0;
+        }
+
+        /// @brief Same on an input the caller already cropped & resized, map takes it back to the frame
+        int Propose(const AX_VIDEO_FRAME_T& input, const utils::CropResizeMap& map, detection::ProposalArena& arena)
+        {
+            if (!m_hasInit || m_heads.size() != (size_t)m_output_num)
+                return -1;
+
+            int ret = Run(input);
+            if (ret != 0)
+                return ret;
+
+            Decode(map, arena);
+            return 0;
+        }
+
+    protected:
+        /// @brief Check the outputs against the config and build the per head decode parameters
+        int CreateHeads()
+        {
+            m_heads.clear();
+            if (m_config.strides.size() != (size_t)m_output_num)
+            {
+                printf("Yolo: %d outputs but %d strides\n", m_output_num, (int)m_config.strides.size());
+                return -1;
+            }
+            if (m_config.head_type == YOLO_HEAD_V8 && m_config.reg_max > 32)
+            {
+                printf("Yolo: reg_max %d is larger than 32\n", m_config.reg_max);
+                return -1;
+            }
+            if (m_config.head_type == YOLO_HEAD_V5 && m_config.anchors.size() != (size_t)m_output_num)
+            {
+                printf("Yolo: %d outputs but %d anchor groups\n", m_output_num, (int)m_config.anchors.size());
+                return -1;
+            }
+
+            std::vector<detection::YoloHead> heads(m_output_num);
+            for (int i = 0; i < m_output_num; i++)
+            {
+                auto& output_info = m_io_info->pOutputs[i];
+                int channel = 0;
+                if (m_config.head_type == YOLO_HEAD_V8)
+                    channel = (m_config.reg_max > 1 ? 4 * m_config.reg_max : 4) + m_config.num_class;
+                else
+                    channel = (int)m_config.anchors[i].size() / 2 * (5 + m_config.num_class);
+
+                if (output_info.nShapeSize != 4 || output_info.pShape[3] != channel
+                    || output_info.pShape[1] * m_config.strides[i] != m_input_size[0]
+                    || output_info.pShape[2] * m_config.strides[i] != m_input_size[1])
+                {
+                    printf("Yolo: output %d is not a NHWC head of %d channels at stride %d\n", i, channel, m_config.strides[i]);
+                    return -1;
+                }
+
+                if (output_info.eDataType == AX_ENGINE_DT_UINT8)
+                {
+                    if (m_config.zps.size() <= (size_t)i || m_config.scales.size() <= (size_t)i)
+                    {
+                        printf("Yolo: output %d is quantized but has no zp/scale\n", i);
+                        return -1;
+                    }
+                    heads[i].init(m_config.cls_thresh, m_config.sigmoid, m_config.zps[i], m_config.scales[i]);
+                }
+                else if (output_info.eDataType == AX_ENGINE_DT_FLOAT32)
+                {
+                    heads[i].init(m_config.cls_thresh, m_config.sigmoid);
+                }
+                else
+                {
+                    printf("Yolo: unsupported data type %d of output %d\n", output_info.eDataType, i);
+                    return -1;
+                }
+            }
+            m_heads.swap(heads);
+
+            m_nms = detection::NmsParams(m_config.nms_thresh);
+            m_nms.class_aware = m_config.class_aware_nms;
+            m_nms.top_k = m_config.top_k;
+            m_nms.max_detections = m_config.max_detections;
+            return 0;
+        }
+
+        /// @brief Decode straight from the output buffers
+        void Decode(const utils::CropResizeMap& map, detection::ProposalArena& arena)
+        {
+            size_t begin = arena.proposals.size();
+            for (int i = 0; i < m_output_num; i++)
+            {
+                auto& output_info = m_io_info->pOutputs[i];
+                auto& buf = m_io.pOutputs[i];
+                int feat_h = output_info.pShape[1];
+                int feat_w = output_info.pShape[2];
+                int stride = m_config.strides[i];
+
+                if (output_info.eDataType == AX_ENGINE_DT_UINT8)
+                {
+                    const AX_U8* feat = (const AX_U8*)buf.pVirAddr;
+                    if (m_config.head_type == YOLO_HEAD_V8)
+                        detection::generate_yolov8_proposals(feat, feat_h, feat_w, stride, m_config.num_class, m_config.reg_max, m_heads[i], arena.proposals);
+                    else
+                        detection::generate_yolov5_proposals(feat, feat_h, feat_w, stride, m_config.num_class, m_config.anchors[i], m_heads[i], arena.proposals);
+                }
+                else
+                {
+                    const float* feat = (const float*)buf.pVirAddr;
+                    if (m_config.head_type == YOLO_HEAD_V8)
+                        detection::generate_yolov8_proposals(feat, feat_h, feat_w, stride, m_config.num_class, m_config.reg_max, m_heads[i], arena.proposals);
+                    else
+                        detection::generate_yolov5_proposals(feat, feat_h, feat_w, stride, m_config.num_class, m_config.anchors[i], m_heads[i], arena.proposals);
+                }
+            }
+            detection::map_proposals(arena, begin, map.scale, map.pad_x, map.pad_y, map.crop_x, map.crop_y);
+        }
+
+        YoloConfig m_config;
+        std::vector<detection::YoloHead> m_heads;
+        detection::NmsParams m_nms;
+        detection::ProposalArena m_arena;
+    };
+}
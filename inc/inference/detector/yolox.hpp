@@ -10,8 +10,6 @@
 
 #pragma once
 
-#if 0
-
 #include "inference/engine_wrapper.hpp"
 #include "inference/detection.hpp"
 
@@ -37,15 +35,29 @@ namespace infer
     class YoloX : public EngineWrapper
     {
     public:
-        YoloX():
-            m_isAnchorCreated(false)
+        YoloX()
         { }
 
         ~YoloX() = default;
 
-        void SetConfig(const YoloXConfig& config)
+        int Init(const std::string& strModelPath)
+        {
+            int ret = EngineWrapper::Init(strModelPath);
+            if (ret != 0)
+                return ret;
+
+            // no config yet, SetConfig builds them
+            if (m_config.strides.empty())
+                return 0;
+            return CreateAnchors();
+        }
+
+        int SetConfig(const YoloXConfig& config)
         {
             m_config = config;
+            if (m_hasInit)
+                return CreateAnchors();
+            return 0;
         }
 
         YoloXConfig GetConfig() const
@@ -53,80 +65,127 @@ namespace infer
             return m_config;
         }
 
-        int CreateAnchors()
+        int Detect(const AX_VIDEO_FRAME_T& img, 
+                std::vector<detection::Object>& outputs)
         {
-            m_anchors.resize(m_output_num);
-            for (uint32_t i = 0; i < m_output_num; ++i) {
-                detection::generate_grids_and_stride(m_input_size[1], m_input_size[0], m_config.strides[i], m_anchors[i]);
-            }
+            m_arena.reset();
+            int ret = Propose(img, cv::Rect(), m_arena);
+            if (ret != 0)
+                return ret;
+
+            // nms & clip coords & select class
+            outputs.clear();
+            detection::get_out_bbox(m_arena, outputs, detection::NmsParams(m_config.nms_thresh), img.u32Height, img.u32Width);
+            detection::filter_classes(outputs, m_config.want_classes);
+
             return 0;
         }
 
-        int Detect(const AX_VIDEO_FRAME_T& img, 
-                std::vector<detection::Object>& outputs)
+        /// @brief Append the proposals of crop_rect of img (empty: whole frame) to arena in frame coords, no NMS
+        int Propose(const AX_VIDEO_FRAME_T& img, const cv::Rect& crop_rect, detection::ProposalArena& arena)
         {
-            if (!m_hasInit)
+            if (!m_hasInit || m_anchors.size() != (size_t)m_output_num)
                 return -1;
 
-            int ret = 0;
-
-            if (!m_isAnchorCreated)
-            {
-                m_isAnchorCreated = true;
-                CreateAnchors();
-            }
+            int ret = Preprocess(img, crop_rect);
+            if (ret != 0)
+                return ret;
 
-            AX_VIDEO_FRAME_T dst;
-            ret = Preprocess(img, dst);
+            ret = Run();
             if (ret != 0)
-            {
-                utils::FreeFrame(dst);
                 return ret;
-            }
 
-            ret = Run(dst);
+            Decode(utils::GetCropResizeMap(img, cv::Size(m_input_size[1], m_input_size[0]), crop_rect), arena);
+            return 0;
+        }
+
+        /// @brief Same on an input the caller already cropped & resized, map takes it back to the frame
+        int Propose(const AX_VIDEO_FRAME_T& input, const utils::CropResizeMap& map, detection::ProposalArena& arena)
+        {
+            if (!m_hasInit || m_anchors.size() != (size_t)m_output_num)
+                return -1;
+
+            int ret = Run(input);
             if (ret != 0)
-            {
-                utils::FreeFrame(dst);
                 return ret;
+
+            Decode(map, arena);
+            return 0;
+        }
+
+    protected:
+        /// @brief Check the outputs against the config and build the anchor tables once
+        int CreateAnchors()
+        {
+            m_anchors.clear();
+            if (m_config.strides.size() != (size_t)m_output_num)
+            {
+                printf("YoloX: %d outputs but %d stride groups\n", m_output_num, (int)m_config.strides.size());
+                return -1;
             }
-            utils::FreeFrame(dst);
 
-            // generate proposals
-            std::vector<detection::Object> proposals;
+            std::vector<detection::YoloXAnchors> anchors(m_output_num);
             for (int i = 0; i < m_output_num; i++)
             {
                 auto& output_info = m_io_info->pOutputs[i];
-                auto& buf = m_io.pOutputs[i];
-                axALGO::cache_io_flush(&buf);
+                if (output_info.nShapeSize != 4)
+                {
+                    printf("YoloX: output %d is not NCHW\n", i);
+                    return -1;
+                }
+                if (output_info.eDataType == AX_ENGINE_DT_UINT8)
+                {
+                    if (m_config.zps.size() <= (size_t)i || m_config.scales.size() <= (size_t)i)
+                    {
+                        printf("YoloX: output %d is quantized but has no zp/scale\n", i);
+                        return -1;
+                    }
+                    if (output_info.pShape[1] - 5 > 256)
+                    {
+                        printf("YoloX: quantized output %d has more than 256 classes\n", i);
+                        return -1;
+                    }
+                }
+                else if (output_info.eDataType != AX_ENGINE_DT_FLOAT32)
+                {
+                    printf("YoloX: unsupported data type %d of output %d\n", output_info.eDataType, i);
+                    return -1;
+                }
 
-                float* pfBuf = (float*)buf.pVirAddr;
-                detection::generate_yolox_proposals(m_anchors[i], output_info, pfBuf, m_config.obj_thresh, m_config.cls_thresh, m_config.min_size, proposals);
+                detection::generate_yolox_anchors(m_input_size[1], m_input_size[0], m_config.strides[i], anchors[i]);
+                if (anchors[i].stride.size() != (size_t)(output_info.pShape[2] * output_info.pShape[3]))
+                {
+                    printf("YoloX: strides of output %d do not match its %dx%d grid\n", i, output_info.pShape[2], output_info.pShape[3]);
+                    return -1;
+                }
             }
+            m_anchors.swap(anchors);
+            return 0;
+        }
 
-            // nms & rescale coords & select class
-            outputs.clear();
-            detection::get_out_bbox(proposals, outputs, m_config.nms_thresh, m_input_size[0], m_input_size[1], img.u32Height, img.u32Width);
-
-            if (!m_config.want_classes.empty())
+        void Decode(const utils::CropResizeMap& map, detection::ProposalArena& arena)
+        {
+            size_t begin = arena.proposals.size();
+            for (int i = 0; i < m_output_num; i++)
             {
-                for (auto it = outputs.begin(); it != outputs.end(); )
+                auto& output_info = m_io_info->pOutputs[i];
+                auto& buf = m_io.pOutputs[i];
+
+                if (output_info.eDataType == AX_ENGINE_DT_UINT8)
+                {
+                    detection::generate_yolox_proposals(m_anchors[i], output_info, (const AX_U8*)buf.pVirAddr, m_config.obj_thresh, m_config.cls_thresh, m_config.min_size, arena.proposals,
+                                                        m_config.zps[i], m_config.scales[i]);
+                }
+                else
                 {
-                    if (std::find(m_config.want_classes.begin(), m_config.want_classes.end(), it->label) == m_config.want_classes.end())
-                        it = outputs.erase(it);
-                    else
-                        it++;
+                    detection::generate_yolox_proposals(m_anchors[i], output_info, (const float*)buf.pVirAddr, m_config.obj_thresh, m_config.cls_thresh, m_config.min_size, arena.proposals);
                 }
             }
-
-            return 0;
+            detection::map_proposals(arena, begin, map.scale, map.pad_x, map.pad_y, map.crop_x, map.crop_y);
         }
 
-    protected:
-        bool m_isAnchorCreated;
-        std::vector<std::vector<detection::GridAndStride>> m_anchors;
+        std::vector<detection::YoloXAnchors> m_anchors;
         YoloXConfig m_config;
+        detection::ProposalArena m_arena;
     };
-}
-
-#endif
\ No newline at end of file
+}
\ No newline at end of file
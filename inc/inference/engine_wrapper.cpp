@@ -347,6 +347,18 @@ namespace infer
             printf("prepare io failed!\n");
             return deinit_handle();
         }
+        m_input_buffers.assign(m_io.pInputs, m_io.pInputs + m_io.nInputSize);
+
+        // 6.1 input 0 as a frame, so preprocess can write into it directly
+        m_input_format = eDtype;
+        ret = utils::WrapFrame(m_input_frame, m_input_buffers[0].phyAddr, m_input_buffers[0].pVirAddr, m_input_buffers[0].nSize,
+                               cv::Size(m_input_size[1], m_input_size[0]), m_input_format);
+        if (0 != ret) {
+            printf("ALGO model(%s) input 0 is not an image\n", strModelPath.c_str());
+            axALGO::free_io(m_io);
+            m_input_buffers.clear();
+            return deinit_handle();
+        }
 
         m_handle = handle;
         m_hasInit = true;
@@ -359,13 +371,29 @@ namespace infer
         return utils::CropResizeFrame(src, dst, cv::Size(m_input_size[1], m_input_size[0]), crop_rect);
     }
 
+    int EngineWrapper::Preprocess(const AX_VIDEO_FRAME_T& src, const cv::Rect& crop_rect)
+    {
+        if (!m_hasInit)
+            return -1;
+
+        if (src.enImgFormat != m_input_format)
+        {
+            printf("Preprocess: frame format 0x%02X, model expects 0x%02X\n", src.enImgFormat, m_input_format);
+            return AX_ERR_ALGO_ILLEGAL_PARAM;
+        }
+
+        // input 0 may still point to a frame bound by Run(frame)
+        m_io.pInputs[0] = m_input_buffers[0];
+        return utils::CropResizeToFrame(src, m_input_frame, crop_rect);
+    }
+
     int EngineWrapper::Run(const AX_VIDEO_FRAME_T& stFrame)
     {
         if (!m_hasInit)
             return -1;
 
         // 7.1 fill input & prepare to inference
-        auto ret = axALGO::push_io_input(&stFrame, m_io);
+        auto ret = BindInput(0, stFrame);
 
         if (0 != ret) {
             printf("push_io_input failed.\n");
@@ -373,24 +401,162 @@ namespace infer
             return ret;
         }
 
+        return Run();
+    }
+
+    int EngineWrapper::Run()
+    {
+        if (!m_hasInit)
+            return -1;
+
         // 7.3 run & benchmark
-        {
-            ret = AX_ENGINE_RunSync(m_handle, &m_io);
-            if (0 != ret) {
-                printf("AX_ENGINE_RunSync failed.\n");
-                ret = AX_ERR_ALGO_INVALID_HANDLE;
-                return ret;
+        auto ret = AX_ENGINE_RunSync(m_handle, &m_io);
+        if (0 != ret) {
+            printf("AX_ENGINE_RunSync failed.\n");
+            ret = AX_ERR_ALGO_INVALID_HANDLE;
+            return ret;
+        }
+
+        for (int i = 0; i < m_output_num; i++) {
+            const auto& buf = m_io.pOutputs[i];
+            if (buf.phyAddr != 0) {
+                AX_SYS_MinvalidateCache(buf.phyAddr, buf.pVirAddr, buf.nSize);
             }
         }
 
         return ret;
     }
 
+    int EngineWrapper::GetInputIndex(const std::string& name) const
+    {
+        if (!m_io_info)
+            return -1;
+        return axALGO::find_io_index(m_io_info->pInputs, m_io_info->nInputSize, name);
+    }
+
+    int EngineWrapper::GetOutputIndex(const std::string& name) const
+    {
+        if (!m_io_info)
+            return -1;
+        return axALGO::find_io_index(m_io_info->pOutputs, m_io_info->nOutputSize, name);
+    }
+
+    const AX_ENGINE_IOMETA_T* EngineWrapper::GetInputMeta(int index) const
+    {
+        if (!m_hasInit || index < 0 || index >= m_input_num)
+            return nullptr;
+        return &m_io_info->pInputs[index];
+    }
+
+    const AX_ENGINE_IOMETA_T* EngineWrapper::GetOutputMeta(int index) const
+    {
+        if (!m_hasInit || index < 0 || index >= m_output_num)
+            return nullptr;
+        return &m_io_info->pOutputs[index];
+    }
+
+    const AX_ENGINE_IO_BUFFER_T* EngineWrapper::GetOutput(int index) const
+    {
+        if (!m_hasInit || index < 0 || index >= m_output_num)
+            return nullptr;
+        return &m_io.pOutputs[index];
+    }
+
+    int EngineWrapper::SetInput(int index, const void* data, int size)
+    {
+        if (!m_hasInit)
+            return -1;
+
+        if (index < 0 || index >= m_input_num || !data)
+        {
+            printf("SetInput: invalid input %d\n", index);
+            return AX_ERR_ALGO_ILLEGAL_PARAM;
+        }
+
+        auto& own = m_input_buffers[index];
+        if (size != (int)own.nSize)
+        {
+            printf("SetInput: input %s expects %u bytes, got %d\n", m_io_info->pInputs[index].pName, own.nSize, size);
+            return AX_ERR_ALGO_ILLEGAL_PARAM;
+        }
+
+        m_io.pInputs[index] = own;
+        memcpy(own.pVirAddr, data, size);
+        axALGO::cache_io_flush(&own);
+        return AX_ALGO_SUCC;
+    }
+
+    int EngineWrapper::BindInput(int index, AX_U64 phyAddr, void* virAddr, int size)
+    {
+        if (!m_hasInit)
+            return -1;
+
+        if (index < 0 || index >= m_input_num || !virAddr)
+        {
+            printf("BindInput: invalid input %d\n", index);
+            return AX_ERR_ALGO_ILLEGAL_PARAM;
+        }
+
+        // npu can only read from CMM
+        if (phyAddr == 0)
+            return SetInput(index, virAddr, size);
+
+        if (size < (int)m_input_buffers[index].nSize)
+        {
+            printf("BindInput: input %s expects %u bytes, got %d\n", m_io_info->pInputs[index].pName, m_input_buffers[index].nSize, size);
+            return AX_ERR_ALGO_ILLEGAL_PARAM;
+        }
+
+        auto& buf = m_io.pInputs[index];
+        buf.phyAddr = phyAddr;
+        buf.pVirAddr = virAddr;
+        buf.nSize = (AX_U32)size;
+        return AX_ALGO_SUCC;
+    }
+
+    int EngineWrapper::BindInput(int index, const AX_VIDEO_FRAME_T& stFrame)
+    {
+        if (!m_hasInit)
+            return -1;
+
+        if (index < 0 || index >= m_input_num)
+            return AX_ERR_ALGO_ILLEGAL_PARAM;
+
+        if (stFrame.u64PhyAddr[0] == 0)
+            return SetInput(index, (const void*)stFrame.u64VirAddr[0], (int)stFrame.u32FrameSize);
+
+        return axALGO::push_io_input(&stFrame, m_io, (AX_U32)index);
+    }
+
+    int EngineWrapper::SetInputFromOutput(int input_index, int output_index)
+    {
+        const AX_ENGINE_IO_BUFFER_T* out = GetOutput(output_index);
+        if (!out)
+            return AX_ERR_ALGO_ILLEGAL_PARAM;
+
+        // copied, the next Run overwrites the output while reading the input
+        return SetInput(input_index, out->pVirAddr, (int)out->nSize);
+    }
+
+    void EngineWrapper::ResetInputs()
+    {
+        for (size_t i = 0; i < m_input_buffers.size(); i++)
+            m_io.pInputs[i] = m_input_buffers[i];
+    }
+
     int EngineWrapper::Release()
     {
+        if (m_hasInit) {
+            ResetInputs();
+            axALGO::free_io(m_io);
+            memset(&m_io, 0, sizeof(m_io));
+            m_input_buffers.clear();
+        }
         if (m_handle) {
             AX_ENGINE_DestroyHandle(m_handle);
+            m_handle = nullptr;
         }
+        m_hasInit = false;
         return AX_ALGO_SUCC;
     }
 }
\ No newline at end of file
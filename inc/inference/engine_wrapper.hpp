@@ -90,8 +90,15 @@ namespace infer
     public:
         EngineWrapper():
             m_hasInit(false),
-            m_handle(nullptr)
-        { }
+            m_handle(nullptr),
+            m_io_info(nullptr),
+            m_input_format(AX_FORMAT_YUV420_SEMIPLANAR),
+            m_input_num(0),
+            m_output_num(0)
+        {
+            memset(&m_io, 0, sizeof(m_io));
+            memset(&m_input_frame, 0, sizeof(m_input_frame));
+        }
         
         ~EngineWrapper() = default;
 
@@ -103,18 +110,64 @@ namespace infer
         /// @return 
         int Preprocess(const AX_VIDEO_FRAME_T& src, AX_VIDEO_FRAME_T& dst, const cv::Rect& crop_rect = cv::Rect());
 
+        /// @brief Crop & resize src straight into the input 0 buffer, no allocation.
+        ///        Follow with Run().
+        int Preprocess(const AX_VIDEO_FRAME_T& src, const cv::Rect& crop_rect = cv::Rect());
+
+        /// @brief Bind stFrame to input 0 and run
         int Run(const AX_VIDEO_FRAME_T& stFrame);
 
+        /// @brief Run with the inputs currently bound
+        int Run();
+
         int Release();
 
         inline std::array<int, 2> GetInputSize() const { return m_input_size; }
 
+        inline int GetInputNum() const { return m_input_num; }
+        inline int GetOutputNum() const { return m_output_num; }
+
+        /// @brief Index of the named tensor, -1 if not found
+        int GetInputIndex(const std::string& name) const;
+        int GetOutputIndex(const std::string& name) const;
+
+        const AX_ENGINE_IOMETA_T* GetInputMeta(int index) const;
+        const AX_ENGINE_IOMETA_T* GetOutputMeta(int index) const;
+        const AX_ENGINE_IOMETA_T* GetOutputMeta(const std::string& name) const { return GetOutputMeta(GetOutputIndex(name)); }
+
+        /// @brief Output buffer of the last Run, cache invalidated
+        const AX_ENGINE_IO_BUFFER_T* GetOutput(int index) const;
+        const AX_ENGINE_IO_BUFFER_T* GetOutput(const std::string& name) const { return GetOutput(GetOutputIndex(name)); }
+
+        /// @brief Copy data into the input's own buffer, size must match the tensor size
+        int SetInput(int index, const void* data, int size);
+        int SetInput(const std::string& name, const void* data, int size) { return SetInput(GetInputIndex(name), data, size); }
+
+        /// @brief Bind an external buffer to the input without copy.
+        ///        Buffers without physical address (not CMM) are copied into the input's own buffer.
+        ///        The buffer must stay valid until the next Run returns.
+        int BindInput(int index, AX_U64 phyAddr, void* virAddr, int size);
+        int BindInput(const std::string& name, AX_U64 phyAddr, void* virAddr, int size) { return BindInput(GetInputIndex(name), phyAddr, virAddr, size); }
+        int BindInput(int index, const AX_VIDEO_FRAME_T& stFrame);
+
+        /// @brief Copy an output of the last Run into an input, e.g. the state of recurrent models
+        int SetInputFromOutput(int input_index, int output_index);
+        int SetInputFromOutput(const std::string& input, const std::string& output) { return SetInputFromOutput(GetInputIndex(input), GetOutputIndex(output)); }
+
+        /// @brief Point every input back to its own buffer
+        void ResetInputs();
+
     protected:
         bool m_hasInit;
         std::array<int, 2> m_input_size;
         AX_ENGINE_HANDLE m_handle;
         AX_ENGINE_IO_INFO_T* m_io_info;
         AX_ENGINE_IO_T m_io;
+        // buffers allocated by prepare_io, m_io.pInputs may point elsewhere after BindInput
+        std::vector<AX_ENGINE_IO_BUFFER_T> m_input_buffers;
+        // input 0 buffer seen as an image, target of Preprocess
+        AX_VIDEO_FRAME_T m_input_frame;
+        AX_IMG_FORMAT_E m_input_format;
         int m_input_num, m_output_num;
     };
 }
\ No newline at end of file
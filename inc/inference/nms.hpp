@@ -0,0 +1,304 @@
+/**************************************************************************************************
+ *
+ * Copyright (c) 2019-2023 Axera Semiconductor (Ningbo) Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Axera Semiconductor (Ningbo) Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Axera Semiconductor (Ningbo) Co., Ltd.
+ *
+ **************************************************************************************************/
+
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <vector>
+
+#include "utils/simd_utils.hpp"
+
+/*
+ * Non maximum suppression on structure-of-arrays boxes.
+ * Proposals are ordered through an index sort (top-k with a partial sort), a candidate is compared
+ * against the kept boxes 4 at a time and stops at the first suppressor.
+ * Class-aware NMS runs all classes in one pass: a box can only be suppressed by a kept box with
+ * the same label, which gives the class-offset trick's result without moving coordinates.
+ */
+
+namespace detection {
+enum NmsMethod {
+    NMS_HARD = 0,           // IoU > iou_thresh
+    NMS_DIOU,               // IoU - d^2 / c^2 > iou_thresh, d: center distance, c: enclosing box diagonal
+    NMS_SOFT_LINEAR,        // score *= 1 - IoU when IoU > iou_thresh
+    NMS_SOFT_GAUSSIAN,      // score *= exp(-IoU^2 / soft_sigma)
+};
+
+struct NmsParams {
+    NmsMethod method;
+    float iou_thresh;
+    float overlap_ratio;    // > 0: also suppress when the intersection covers this ratio of either box (hard/DIoU)
+    float soft_sigma;
+    float score_thresh;     // soft NMS drops boxes decayed below it
+    int top_k;              // candidates kept after sorting, <= 0: all
+    int max_detections;     // stop once this many boxes are kept, <= 0: no limit
+    bool class_aware;
+
+    NmsParams(float iou = 0.45f) {
+        method = NMS_HARD;
+        iou_thresh = iou;
+        overlap_ratio = 0.f;
+        soft_sigma = 0.5f;
+        score_thresh = 0.001f;
+        top_k = 0;
+        max_detections = 0;
+        class_aware = false;
+    }
+};
+
+/// @brief Input boxes plus the kept set used while suppressing; reuse one instance to avoid allocations
+struct NmsBoxes {
+    std::vector<float> x0, y0, x1, y1, area, score, label;
+    std::vector<int> order;
+
+    // kept boxes, compacted so the inner loop is contiguous
+    std::vector<float> k_x0, k_y0, k_x1, k_y1, k_area, k_label;
+
+    void clear() {
+        x0.clear(); y0.clear(); x1.clear(); y1.clear();
+        area.clear(); score.clear(); label.clear();
+    }
+
+    void reserve(int n) {
+        x0.reserve(n); y0.reserve(n); x1.reserve(n); y1.reserve(n);
+        area.reserve(n); score.reserve(n); label.reserve(n);
+    }
+
+    int size() const { return (int)score.size(); }
+
+    void push(float x, float y, float w, float h, float s, int l) {
+        x0.push_back(x);
+        y0.push_back(y);
+        x1.push_back(x + w);
+        y1.push_back(y + h);
+        area.push_back(w * h);
+        score.push_back(s);
+        label.push_back((float)l);
+    }
+};
+
+/// @brief Indices of the top_k (all when <= 0) highest scores in descending order, ties keep the lower index
+static inline int nms_sort_indices(const float* scores, int n, int top_k, std::vector<int>& order) {
+    order.resize(n);
+    std::iota(order.begin(), order.end(), 0);
+    auto cmp = [scores](int a, int b) {
+        return scores[a] > scores[b] || (scores[a] == scores[b] && a < b);
+    };
+    if (top_k > 0 && top_k < n) {
+        std::partial_sort(order.begin(), order.begin() + top_k, order.end(), cmp);
+        order.resize(top_k);
+    } else {
+        std::sort(order.begin(), order.end(), cmp);
+    }
+    return (int)order.size();
+}
+
+static inline bool nms_suppress_scalar(const NmsBoxes& b, int i, int k, const NmsParams& p) {
+    if (p.class_aware && b.k_label[k] != b.label[i])
+        return false;
+
+    float iw = std::min(b.x1[i], b.k_x1[k]) - std::max(b.x0[i], b.k_x0[k]);
+    float ih = std::min(b.y1[i], b.k_y1[k]) - std::max(b.y0[i], b.k_y0[k]);
+    float inter = (iw > 0.f && ih > 0.f) ? iw * ih : 0.f;
+    float uni = b.area[i] + b.k_area[k] - inter;
+
+    if (p.overlap_ratio > 0.f && (inter > p.overlap_ratio * b.area[i] || inter > p.overlap_ratio * b.k_area[k]))
+        return true;
+
+    if (p.method == NMS_DIOU) {
+        // iou - d2 / c2 > t, multiplied out to stay division free
+        float dx = (b.x0[i] + b.x1[i]) - (b.k_x0[k] + b.k_x1[k]);
+        float dy = (b.y0[i] + b.y1[i]) - (b.k_y0[k] + b.k_y1[k]);
+        float cw = std::max(b.x1[i], b.k_x1[k]) - std::min(b.x0[i], b.k_x0[k]);
+        float ch = std::max(b.y1[i], b.k_y1[k]) - std::min(b.y0[i], b.k_y0[k]);
+        float d2 = (dx * dx + dy * dy) * 0.25f;
+        float c2 = cw * cw + ch * ch;
+        return inter * c2 - d2 * uni > p.iou_thresh * uni * c2;
+    }
+    return inter > p.iou_thresh * uni;
+}
+
+/// @brief True when any of the kept boxes suppresses candidate i (hard and DIoU)
+static inline bool nms_suppressed(const NmsBoxes& b, int i, int num_kept, const NmsParams& p) {
+    int k = 0;
+#if defined(UTILS_SIMD_NEON) || defined(UTILS_SIMD_SSE2)
+    const bool diou = p.method == NMS_DIOU;
+    const bool ratio = p.overlap_ratio > 0.f;
+#endif
+#if defined(UTILS_SIMD_NEON)
+    const float32x4_t ax0 = vdupq_n_f32(b.x0[i]), ay0 = vdupq_n_f32(b.y0[i]);
+    const float32x4_t ax1 = vdupq_n_f32(b.x1[i]), ay1 = vdupq_n_f32(b.y1[i]);
+    const float32x4_t aarea = vdupq_n_f32(b.area[i]), alabel = vdupq_n_f32(b.label[i]);
+    const float32x4_t t = vdupq_n_f32(p.iou_thresh), r = vdupq_n_f32(p.overlap_ratio);
+    const float32x4_t zero = vdupq_n_f32(0.f);
+    for (; k + 4 <= num_kept; k += 4) {
+        float32x4_t bx0 = vld1q_f32(&b.k_x0[k]), by0 = vld1q_f32(&b.k_y0[k]);
+        float32x4_t bx1 = vld1q_f32(&b.k_x1[k]), by1 = vld1q_f32(&b.k_y1[k]);
+        float32x4_t barea = vld1q_f32(&b.k_area[k]);
+        float32x4_t iw = vmaxq_f32(vsubq_f32(vminq_f32(ax1, bx1), vmaxq_f32(ax0, bx0)), zero);
+        float32x4_t ih = vmaxq_f32(vsubq_f32(vminq_f32(ay1, by1), vmaxq_f32(ay0, by0)), zero);
+        float32x4_t inter = vmulq_f32(iw, ih);
+        float32x4_t uni = vsubq_f32(vaddq_f32(aarea, barea), inter);
+        uint32x4_t m;
+        if (diou) {
+            float32x4_t dx = vsubq_f32(vaddq_f32(ax0, ax1), vaddq_f32(bx0, bx1));
+            float32x4_t dy = vsubq_f32(vaddq_f32(ay0, ay1), vaddq_f32(by0, by1));
+            float32x4_t cw = vsubq_f32(vmaxq_f32(ax1, bx1), vminq_f32(ax0, bx0));
+            float32x4_t ch = vsubq_f32(vmaxq_f32(ay1, by1), vminq_f32(ay0, by0));
+            float32x4_t d2 = vmulq_f32(vaddq_f32(vmulq_f32(dx, dx), vmulq_f32(dy, dy)), vdupq_n_f32(0.25f));
+            float32x4_t c2 = vaddq_f32(vmulq_f32(cw, cw), vmulq_f32(ch, ch));
+            m = vcgtq_f32(vsubq_f32(vmulq_f32(inter, c2), vmulq_f32(d2, uni)), vmulq_f32(vmulq_f32(t, uni), c2));
+        } else {
+            m = vcgtq_f32(inter, vmulq_f32(t, uni));
+        }
+        if (ratio)
+            m = vorrq_u32(m, vorrq_u32(vcgtq_f32(inter, vmulq_f32(r, aarea)), vcgtq_f32(inter, vmulq_f32(r, barea))));
+        if (p.class_aware)
+            m = vandq_u32(m, vceqq_f32(alabel, vld1q_f32(&b.k_label[k])));
+        uint64x2_t m64 = vreinterpretq_u64_u32(m);
+        if (vgetq_lane_u64(m64, 0) | vgetq_lane_u64(m64, 1))
+            return true;
+    }
+#elif defined(UTILS_SIMD_SSE2)
+    const __m128 ax0 = _mm_set1_ps(b.x0[i]), ay0 = _mm_set1_ps(b.y0[i]);
+    const __m128 ax1 = _mm_set1_ps(b.x1[i]), ay1 = _mm_set1_ps(b.y1[i]);
+    const __m128 aarea = _mm_set1_ps(b.area[i]), alabel = _mm_set1_ps(b.label[i]);
+    const __m128 t = _mm_set1_ps(p.iou_thresh), r = _mm_set1_ps(p.overlap_ratio);
+    const __m128 zero = _mm_setzero_ps();
+    for (; k + 4 <= num_kept; k += 4) {
+        __m128 bx0 = _mm_loadu_ps(&b.k_x0[k]), by0 = _mm_loadu_ps(&b.k_y0[k]);
+        __m128 bx1 = _mm_loadu_ps(&b.k_x1[k]), by1 = _mm_loadu_ps(&b.k_y1[k]);
+        __m128 barea = _mm_loadu_ps(&b.k_area[k]);
+        __m128 iw = _mm_max_ps(_mm_sub_ps(_mm_min_ps(ax1, bx1), _mm_max_ps(ax0, bx0)), zero);
+        __m128 ih = _mm_max_ps(_mm_sub_ps(_mm_min_ps(ay1, by1), _mm_max_ps(ay0, by0)), zero);
+        __m128 inter = _mm_mul_ps(iw, ih);
+        __m128 uni = _mm_sub_ps(_mm_add_ps(aarea, barea), inter);
+        __m128 m;
+        if (diou) {
+            __m128 dx = _mm_sub_ps(_mm_add_ps(ax0, ax1), _mm_add_ps(bx0, bx1));
+            __m128 dy = _mm_sub_ps(_mm_add_ps(ay0, ay1), _mm_add_ps(by0, by1));
+            __m128 cw = _mm_sub_ps(_mm_max_ps(ax1, bx1), _mm_min_ps(ax0, bx0));
+            __m128 ch = _mm_sub_ps(_mm_max_ps(ay1, by1), _mm_min_ps(ay0, by0));
+            __m128 d2 = _mm_mul_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_set1_ps(0.25f));
+            __m128 c2 = _mm_add_ps(_mm_mul_ps(cw, cw), _mm_mul_ps(ch, ch));
+            m = _mm_cmpgt_ps(_mm_sub_ps(_mm_mul_ps(inter, c2), _mm_mul_ps(d2, uni)), _mm_mul_ps(_mm_mul_ps(t, uni), c2));
+        } else {
+            m = _mm_cmpgt_ps(inter, _mm_mul_ps(t, uni));
+        }
+        if (ratio)
+            m = _mm_or_ps(m, _mm_or_ps(_mm_cmpgt_ps(inter, _mm_mul_ps(r, aarea)), _mm_cmpgt_ps(inter, _mm_mul_ps(r, barea))));
+        if (p.class_aware)
+            m = _mm_and_ps(m, _mm_cmpeq_ps(alabel, _mm_loadu_ps(&b.k_label[k])));
+        if (_mm_movemask_ps(m))
+            return true;
+    }
+#endif
+    for (; k < num_kept; k++) {
+        if (nms_suppress_scalar(b, i, k, p))
+            return true;
+    }
+    return false;
+}
+
+static inline void nms_keep(NmsBoxes& b, int i, int num_kept) {
+    b.k_x0[num_kept] = b.x0[i];
+    b.k_y0[num_kept] = b.y0[i];
+    b.k_x1[num_kept] = b.x1[i];
+    b.k_y1[num_kept] = b.y1[i];
+    b.k_area[num_kept] = b.area[i];
+    b.k_label[num_kept] = b.label[i];
+}
+
+static inline float nms_iou(const NmsBoxes& b, int i, int j) {
+    float iw = std::min(b.x1[i], b.x1[j]) - std::max(b.x0[i], b.x0[j]);
+    float ih = std::min(b.y1[i], b.y1[j]) - std::max(b.y0[i], b.y0[j]);
+    float inter = (iw > 0.f && ih > 0.f) ? iw * ih : 0.f;
+    float uni = b.area[i] + b.area[j] - inter;
+    return uni > 0.f ? inter / uni : 0.f;
+}
+
+/// @brief Soft NMS, picks the best remaining box and decays the rest; b.score holds the decayed scores
+static inline void soft_nms(NmsBoxes& b, const NmsParams& p, std::vector<int>& picked) {
+    std::vector<int>& remain = b.order;
+    const int limit = p.max_detections > 0 ? p.max_detections : (int)remain.size();
+
+    while (!remain.empty() && (int)picked.size() < limit) {
+        int best = 0;
+        for (int r = 1; r < (int)remain.size(); r++) {
+            if (b.score[remain[r]] > b.score[remain[best]])
+                best = r;
+        }
+        const int i = remain[best];
+        picked.push_back(i);
+        remain[best] = remain.back();
+        remain.pop_back();
+
+        for (int r = 0; r < (int)remain.size();) {
+            const int j = remain[r];
+            if (!p.class_aware || b.label[j] == b.label[i]) {
+                float iou = nms_iou(b, i, j);
+                if (p.method == NMS_SOFT_LINEAR) {
+                    if (iou > p.iou_thresh)
+                        b.score[j] *= 1.f - iou;
+                } else {
+                    b.score[j] *= std::exp(-iou * iou / p.soft_sigma);
+                }
+            }
+            if (b.score[j] < p.score_thresh) {
+                remain[r] = remain.back();
+                remain.pop_back();
+            } else {
+                r++;
+            }
+        }
+    }
+}
+
+static inline void nms_run(NmsBoxes& b, const NmsParams& p, std::vector<int>& picked) {
+    picked.clear();
+    if (p.method == NMS_SOFT_LINEAR || p.method == NMS_SOFT_GAUSSIAN) {
+        soft_nms(b, p, picked);
+        return;
+    }
+
+    const int n = (int)b.order.size();
+    const int limit = p.max_detections > 0 ? std::min(p.max_detections, n) : n;
+    b.k_x0.resize(limit); b.k_y0.resize(limit); b.k_x1.resize(limit); b.k_y1.resize(limit);
+    b.k_area.resize(limit); b.k_label.resize(limit);
+
+    int num_kept = 0;
+    for (int o = 0; o < n && num_kept < limit; o++) {
+        const int i = b.order[o];
+        if (nms_suppressed(b, i, num_kept, p))
+            continue;
+        nms_keep(b, i, num_kept++);
+        picked.push_back(i);
+    }
+}
+
+/// @brief NMS over boxes already in descending score order, picked holds indices into b
+static inline void nms_sorted(NmsBoxes& b, const NmsParams& p, std::vector<int>& picked) {
+    int n = b.size();
+    if (p.top_k > 0)
+        n = std::min(n, p.top_k);
+    b.order.resize(n);
+    std::iota(b.order.begin(), b.order.end(), 0);
+    nms_run(b, p, picked);
+}
+
+/// @brief Sort (top_k) and suppress, picked holds indices into b in descending score order
+static inline void nms(NmsBoxes& b, const NmsParams& p, std::vector<int>& picked) {
+    nms_sort_indices(b.score.data(), b.size(), p.top_k, b.order);
+    nms_run(b, p, picked);
+}
+}  // namespace detection
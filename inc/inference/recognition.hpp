@@ -10,6 +10,11 @@
 
 #pragma once
 
+#include <cmath>
+#include <cstdint>
+
+#include "utils/simd_utils.hpp"
+
 #define BODY_KP_NUM     17
 
 namespace recognition {
@@ -33,4 +38,90 @@ namespace recognition {
         {14, 16}
     };
 
+    typedef struct {
+        float x;
+        float y;
+        float score;
+    } Keypoint;
+
+    enum HeatmapRefine {
+        HEATMAP_REFINE_NONE = 0,
+        HEATMAP_REFINE_QUARTER,     // quarter cell towards the higher neighbour
+        HEATMAP_REFINE_DARK,        // Taylor expansion of the log heatmap around the max (DARK)
+    };
+
+    /// @brief Sub-pixel offset of the max at (x, y); at(x, y) reads a dequantized heatmap value
+    template <typename F>
+    static inline void refine_heatmap_max(const F& at, int w, int h, int x, int y, HeatmapRefine refine, float* dx, float* dy) {
+        *dx = 0.f;
+        *dy = 0.f;
+        if (refine == HEATMAP_REFINE_NONE)
+            return;
+
+        if (refine == HEATMAP_REFINE_DARK && x > 0 && x < w - 1 && y > 0 && y < h - 1) {
+            auto L = [&](int xx, int yy) { return std::log(std::max(at(xx, yy), 1e-10f)); };
+            float c = L(x, y);
+            float gx = 0.5f * (L(x + 1, y) - L(x - 1, y));
+            float gy = 0.5f * (L(x, y + 1) - L(x, y - 1));
+            float hxx = L(x + 1, y) - 2.f * c + L(x - 1, y);
+            float hyy = L(x, y + 1) - 2.f * c + L(x, y - 1);
+            float hxy = 0.25f * (L(x + 1, y + 1) - L(x + 1, y - 1) - L(x - 1, y + 1) + L(x - 1, y - 1));
+            float det = hxx * hyy - hxy * hxy;
+            if (std::fabs(det) > 1e-6f) {
+                float ox = -(hyy * gx - hxy * gy) / det;
+                float oy = -(hxx * gy - hxy * gx) / det;
+                // a flat or saddle neighbourhood gives a far offset, fall back to the quarter rule then
+                if (std::fabs(ox) <= 1.f && std::fabs(oy) <= 1.f) {
+                    *dx = ox;
+                    *dy = oy;
+                    return;
+                }
+            }
+        }
+
+        if (x > 0 && x < w - 1) {
+            float d = at(x + 1, y) - at(x - 1, y);
+            *dx = d > 0.f ? 0.25f : (d < 0.f ? -0.25f : 0.f);
+        }
+        if (y > 0 && y < h - 1) {
+            float d = at(x, y + 1) - at(x, y - 1);
+            *dy = d > 0.f ? 0.25f : (d < 0.f ? -0.25f : 0.f);
+        }
+    }
+
+    /// @brief Keypoints of num_kp NCHW float heatmaps, in heatmap cells, score = heatmap max
+    static inline void decode_heatmaps(const float* heatmaps, int num_kp, int h, int w, HeatmapRefine refine, Keypoint* kps) {
+        const int c_stride = h * w;
+        for (int k = 0; k < num_kp; k++) {
+            const float* hm = heatmaps + (size_t)k * c_stride;
+            float max_value;
+            int idx = utils::argmax_f32(hm, c_stride, &max_value);
+            int x = idx % w;
+            int y = idx / w;
+            float dx, dy;
+            refine_heatmap_max([hm, w](int xx, int yy) { return hm[yy * w + xx]; }, w, h, x, y, refine, &dx, &dy);
+            kps[k].x = x + dx;
+            kps[k].y = y + dy;
+            kps[k].score = max_value;
+        }
+    }
+
+    /// @brief u8 heatmaps: the argmax runs on raw values, only the max and its neighbours are dequantized
+    static inline void decode_heatmaps(const uint8_t* heatmaps, int num_kp, int h, int w, float zero_point, float scale,
+                                       HeatmapRefine refine, Keypoint* kps) {
+        const int c_stride = h * w;
+        for (int k = 0; k < num_kp; k++) {
+            const uint8_t* hm = heatmaps + (size_t)k * c_stride;
+            uint8_t max_value;
+            int idx = utils::argmax_u8(hm, c_stride, &max_value);
+            int x = idx % w;
+            int y = idx / w;
+            float dx, dy;
+            refine_heatmap_max([hm, w, zero_point, scale](int xx, int yy) { return ((float)hm[yy * w + xx] - zero_point) * scale; },
+                               w, h, x, y, refine, &dx, &dy);
+            kps[k].x = x + dx;
+            kps[k].y = y + dy;
+            kps[k].score = ((float)max_value - zero_point) * scale;
+        }
+    }
 }
\ No newline at end of file
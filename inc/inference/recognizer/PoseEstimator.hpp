@@ -15,12 +15,15 @@
 
 #include "utils/io.hpp"
 #include "utils/frame_utils.hpp"
+#include "utils/frame_pool.hpp"
 
 #include "opencv2/core.hpp"
 // #include "opencv2/imgproc.hpp"
 
 #include <algorithm>
 
+#define POSE_CROP_RING      16      // crops prepared per IVPS batch by RecognizeAll
+
 namespace infer
 {
     const std::vector<cv::Scalar> COCO_SKELETON_Colors = {
@@ -44,90 +47,102 @@ namespace infer
         {255,   0,      85}
     };
 
-    void find_max_2d(float* buf, int width, int height, int* max_idx_width, int* max_idx_height, float* max_value) 
-    {
-        *max_value = -10.f;
-        *max_idx_width = 0;
-        *max_idx_height = 0;
-        for (int h = 0; h < height; h++) {
-            for (int w = 0; w < width; w++) {
-                float score = buf[h * width + w];
-                if (score > *max_value) {
-                    *max_value = score;
-                    *max_idx_height = h;
-                    *max_idx_width = w;
-                }
-            }
-        }
-    }
-
     class PoseEstimator : public EngineWrapper
     {
     public:
-        PoseEstimator()
+        PoseEstimator():
+            m_refine(recognition::HEATMAP_REFINE_QUARTER),
+            m_heatmap_zp(0.f),
+            m_heatmap_scale(1.f),
+            m_crop_ring_ready(false)
         { }
 
         ~PoseEstimator() = default;
 
+        void SetRefine(recognition::HeatmapRefine refine)
+        {
+            m_refine = refine;
+        }
+
+        /// @brief Quantization of u8 heatmap outputs, float outputs ignore it
+        void SetHeatmapQuant(float zero_point, float scale)
+        {
+            m_heatmap_zp = zero_point;
+            m_heatmap_scale = scale;
+        }
+
+        /// @brief Keypoints in img coordinates with their heatmap score, src_size: size of img, an empty bbox is all of it
         int Postprocess(const AX_ENGINE_IOMETA_T& output_info, 
                         AX_ENGINE_IO_BUFFER_T& buf, 
                         const cv::Rect& bbox,
-                        std::vector<cv::Point>& outputs)
+                        const cv::Size& src_size,
+                        std::vector<recognition::Keypoint>& outputs)
         {
             int num_kp = output_info.pShape[1];
             int feat_h = output_info.pShape[2];
             int feat_w = output_info.pShape[3];
-            int c_stride = feat_h * feat_w;
 
-            float max_val;
-            int x, y;
+            outputs.resize(num_kp);
+            if (output_info.eDataType == AX_ENGINE_DT_UINT8)
+                recognition::decode_heatmaps((const uint8_t*)buf.pVirAddr, num_kp, feat_h, feat_w, m_heatmap_zp, m_heatmap_scale, m_refine, outputs.data());
+            else if (output_info.eDataType == AX_ENGINE_DT_FLOAT32)
+                recognition::decode_heatmaps((const float*)buf.pVirAddr, num_kp, feat_h, feat_w, m_refine, outputs.data());
+            else
+            {
+                printf("PoseEstimator: unsupported heatmap data type %d\n", output_info.eDataType);
+                outputs.clear();
+                return AX_ERR_ALGO_ILLEGAL_PARAM;
+            }
 
-            float aspect_w = bbox.width  * 1.0f / m_input_size[1];
-            float aspect_h = bbox.height * 1.0f / m_input_size[0];
+            // undo the crop: ivps crops the even aligned bbox and fits it centered, keeping the aspect ratio
+            utils::CropResizeMap map = utils::GetCropResizeMap(utils::AlignCropRect(bbox, src_size), cv::Size(m_input_size[1], m_input_size[0]));
+            float stride_w = (float)m_input_size[1] / feat_w;
+            float stride_h = (float)m_input_size[0] / feat_h;
 
-            int scale_w = m_input_size[1] / feat_w;
-            int scale_h = m_input_size[0] / feat_h;
+            for (auto& kp : outputs)
+            {
+                kp.x = map.x(kp.x * stride_w);
+                kp.y = map.y(kp.y * stride_h);
+            }
 
-            float* feat_ptr = (float*)buf.pVirAddr;
+            return 0;
+        }
 
+        int Postprocess(const AX_ENGINE_IOMETA_T& output_info, 
+                        AX_ENGINE_IO_BUFFER_T& buf, 
+                        const cv::Rect& bbox,
+                        const cv::Size& src_size,
+                        std::vector<cv::Point>& outputs)
+        {
+            int ret = Postprocess(output_info, buf, bbox, src_size, m_keypoints);
             outputs.clear();
-            for (int i = 0; i < num_kp; i++)
+            for (const auto& kp : m_keypoints)
             {
-                find_max_2d(feat_ptr + i * c_stride, feat_w, feat_h, &x, &y, &max_val);
-                outputs.emplace_back(x * scale_w * aspect_w + bbox.x, y * scale_h * aspect_h + bbox.y);
+                outputs.emplace_back(cvRound(kp.x), cvRound(kp.y));
             }
+            return ret;
+        }
 
-            return 0;
-        }                        
-
+        /// @brief outputs: std::vector<cv::Point> or std::vector<recognition::Keypoint>
+        template <typename T>
         int Recognize(const AX_VIDEO_FRAME_T& img, 
                 const cv::Rect& bbox,
-                std::vector<cv::Point>& outputs)
+                std::vector<T>& outputs)
         {
             if (!m_hasInit)
                 return -1;
 
             int ret = 0;
 
-            AX_VIDEO_FRAME_T dst;
-            ret = Preprocess(img, dst, bbox);
+            ret = Preprocess(img, bbox);
             if (ret != 0)
-            {
-                utils::FreeFrame(dst);
                 return ret;
-            }
 
-            ret = Run(dst);
+            ret = Run();
             if (ret != 0)
-            {
-                utils::FreeFrame(dst);
                 return ret;
-            }
-            utils::FreeFrame(dst);
 
-            axALGO::cache_io_flush(&m_io.pOutputs[0]);
-
-            ret = Postprocess(m_io_info->pOutputs[0], m_io.pOutputs[0], bbox, outputs);
+            ret = Postprocess(m_io_info->pOutputs[0], m_io.pOutputs[0], bbox, cv::Size(img.u32Width, img.u32Height), outputs);
             if (ret != 0)
             {
                 return ret;
@@ -136,6 +151,88 @@ namespace infer
             return 0;
         }
 
+        /// @brief Recognize every bbox of img: crops go through one IVPS batch into a pre-allocated ring,
+        ///        then the npu runs on them back to back. outputs[i] is empty when bboxes[i] is outside img.
+        template <typename T>
+        int RecognizeAll(const AX_VIDEO_FRAME_T& img,
+                const std::vector<cv::Rect>& bboxes,
+                std::vector<std::vector<T>>& outputs)
+        {
+            if (!m_hasInit)
+                return -1;
+
+            if (img.enImgFormat != m_input_format)
+            {
+                printf("RecognizeAll: frame format 0x%02X, model expects 0x%02X\n", img.enImgFormat, m_input_format);
+                return AX_ERR_ALGO_ILLEGAL_PARAM;
+            }
+
+            const cv::Size input_size(m_input_size[1], m_input_size[0]);
+            if (!m_crop_ring_ready)
+            {
+                int ret = m_crop_ring.Reserve(input_size, m_input_format, POSE_CROP_RING);
+                if (ret != 0)
+                    return ret;
+                m_crop_ring_ready = true;
+            }
+
+            outputs.resize(bboxes.size());
+            const cv::Rect frame_rect(0, 0, img.u32Width, img.u32Height);
+
+            int ret = 0;
+            for (size_t base = 0; base < bboxes.size() && ret == 0; base += POSE_CROP_RING)
+            {
+                cv::Rect rects[POSE_CROP_RING];
+                AX_VIDEO_FRAME_T crops[POSE_CROP_RING];
+                AX_VIDEO_FRAME_T* dsts[POSE_CROP_RING];
+                int index[POSE_CROP_RING];
+                int num = 0;
+
+                size_t end = std::min(bboxes.size(), base + POSE_CROP_RING);
+                for (size_t i = base; i < end; i++)
+                {
+                    outputs[i].clear();
+                    cv::Rect rect = bboxes[i] & frame_rect;
+                    if (rect.width < 2 || rect.height < 2)
+                        continue;
+
+                    ret = m_crop_ring.Acquire(crops[num], input_size, m_input_format);
+                    if (ret != 0)
+                        break;
+                    rects[num] = rect;
+                    dsts[num] = &crops[num];
+                    index[num] = (int)i;
+                    num++;
+                }
+
+                if (ret == 0 && num > 0)
+                    ret = utils::CropResizeToFrames(img, rects, dsts, num);
+
+                for (int k = 0; k < num && ret == 0; k++)
+                {
+                    ret = Run(crops[k]);
+                    if (ret == 0)
+                        ret = Postprocess(m_io_info->pOutputs[0], m_io.pOutputs[0], rects[k], cv::Size(img.u32Width, img.u32Height), outputs[index[k]]);
+                }
+
+                for (int k = 0; k < num; k++)
+                {
+                    m_crop_ring.Recycle(crops[k]);
+                }
+            }
+
+            // Preprocess targets the own input buffer again
+            ResetInputs();
+            return ret;
+        }
+
+        int Release()
+        {
+            m_crop_ring.Destroy();
+            m_crop_ring_ready = false;
+            return EngineWrapper::Release();
+        }
+
         // void Draw(cv::Mat& img, const cv::Rect& roi, const std::vector<cv::Point>& pose_outputs)
         // {
         //     for (int i = 0; i < BODY_KP_NUM; i++)
@@ -149,5 +246,13 @@ namespace infer
         //         cv::line(img, kp_a, kp_b, COCO_SKELETON_Colors[i], 2);
         //     }
         // }
+
+    protected:
+        recognition::HeatmapRefine m_refine;
+        float m_heatmap_zp;
+        float m_heatmap_scale;
+        std::vector<recognition::Keypoint> m_keypoints;
+        utils::FramePool m_crop_ring;
+        bool m_crop_ring_ready;
     };
 }
\ No newline at end of file
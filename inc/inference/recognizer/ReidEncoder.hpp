@@ -0,0 +1,122 @@
+/**************************************************************************************************
+ *
+ * Copyright (c) 2019-2023 Axera Semiconductor (Shanghai) Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Axera Semiconductor (Shanghai) Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Axera Semiconductor (Shanghai) Co., Ltd.
+ *
+ **************************************************************************************************/
+
+#pragma once
+
+#include "inference/engine_wrapper.hpp"
+
+#include "utils/io.hpp"
+#include "utils/simd_utils.hpp"
+
+#include "opencv2/core.hpp"
+
+#include <cmath>
+
+namespace infer
+{
+    /// @brief Appearance embedding of a person / object crop, one output holding the feature vector.
+    ///        Extract() matches bytetrack_reid_extract_t, so the tracker only runs the model on the
+    ///        detections it cannot tell apart by IoU:
+    ///            reid.extract = infer::ReidEncoder::Extract; reid.user = &encoder;
+    ///            encoder.SetFrame(&frame); bytetracker_track_span(...);
+    class ReidEncoder : public EngineWrapper
+    {
+    public:
+        ReidEncoder():
+            m_feature_zp(0.f),
+            m_feature_scale(1.f),
+            m_frame(nullptr)
+        { }
+
+        ~ReidEncoder() = default;
+
+        /// @brief Quantization of an u8 feature output, float outputs ignore it
+        void SetFeatureQuant(float zero_point, float scale)
+        {
+            m_feature_zp = zero_point;
+            m_feature_scale = scale;
+        }
+
+        /// @brief Elements of the feature output, bytetrack_reid_t::feature_dim
+        int GetFeatureDim() const
+        {
+            if (!m_hasInit)
+                return 0;
+            const AX_ENGINE_IOMETA_T& output_info = m_io_info->pOutputs[0];
+            int dim = 1;
+            for (int i = 1; i < (int)output_info.nShapeSize; i++)
+                dim *= output_info.pShape[i];
+            return dim;
+        }
+
+        /// @brief Frame the following Extract() calls crop from, it must stay valid until tracking returns
+        void SetFrame(const AX_VIDEO_FRAME_T* img)
+        {
+            m_frame = img;
+        }
+
+        /// @brief l2 normalised feature of bbox of img, GetFeatureDim() floats
+        int Encode(const AX_VIDEO_FRAME_T& img, const cv::Rect& bbox, float* feature)
+        {
+            if (!m_hasInit)
+                return -1;
+
+            int ret = Preprocess(img, bbox);
+            if (ret != 0)
+                return ret;
+
+            ret = Run();
+            if (ret != 0)
+                return ret;
+
+            const AX_ENGINE_IOMETA_T& output_info = m_io_info->pOutputs[0];
+            const int dim = GetFeatureDim();
+            if (output_info.eDataType == AX_ENGINE_DT_UINT8)
+                utils::dequant_u8((const uint8_t*)m_io.pOutputs[0].pVirAddr, feature, dim, m_feature_zp, m_feature_scale);
+            else if (output_info.eDataType == AX_ENGINE_DT_FLOAT32)
+                memcpy(feature, m_io.pOutputs[0].pVirAddr, dim * sizeof(float));
+            else
+            {
+                printf("ReidEncoder: unsupported feature data type %d\n", output_info.eDataType);
+                return AX_ERR_ALGO_ILLEGAL_PARAM;
+            }
+
+            float norm = 0.f;
+            for (int i = 0; i < dim; i++)
+                norm += feature[i] * feature[i];
+            norm = std::sqrt(norm);
+            if (norm > 1e-12f)
+            {
+                for (int i = 0; i < dim; i++)
+                    feature[i] /= norm;
+            }
+            return 0;
+        }
+
+        /// @brief bytetrack_reid_extract_t on the frame of SetFrame(), encoder is the ReidEncoder
+        static int Extract(void* encoder, const float* tlwh, void* user_data, float* feature)
+        {
+            ReidEncoder* self = (ReidEncoder*)encoder;
+            if (!self->m_frame)
+                return -1;
+
+            const cv::Rect frame_rect(0, 0, self->m_frame->u32Width, self->m_frame->u32Height);
+            cv::Rect bbox = cv::Rect(cvRound(tlwh[0]), cvRound(tlwh[1]), cvRound(tlwh[2]), cvRound(tlwh[3])) & frame_rect;
+            if (bbox.width < 2 || bbox.height < 2)
+                return -1;
+            return self->Encode(*self->m_frame, bbox, feature);
+        }
+
+    protected:
+        float m_feature_zp;
+        float m_feature_scale;
+        const AX_VIDEO_FRAME_T* m_frame;
+    };
+}
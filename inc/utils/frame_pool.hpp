@@ -0,0 +1,307 @@
+/**************************************************************************************************
+ *
+ * Copyright (c) 2019-2023 Axera Semiconductor (Ningbo) Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Axera Semiconductor (Ningbo) Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Axera Semiconductor (Ningbo) Co., Ltd.
+ *
+ **************************************************************************************************/
+
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "utils/frame_utils.hpp"
+
+namespace utils
+{
+    #define FRAME_POOL_MAX_BUCKETS      16
+    #define FRAME_POOL_TAG_MAGIC        0x46504F4F00000000ULL   // "FPOO" in the high word of u64PrivateData
+
+    struct FramePoolStats
+    {
+        int capacity;       // frames reserved up front
+        int in_use;         // frames currently handed out, overflow included
+        int high_water;     // max of in_use
+        uint64_t acquired;  // total Acquire calls served
+        uint64_t overflow;  // Acquire calls that had to fall back to AllocFrame
+    };
+
+    /// @brief Pre-allocated CMM frames, one bucket per (size, format, cache strategy).
+    ///        Reserve at startup, then Acquire/Recycle are lock-free.
+    ///        When a bucket is exhausted (or was never reserved) Acquire falls back to AllocFrame,
+    ///        Recycle frees those frames again, and the overflow counter tells the pool is too small.
+    class FramePool
+    {
+    public:
+        FramePool():
+            m_bucket_num(0),
+            m_overflow_in_use(0),
+            m_overflow_high_water(0),
+            m_overflow(0)
+        { }
+
+        ~FramePool()
+        {
+            Destroy();
+        }
+
+        FramePool(const FramePool&) = delete;
+        FramePool& operator=(const FramePool&) = delete;
+
+        /// @brief Pre-allocate count frames for this key, each key can be reserved once
+        int Reserve(const cv::Size& size, AX_IMG_FORMAT_E eDtype, int count, axALGO::ALGO_IO_BUFFER_STRATEGY_T eStrategy = axALGO::ALGO_IO_BUFFER_STRATEGY_DEFAULT)
+        {
+            if (count <= 0 || size.area() <= 0)
+                return -1;
+
+            std::lock_guard<std::mutex> lock(m_reserve_mutex);
+            if (FindBucket(size, eDtype, eStrategy) >= 0)
+            {
+                fprintf(stderr, "[ERR] FramePool: %dx%d format %d already reserved\n", size.width, size.height, (int)eDtype);
+                return -1;
+            }
+
+            int index = m_bucket_num.load(std::memory_order_relaxed);
+            if (index >= FRAME_POOL_MAX_BUCKETS)
+            {
+                fprintf(stderr, "[ERR] FramePool: too many buckets\n");
+                return -1;
+            }
+
+            std::unique_ptr<Bucket> bucket(new Bucket(size, eDtype, eStrategy, count));
+            const std::string token = "pool_" + std::to_string(size.width) + "x" + std::to_string(size.height);
+            for (int i = 0; i < count; i++)
+            {
+                int ret = AllocFrame(bucket->frames[i], token, size, eDtype, eStrategy);
+                if (ret != 0)
+                {
+                    for (int j = 0; j < i; j++)
+                        FreeFrame(bucket->frames[j]);
+                    return ret;
+                }
+                bucket->frames[i].u64PrivateData = MakeTag(index, i);
+            }
+
+            m_buckets[index] = std::move(bucket);
+            m_bucket_num.store(index + 1, std::memory_order_release);
+            return 0;
+        }
+
+        int Acquire(AX_VIDEO_FRAME_T& frame, const cv::Size& size, AX_IMG_FORMAT_E eDtype, axALGO::ALGO_IO_BUFFER_STRATEGY_T eStrategy = axALGO::ALGO_IO_BUFFER_STRATEGY_DEFAULT)
+        {
+            int b = FindBucket(size, eDtype, eStrategy);
+            if (b >= 0)
+            {
+                Bucket& bucket = *m_buckets[b];
+                const int n = (int)bucket.frames.size();
+                // start from a rotating hint so concurrent callers do not fight over slot 0
+                int start = (int)(bucket.hint.fetch_add(1, std::memory_order_relaxed) % n);
+                for (int k = 0; k < n; k++)
+                {
+                    int i = (start + k) % n;
+                    bool expected = false;
+                    if (!bucket.busy[i].load(std::memory_order_relaxed)
+                        && bucket.busy[i].compare_exchange_strong(expected, true, std::memory_order_acquire))
+                    {
+                        frame = bucket.frames[i];
+                        UpdateHighWater(bucket.high_water, bucket.in_use.fetch_add(1, std::memory_order_relaxed) + 1);
+                        bucket.acquired.fetch_add(1, std::memory_order_relaxed);
+                        return 0;
+                    }
+                }
+            }
+
+            // exhausted or not reserved
+            int ret = AllocFrame(frame, "pool_overflow", size, eDtype, eStrategy);
+            if (ret != 0)
+                return ret;
+            frame.u64PrivateData = 0;
+            UpdateHighWater(m_overflow_high_water, m_overflow_in_use.fetch_add(1, std::memory_order_relaxed) + 1);
+            m_overflow.fetch_add(1, std::memory_order_relaxed);
+            return 0;
+        }
+
+        /// @brief Give a frame from Acquire back, frame is cleared
+        int Recycle(AX_VIDEO_FRAME_T& frame)
+        {
+            int b = -1, i = -1;
+            if (ParseTag(frame.u64PrivateData, b, i))
+            {
+                Bucket& bucket = *m_buckets[b];
+                if (bucket.frames[i].u64PhyAddr[0] != frame.u64PhyAddr[0])
+                {
+                    fprintf(stderr, "[ERR] FramePool: frame does not belong to this pool\n");
+                    return -1;
+                }
+                bucket.in_use.fetch_sub(1, std::memory_order_relaxed);
+                bucket.busy[i].store(false, std::memory_order_release);
+                memset(&frame, 0x00, sizeof(AX_VIDEO_FRAME_T));
+                return 0;
+            }
+
+            if (frame.u64PhyAddr[0] == 0)
+                return 0;
+
+            m_overflow_in_use.fetch_sub(1, std::memory_order_relaxed);
+            return FreeFrame(frame);
+        }
+
+        FramePoolStats GetStats(const cv::Size& size, AX_IMG_FORMAT_E eDtype, axALGO::ALGO_IO_BUFFER_STRATEGY_T eStrategy = axALGO::ALGO_IO_BUFFER_STRATEGY_DEFAULT) const
+        {
+            FramePoolStats stats;
+            memset(&stats, 0, sizeof(stats));
+            int b = FindBucket(size, eDtype, eStrategy);
+            if (b >= 0)
+                m_buckets[b]->Fill(stats);
+            return stats;
+        }
+
+        /// @brief Stats over all buckets, overflow frames included
+        FramePoolStats GetStats() const
+        {
+            FramePoolStats stats;
+            memset(&stats, 0, sizeof(stats));
+            int n = m_bucket_num.load(std::memory_order_acquire);
+            for (int b = 0; b < n; b++)
+            {
+                FramePoolStats s;
+                m_buckets[b]->Fill(s);
+                stats.capacity += s.capacity;
+                stats.in_use += s.in_use;
+                stats.high_water += s.high_water;
+                stats.acquired += s.acquired;
+            }
+            stats.in_use += m_overflow_in_use.load(std::memory_order_relaxed);
+            stats.high_water += m_overflow_high_water.load(std::memory_order_relaxed);
+            stats.overflow = m_overflow.load(std::memory_order_relaxed);
+            stats.acquired += stats.overflow;
+            return stats;
+        }
+
+        /// @brief Free all reserved frames, none may be in use
+        void Destroy()
+        {
+            std::lock_guard<std::mutex> lock(m_reserve_mutex);
+            int n = m_bucket_num.load(std::memory_order_acquire);
+            for (int b = 0; b < n; b++)
+            {
+                Bucket& bucket = *m_buckets[b];
+                if (bucket.in_use.load() > 0)
+                    fprintf(stderr, "[WARN] FramePool: %d frames still in use\n", bucket.in_use.load());
+                for (auto& frame : bucket.frames)
+                    FreeFrame(frame);
+                m_buckets[b].reset();
+            }
+            m_bucket_num.store(0, std::memory_order_release);
+        }
+
+    private:
+        struct Bucket
+        {
+            cv::Size size;
+            AX_IMG_FORMAT_E format;
+            axALGO::ALGO_IO_BUFFER_STRATEGY_T strategy;
+            std::vector<AX_VIDEO_FRAME_T> frames;
+            std::unique_ptr<std::atomic<bool>[]> busy;
+            std::atomic<uint32_t> hint;
+            std::atomic<int> in_use;
+            std::atomic<int> high_water;
+            std::atomic<uint64_t> acquired;
+
+            Bucket(const cv::Size& size_, AX_IMG_FORMAT_E format_, axALGO::ALGO_IO_BUFFER_STRATEGY_T strategy_, int count):
+                size(size_),
+                format(format_),
+                strategy(strategy_),
+                frames(count),
+                busy(new std::atomic<bool>[count]),
+                hint(0),
+                in_use(0),
+                high_water(0),
+                acquired(0)
+            {
+                for (int i = 0; i < count; i++)
+                    busy[i].store(false, std::memory_order_relaxed);
+            }
+
+            void Fill(FramePoolStats& stats) const
+            {
+                memset(&stats, 0, sizeof(stats));
+                stats.capacity = (int)frames.size();
+                stats.in_use = in_use.load(std::memory_order_relaxed);
+                stats.high_water = high_water.load(std::memory_order_relaxed);
+                stats.acquired = acquired.load(std::memory_order_relaxed);
+            }
+        };
+
+        int FindBucket(const cv::Size& size, AX_IMG_FORMAT_E eDtype, axALGO::ALGO_IO_BUFFER_STRATEGY_T eStrategy) const
+        {
+            int n = m_bucket_num.load(std::memory_order_acquire);
+            for (int b = 0; b < n; b++)
+            {
+                const Bucket& bucket = *m_buckets[b];
+                if (bucket.size.width == size.width && bucket.size.height == size.height
+                    && bucket.format == eDtype && bucket.strategy == eStrategy)
+                    return b;
+            }
+            return -1;
+        }
+
+        static inline AX_U64 MakeTag(int bucket, int slot)
+        {
+            return FRAME_POOL_TAG_MAGIC | ((AX_U64)(bucket + 1) << 24) | (AX_U64)(slot + 1);
+        }
+
+        inline bool ParseTag(AX_U64 tag, int& bucket, int& slot) const
+        {
+            if ((tag & 0xFFFFFFFF00000000ULL) != FRAME_POOL_TAG_MAGIC)
+                return false;
+            bucket = (int)((tag >> 24) & 0xFF) - 1;
+            slot = (int)(tag & 0xFFFFFF) - 1;
+            return bucket >= 0 && bucket < m_bucket_num.load(std::memory_order_acquire)
+                && slot >= 0 && slot < (int)m_buckets[bucket]->frames.size();
+        }
+
+        static inline void UpdateHighWater(std::atomic<int>& high_water, int value)
+        {
+            int cur = high_water.load(std::memory_order_relaxed);
+            while (value > cur && !high_water.compare_exchange_weak(cur, value, std::memory_order_relaxed))
+                ;
+        }
+
+        std::array<std::unique_ptr<Bucket>, FRAME_POOL_MAX_BUCKETS> m_buckets;
+        std::atomic<int> m_bucket_num;
+        std::mutex m_reserve_mutex;
+
+        std::atomic<int> m_overflow_in_use;
+        std::atomic<int> m_overflow_high_water;
+        std::atomic<uint64_t> m_overflow;
+    };
+
+    /// @brief CropResizeFrame with dst taken from pool, give it back with pool.Recycle
+    static inline int CropResizeFrame(FramePool& pool, const AX_VIDEO_FRAME_T& src, AX_VIDEO_FRAME_T& dst, const cv::Size& dst_size, const cv::Rect& crop_rect = cv::Rect())
+    {
+        int ret = pool.Acquire(dst, dst_size, src.enImgFormat);
+        if (ret != 0)
+        {
+            fprintf(stderr, "[ERR] Acquire crop_resize frame failed!\n");
+            return ret;
+        }
+
+        ret = CropResizeToFrame(src, dst, crop_rect);
+        if (ret != 0)
+        {
+            pool.Recycle(dst);
+            return ret;
+        }
+
+        return ret;
+    }
+}
@@ -10,6 +10,7 @@
 
 #pragma once
 
+#include <algorithm>
 #include <string>
 #include <array>
 
@@ -92,6 +93,32 @@ namespace utils
         return ret;
     }
 
+    /// @brief Describe an existing buffer (e.g. an engine input) as a frame, nothing is allocated
+    static inline int WrapFrame(AX_VIDEO_FRAME_T& frame, AX_U64 phyAddr, AX_VOID* virAddr, AX_U32 size, const cv::Size &frame_size, AX_IMG_FORMAT_E eDtype)
+    {
+        memset(&frame, 0x00, sizeof(AX_VIDEO_FRAME_T));
+        frame.u32Width = frame_size.width;
+        frame.u32Height = frame_size.height;
+        frame.u32PicStride[0] = frame.u32Width;
+        frame.u32PicStride[1] = frame.u32PicStride[0];
+        frame.u32PicStride[2] = frame.u32PicStride[0];
+        frame.enImgFormat = eDtype;
+        frame.u32FrameSize = get_image_data_size(&frame);
+
+        if (frame.u32FrameSize == 0 || frame.u32FrameSize > size) {
+            fprintf(stderr, "[ERR] buffer of %u bytes can not hold %dx%d image\n", size, frame_size.width, frame_size.height);
+            memset(&frame, 0x00, sizeof(AX_VIDEO_FRAME_T));
+            return -1;
+        }
+
+        frame.u64PhyAddr[0] = phyAddr;
+        frame.u64VirAddr[0] = (AX_U64)virAddr;
+        frame.u64PhyAddr[1] = frame.u64PhyAddr[0] + frame.u32PicStride[0] * frame.u32Height;
+        frame.u64VirAddr[1] = frame.u64VirAddr[0] + frame.u32PicStride[0] * frame.u32Height;
+
+        return 0;
+    }
+
     static inline void FlushFrame(const AX_VIDEO_FRAME_T& stFrame) 
     {
         if (stFrame.u64PhyAddr[0] != 0) {
@@ -143,45 +170,128 @@ namespace utils
         return t;
     }
 
-    static inline int CropResizeFrame(const AX_VIDEO_FRAME_T& src, AX_VIDEO_FRAME_T& dst, const cv::Size& dst_size, const cv::Rect& crop_rect = cv::Rect())
+    /// @brief Keep aspect ratio, centered, blue padding
+    static inline void InitCropResizeAttr(AX_IVPS_CROP_RESIZE_ATTR_T& tCropResizeAttr)
     {
-        int ret = 0;
-        ret = AllocFrame(dst, "crop_resize", dst_size, src.enImgFormat);
-        if (ret != 0)
-        {
-            fprintf(stderr, "[ERR] Alloc crop_resize frame failed!\n");
-            return ret;
-        }
-
-        AX_IVPS_CROP_RESIZE_ATTR_T tCropResizeAttr;
         memset(&tCropResizeAttr, 0x00, sizeof(tCropResizeAttr));
         tCropResizeAttr.tAspectRatio.eMode = AX_IVPS_ASPECT_RATIO_AUTO;
         tCropResizeAttr.tAspectRatio.eAligns[0] = AX_IVPS_ASPECT_RATIO_HORIZONTAL_CENTER;
         tCropResizeAttr.tAspectRatio.eAligns[1] = AX_IVPS_ASPECT_RATIO_VERTICAL_CENTER;
         tCropResizeAttr.tAspectRatio.nBgColor = 0x0000FF;
+    }
+
+    /// @brief The rect ivps really crops: even aligned, empty rects take the whole src_size
+    static inline cv::Rect AlignCropRect(const cv::Rect& crop_rect, const cv::Size& src_size)
+    {
+        if (crop_rect.area() <= 0)
+            return cv::Rect(0, 0, src_size.width, src_size.height);
+        return cv::Rect(crop_rect.x / 2 * 2, crop_rect.y / 2 * 2, crop_rect.width / 2 * 2, crop_rect.height / 2 * 2);
+    }
+
+    /// @brief Maps dst coords of a crop & resize back to src: the aligned crop is fitted centered, keeping the aspect ratio
+    struct CropResizeMap
+    {
+        float scale;
+        float pad_x;
+        float pad_y;
+        float crop_x;
+        float crop_y;
+
+        float x(float dst_x) const { return (dst_x - pad_x) / scale + crop_x; }
+        float y(float dst_y) const { return (dst_y - pad_y) / scale + crop_y; }
+    };
+
+    static inline CropResizeMap GetCropResizeMap(const cv::Rect& aligned_rect, const cv::Size& dst_size)
+    {
+        CropResizeMap map;
+        float crop_w = (float)std::max(aligned_rect.width, 1);
+        float crop_h = (float)std::max(aligned_rect.height, 1);
+        map.scale = std::min(dst_size.width / crop_w, dst_size.height / crop_h);
+        map.pad_x = (dst_size.width - crop_w * map.scale) * 0.5f;
+        map.pad_y = (dst_size.height - crop_h * map.scale) * 0.5f;
+        map.crop_x = (float)aligned_rect.x;
+        map.crop_y = (float)aligned_rect.y;
+        return map;
+    }
+
+    static inline CropResizeMap GetCropResizeMap(const AX_VIDEO_FRAME_T& src, const cv::Size& dst_size, const cv::Rect& crop_rect = cv::Rect())
+    {
+        return GetCropResizeMap(AlignCropRect(crop_rect, cv::Size(src.u32Width, src.u32Height)), dst_size);
+    }
+
+    /// @brief Crop & resize src into dst, which is already allocated (size and format taken from dst)
+    static inline int CropResizeToFrame(const AX_VIDEO_FRAME_T& src, AX_VIDEO_FRAME_T& dst, const cv::Rect& crop_rect = cv::Rect())
+    {
+        int ret = 0;
+
+        AX_IVPS_CROP_RESIZE_ATTR_T tCropResizeAttr;
+        InitCropResizeAttr(tCropResizeAttr);
 
         AX_VIDEO_FRAME_T cropSrc;
         memcpy(&cropSrc, &src, sizeof(AX_VIDEO_FRAME_T));
-        if (crop_rect.area() > 0)
+        cv::Rect rect = AlignCropRect(crop_rect, cv::Size(src.u32Width, src.u32Height));
+        cropSrc.s16CropX = rect.x;
+        cropSrc.s16CropY = rect.y;
+        cropSrc.s16CropWidth = rect.width;
+        cropSrc.s16CropHeight = rect.height;
+
+        ret = AX_IVPS_CropResizeTdp(&cropSrc, &dst, &tCropResizeAttr);
+        if (ret != 0)
+        {
+            fprintf(stderr, "AX_IVPS_CropResizeTdp error, ret=0x%8x\n", ret);
+            return ret;
+        }
+
+        return ret;
+    }
+
+    #define IVPS_CROP_RESIZE_V2_MAX     32      // boxes per AX_IVPS_CropResizeV2Tdp call
+
+    /// @brief Crop & resize every rect of src into the matching allocated frame of dsts,
+    ///        one IVPS call per IVPS_CROP_RESIZE_V2_MAX boxes. Empty rects take the whole frame.
+    static inline int CropResizeToFrames(const AX_VIDEO_FRAME_T& src, const cv::Rect* crop_rects, AX_VIDEO_FRAME_T* dsts[], int num)
+    {
+        AX_IVPS_CROP_RESIZE_ATTR_T tCropResizeAttr;
+        InitCropResizeAttr(tCropResizeAttr);
+
+        AX_IVPS_RECT_T tBox[IVPS_CROP_RESIZE_V2_MAX];
+        for (int base = 0; base < num; base += IVPS_CROP_RESIZE_V2_MAX)
         {
-            cropSrc.s16CropX = crop_rect.x / 2 * 2;
-            cropSrc.s16CropY = crop_rect.y / 2 * 2;
-            cropSrc.s16CropWidth = (AX_S16)crop_rect.width / 2 * 2;
-            cropSrc.s16CropHeight = (AX_S16)crop_rect.height / 2 * 2;
+            int n = std::min(num - base, IVPS_CROP_RESIZE_V2_MAX);
+            for (int i = 0; i < n; i++)
+            {
+                cv::Rect rect = AlignCropRect(crop_rects[base + i], cv::Size(src.u32Width, src.u32Height));
+                tBox[i].nX = rect.x;
+                tBox[i].nY = rect.y;
+                tBox[i].nW = rect.width;
+                tBox[i].nH = rect.height;
+            }
+
+            int ret = AX_IVPS_CropResizeV2Tdp(&src, tBox, n, dsts + base, &tCropResizeAttr);
+            if (ret != 0)
+            {
+                fprintf(stderr, "AX_IVPS_CropResizeV2Tdp error, ret=0x%8x\n", ret);
+                return ret;
+            }
         }
-        else
+
+        return 0;
+    }
+
+    static inline int CropResizeFrame(const AX_VIDEO_FRAME_T& src, AX_VIDEO_FRAME_T& dst, const cv::Size& dst_size, const cv::Rect& crop_rect = cv::Rect())
+    {
+        int ret = 0;
+        ret = AllocFrame(dst, "crop_resize", dst_size, src.enImgFormat);
+        if (ret != 0)
         {
-            cropSrc.s16CropX = 0;
-            cropSrc.s16CropY = 0;
-            cropSrc.s16CropWidth = cropSrc.u32Width;
-            cropSrc.s16CropHeight = cropSrc.u32Height;
+            fprintf(stderr, "[ERR] Alloc crop_resize frame failed!\n");
+            return ret;
         }
 
-        ret = AX_IVPS_CropResizeTdp(&cropSrc, &dst, &tCropResizeAttr);
+        ret = CropResizeToFrame(src, dst, crop_rect);
         if (ret != 0)
         {
             FreeFrame(dst);
-            fprintf(stderr, "AX_IVPS_CropResizeTdp error, ret=0x%8x\n", ret);
             return ret;
         }
 
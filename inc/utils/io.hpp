@@ -27,6 +27,7 @@
 #include <fstream>
 
 #include "utils/ax_algo_def.h"
+#include "utils/simd_utils.hpp"
 #include "ax_sys_api.h"
 #include "ax_engine_type.h"
 
@@ -338,8 +339,8 @@ static inline int prepare_io(const std::string& token, const AX_ENGINE_IO_INFO_T
 
     memset(&io, 0, sizeof(io));
 
-    if (1 != info->nInputSize) {
-        fprintf(stderr, "[ERR]: Only single input was accepted(got %u).\n", info->nInputSize);
+    if (0 == info->nInputSize) {
+        fprintf(stderr, "[ERR]: Model has no input.\n");
         return -1;
     }
 
@@ -399,8 +400,8 @@ static inline int prepare_io(const std::string& token,
 
     std::vector<AX_ENGINE_IO_BUFFER_T> outputBuffer;
 
-    if (1 != info->nInputSize) {
-        fprintf(stderr, "[ERR]: Only single input was accepted(got %u).\n", info->nInputSize);
+    if (0 == info->nInputSize) {
+        fprintf(stderr, "[ERR]: Model has no input.\n");
         return -1;
     }
 
@@ -471,8 +472,12 @@ static inline AX_S32 push_io_output(const AX_ENGINE_IO_INFO_T* info,
     return 0;
 }
 
-static inline AX_S32 push_io_input(const AX_VIDEO_FRAME_T* pImage, AX_ENGINE_IO_T& io) {
-    AX_ENGINE_IO_BUFFER_T* pBuf = &io.pInputs[0];
+static inline AX_S32 push_io_input(const AX_VIDEO_FRAME_T* pImage, AX_ENGINE_IO_T& io, AX_U32 index = 0) {
+    if (index >= io.nInputSize) {
+        return -1;
+    }
+
+    AX_ENGINE_IO_BUFFER_T* pBuf = &io.pInputs[index];
 
     pBuf->phyAddr = (AX_ADDR)pImage->u64PhyAddr[0];
     pBuf->pVirAddr = (AX_VOID *)pImage->u64VirAddr[0];
@@ -481,6 +486,15 @@ static inline AX_S32 push_io_input(const AX_VIDEO_FRAME_T* pImage, AX_ENGINE_IO_
     return 0;
 }
 
+static inline int find_io_index(const AX_ENGINE_IOMETA_T* metas, AX_U32 num, const std::string& name) {
+    for (AX_U32 i = 0; i < num; ++i) {
+        if (metas[i].pName && name == metas[i].pName) {
+            return (int)i;
+        }
+    }
+    return -1;
+}
+
 static inline AX_S32 cache_io_flush(const AX_ENGINE_IO_BUFFER_T *io_buf) {
     if (io_buf->phyAddr != 0) {
         AX_SYS_MflushCache(io_buf->phyAddr, io_buf->pVirAddr, io_buf->nSize);
@@ -555,6 +569,28 @@ static inline bool read_file(const std::string& path, AX_VOID **pModelBufferVirA
     return true;
 }
 
+/// dequantize an output into a caller buffer of at least nSize / sizeof(element) floats
+static inline int dequant(float* pOutput, const AX_ENGINE_IOMETA_T& ptrIoInfo, const AX_ENGINE_IO_BUFFER_T& ioBuf, float zp, float scale) {
+    switch (ptrIoInfo.eDataType) {
+        case AX_ENGINE_DT_FLOAT32:
+            memcpy(pOutput, ioBuf.pVirAddr, ptrIoInfo.nSize);
+            return 0;
+        case AX_ENGINE_DT_UINT8:
+            utils::dequant_u8((const uint8_t*)ioBuf.pVirAddr, pOutput, (int)ptrIoInfo.nSize, zp, scale);
+            return 0;
+        case AX_ENGINE_DT_SINT8:
+            utils::dequant_s8((const int8_t*)ioBuf.pVirAddr, pOutput, (int)ptrIoInfo.nSize, zp, scale);
+            return 0;
+        case AX_ENGINE_DT_SINT16:
+            utils::dequant_s16((const int16_t*)ioBuf.pVirAddr, pOutput, (int)(ptrIoInfo.nSize / sizeof(int16_t)), zp, scale);
+            return 0;
+        default:
+            fprintf(stderr, "[ERR]: dequant of data type %d not supported\n", (int)ptrIoInfo.eDataType);
+            return -1;
+    }
+}
+
+/// *pptrOutput is malloc'ed unless the output already is float, prefer the overload above with a reused buffer
 static inline void dequant(float** pptrOutput, const AX_ENGINE_IOMETA_T& ptrIoInfo, const AX_ENGINE_IO_BUFFER_T& ioBuf, float zp, float scale)
 {
     if (ptrIoInfo.eDataType == AX_ENGINE_DT_FLOAT32)
@@ -564,13 +600,7 @@ static inline void dequant(float** pptrOutput, const AX_ENGINE_IOMETA_T& ptrIoIn
     }
 
     *pptrOutput = (float*)malloc(ptrIoInfo.nSize * sizeof(float));
-    uint8_t *pBuf = (uint8_t*)ioBuf.pVirAddr;
-    float* pOutput = *pptrOutput;
-    // float inv_scale = 1.0f / scale;
-    for (int i = 0; i < ptrIoInfo.nSize; i++)
-    {
-        pOutput[i] = ((float)pBuf[i] - zp) * scale;
-    }
+    dequant(*pptrOutput, ptrIoInfo, ioBuf, zp, scale);
 }
 
 }  // namespace axALGO
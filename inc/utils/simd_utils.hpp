@@ -0,0 +1,710 @@
+/**************************************************************************************************
+ *
+ * Copyright (c) 2019-2023 Axera Semiconductor (Ningbo) Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Axera Semiconductor (Ningbo) Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Axera Semiconductor (Ningbo) Co., Ltd.
+ *
+ **************************************************************************************************/
+
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+    #include <arm_neon.h>
+    #define UTILS_SIMD_NEON     1
+#elif defined(__SSE2__) || defined(_M_X64)
+    #include <emmintrin.h>
+    #define UTILS_SIMD_SSE2     1
+    #if defined(__AVX2__)
+        #include <immintrin.h>
+        #define UTILS_SIMD_AVX2 1
+    #endif
+#endif
+
+/*
+ * Dequantization and layout kernels for npu outputs, all writing into caller buffers.
+ * NEON on the board, SSE2 on x86 hosts, scalar otherwise; results are identical on every path.
+ * Layout conversions are a transpose of a [rows, cols] matrix:
+ *   NHWC -> NCHW: rows = h * w, cols = c
+ *   NCHW -> NHWC: rows = c, cols = h * w
+ * Class max kernels reduce the class scores of every grid cell and return the cells worth decoding.
+ * exp_f32 is the Cephes polynomial (relative error ~1e-7 against std::exp) for box decoding.
+ */
+
+namespace utils
+{
+    static inline void dequant_u8(const uint8_t* src, float* dst, int n, float zp, float scale)
+    {
+        int i = 0;
+#if defined(UTILS_SIMD_NEON)
+        const float32x4_t vzp = vdupq_n_f32(zp);
+        const float32x4_t vscale = vdupq_n_f32(scale);
+        for (; i + 16 <= n; i += 16)
+        {
+            uint8x16_t v = vld1q_u8(src + i);
+            uint16x8_t lo = vmovl_u8(vget_low_u8(v));
+            uint16x8_t hi = vmovl_u8(vget_high_u8(v));
+            vst1q_f32(dst + i,      vmulq_f32(vsubq_f32(vcvtq_f32_u32(vmovl_u16(vget_low_u16(lo))), vzp), vscale));
+            vst1q_f32(dst + i + 4,  vmulq_f32(vsubq_f32(vcvtq_f32_u32(vmovl_u16(vget_high_u16(lo))), vzp), vscale));
+            vst1q_f32(dst + i + 8,  vmulq_f32(vsubq_f32(vcvtq_f32_u32(vmovl_u16(vget_low_u16(hi))), vzp), vscale));
+            vst1q_f32(dst + i + 12, vmulq_f32(vsubq_f32(vcvtq_f32_u32(vmovl_u16(vget_high_u16(hi))), vzp), vscale));
+        }
+#elif defined(UTILS_SIMD_SSE2)
+        const __m128 vzp = _mm_set1_ps(zp);
+        const __m128 vscale = _mm_set1_ps(scale);
+        const __m128i zero = _mm_setzero_si128();
+        for (; i + 16 <= n; i += 16)
+        {
+            __m128i v = _mm_loadu_si128((const __m128i*)(src + i));
+            __m128i lo = _mm_unpacklo_epi8(v, zero);
+            __m128i hi = _mm_unpackhi_epi8(v, zero);
+            _mm_storeu_ps(dst + i,      _mm_mul_ps(_mm_sub_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(lo, zero)), vzp), vscale));
+            _mm_storeu_ps(dst + i + 4,  _mm_mul_ps(_mm_sub_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(lo, zero)), vzp), vscale));
+            _mm_storeu_ps(dst + i + 8,  _mm_mul_ps(_mm_sub_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(hi, zero)), vzp), vscale));
+            _mm_storeu_ps(dst + i + 12, _mm_mul_ps(_mm_sub_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(hi, zero)), vzp), vscale));
+        }
+#endif
+        for (; i < n; i++)
+            dst[i] = ((float)src[i] - zp) * scale;
+    }
+
+    static inline void dequant_s8(const int8_t* src, float* dst, int n, float zp, float scale)
+    {
+        int i = 0;
+#if defined(UTILS_SIMD_NEON)
+        const float32x4_t vzp = vdupq_n_f32(zp);
+        const float32x4_t vscale = vdupq_n_f32(scale);
+        for (; i + 16 <= n; i += 16)
+        {
+            int8x16_t v = vld1q_s8(src + i);
+            int16x8_t lo = vmovl_s8(vget_low_s8(v));
+            int16x8_t hi = vmovl_s8(vget_high_s8(v));
+            vst1q_f32(dst + i,      vmulq_f32(vsubq_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(lo))), vzp), vscale));
+            vst1q_f32(dst + i + 4,  vmulq_f32(vsubq_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(lo))), vzp), vscale));
+            vst1q_f32(dst + i + 8,  vmulq_f32(vsubq_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(hi))), vzp), vscale));
+            vst1q_f32(dst + i + 12, vmulq_f32(vsubq_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(hi))), vzp), vscale));
+        }
+#elif defined(UTILS_SIMD_SSE2)
+        const __m128 vzp = _mm_set1_ps(zp);
+        const __m128 vscale = _mm_set1_ps(scale);
+        for (; i + 16 <= n; i += 16)
+        {
+            __m128i v = _mm_loadu_si128((const __m128i*)(src + i));
+            // sign extend: put the byte in the high half and shift back
+            __m128i lo = _mm_srai_epi16(_mm_unpacklo_epi8(v, v), 8);
+            __m128i hi = _mm_srai_epi16(_mm_unpackhi_epi8(v, v), 8);
+            _mm_storeu_ps(dst + i,      _mm_mul_ps(_mm_sub_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(lo, lo), 16)), vzp), vscale));
+            _mm_storeu_ps(dst + i + 4,  _mm_mul_ps(_mm_sub_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(lo, lo), 16)), vzp), vscale));
+            _mm_storeu_ps(dst + i + 8,  _mm_mul_ps(_mm_sub_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(hi, hi), 16)), vzp), vscale));
+            _mm_storeu_ps(dst + i + 12, _mm_mul_ps(_mm_sub_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(hi, hi), 16)), vzp), vscale));
+        }
+#endif
+        for (; i < n; i++)
+            dst[i] = ((float)src[i] - zp) * scale;
+    }
+
+    static inline void dequant_s16(const int16_t* src, float* dst, int n, float zp, float scale)
+    {
+        int i = 0;
+#if defined(UTILS_SIMD_NEON)
+        const float32x4_t vzp = vdupq_n_f32(zp);
+        const float32x4_t vscale = vdupq_n_f32(scale);
+        for (; i + 8 <= n; i += 8)
+        {
+            int16x8_t v = vld1q_s16(src + i);
+            vst1q_f32(dst + i,     vmulq_f32(vsubq_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(v))), vzp), vscale));
+            vst1q_f32(dst + i + 4, vmulq_f32(vsubq_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(v))), vzp), vscale));
+        }
+#elif defined(UTILS_SIMD_SSE2)
+        const __m128 vzp = _mm_set1_ps(zp);
+        const __m128 vscale = _mm_set1_ps(scale);
+        for (; i + 8 <= n; i += 8)
+        {
+            __m128i v = _mm_loadu_si128((const __m128i*)(src + i));
+            _mm_storeu_ps(dst + i,     _mm_mul_ps(_mm_sub_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16)), vzp), vscale));
+            _mm_storeu_ps(dst + i + 4, _mm_mul_ps(_mm_sub_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16)), vzp), vscale));
+        }
+#endif
+        for (; i < n; i++)
+            dst[i] = ((float)src[i] - zp) * scale;
+    }
+
+    /// @brief dst[cols, rows] = transpose(src[rows, cols])
+    static inline void transpose_f32(const float* src, int rows, int cols, float* dst)
+    {
+        int r = 0;
+#if defined(UTILS_SIMD_NEON) || defined(UTILS_SIMD_SSE2)
+        for (; r + 4 <= rows; r += 4)
+        {
+            const float* s = src + (size_t)r * cols;
+            int c = 0;
+            for (; c + 4 <= cols; c += 4)
+            {
+    #if defined(UTILS_SIMD_NEON)
+                float32x4_t r0 = vld1q_f32(s + c);
+                float32x4_t r1 = vld1q_f32(s + cols + c);
+                float32x4_t r2 = vld1q_f32(s + 2 * cols + c);
+                float32x4_t r3 = vld1q_f32(s + 3 * cols + c);
+                float32x4x2_t t01 = vtrnq_f32(r0, r1);
+                float32x4x2_t t23 = vtrnq_f32(r2, r3);
+                vst1q_f32(dst + (size_t)c * rows + r,       vcombine_f32(vget_low_f32(t01.val[0]), vget_low_f32(t23.val[0])));
+                vst1q_f32(dst + (size_t)(c + 1) * rows + r, vcombine_f32(vget_low_f32(t01.val[1]), vget_low_f32(t23.val[1])));
+                vst1q_f32(dst + (size_t)(c + 2) * rows + r, vcombine_f32(vget_high_f32(t01.val[0]), vget_high_f32(t23.val[0])));
+                vst1q_f32(dst + (size_t)(c + 3) * rows + r, vcombine_f32(vget_high_f32(t01.val[1]), vget_high_f32(t23.val[1])));
+    #else
+                __m128 r0 = _mm_loadu_ps(s + c);
+                __m128 r1 = _mm_loadu_ps(s + cols + c);
+                __m128 r2 = _mm_loadu_ps(s + 2 * cols + c);
+                __m128 r3 = _mm_loadu_ps(s + 3 * cols + c);
+                _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+                _mm_storeu_ps(dst + (size_t)c * rows + r, r0);
+                _mm_storeu_ps(dst + (size_t)(c + 1) * rows + r, r1);
+                _mm_storeu_ps(dst + (size_t)(c + 2) * rows + r, r2);
+                _mm_storeu_ps(dst + (size_t)(c + 3) * rows + r, r3);
+    #endif
+            }
+            for (; c < cols; c++)
+            {
+                for (int k = 0; k < 4; k++)
+                    dst[(size_t)c * rows + r + k] = s[(size_t)k * cols + c];
+            }
+        }
+#endif
+        for (; r < rows; r++)
+        {
+            const float* s = src + (size_t)r * cols;
+            for (int c = 0; c < cols; c++)
+                dst[(size_t)c * rows + r] = s[c];
+        }
+    }
+
+    /// @brief Dequant u8 and transpose in one pass: dst[cols, rows] = (transpose(src[rows, cols]) - zp) * scale
+    static inline void dequant_transpose_u8(const uint8_t* src, int rows, int cols, float zp, float scale, float* dst)
+    {
+        int r = 0;
+#if defined(UTILS_SIMD_NEON) || defined(UTILS_SIMD_SSE2)
+    #if defined(UTILS_SIMD_NEON)
+        const float32x4_t vzp = vdupq_n_f32(zp);
+        const float32x4_t vscale = vdupq_n_f32(scale);
+        auto load4 = [&](const uint8_t* p) {
+            uint32_t word;
+            memcpy(&word, p, 4);
+            uint16x8_t v16 = vmovl_u8(vcreate_u8((uint64_t)word));
+            return vmulq_f32(vsubq_f32(vcvtq_f32_u32(vmovl_u16(vget_low_u16(v16))), vzp), vscale);
+        };
+    #else
+        const __m128 vzp = _mm_set1_ps(zp);
+        const __m128 vscale = _mm_set1_ps(scale);
+        const __m128i zero = _mm_setzero_si128();
+        auto load4 = [&](const uint8_t* p) {
+            int32_t word;
+            memcpy(&word, p, 4);
+            __m128i v = _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(word), zero), zero);
+            return _mm_mul_ps(_mm_sub_ps(_mm_cvtepi32_ps(v), vzp), vscale);
+        };
+    #endif
+        for (; r + 4 <= rows; r += 4)
+        {
+            const uint8_t* s = src + (size_t)r * cols;
+            int c = 0;
+            for (; c + 4 <= cols; c += 4)
+            {
+    #if defined(UTILS_SIMD_NEON)
+                float32x4x2_t t01 = vtrnq_f32(load4(s + c), load4(s + cols + c));
+                float32x4x2_t t23 = vtrnq_f32(load4(s + 2 * cols + c), load4(s + 3 * cols + c));
+                vst1q_f32(dst + (size_t)c * rows + r,       vcombine_f32(vget_low_f32(t01.val[0]), vget_low_f32(t23.val[0])));
+                vst1q_f32(dst + (size_t)(c + 1) * rows + r, vcombine_f32(vget_low_f32(t01.val[1]), vget_low_f32(t23.val[1])));
+                vst1q_f32(dst + (size_t)(c + 2) * rows + r, vcombine_f32(vget_high_f32(t01.val[0]), vget_high_f32(t23.val[0])));
+                vst1q_f32(dst + (size_t)(c + 3) * rows + r, vcombine_f32(vget_high_f32(t01.val[1]), vget_high_f32(t23.val[1])));
+    #else
+                __m128 r0 = load4(s + c);
+                __m128 r1 = load4(s + cols + c);
+                __m128 r2 = load4(s + 2 * cols + c);
+                __m128 r3 = load4(s + 3 * cols + c);
+                _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+                _mm_storeu_ps(dst + (size_t)c * rows + r, r0);
+                _mm_storeu_ps(dst + (size_t)(c + 1) * rows + r, r1);
+                _mm_storeu_ps(dst + (size_t)(c + 2) * rows + r, r2);
+                _mm_storeu_ps(dst + (size_t)(c + 3) * rows + r, r3);
+    #endif
+            }
+            for (; c < cols; c++)
+            {
+                for (int k = 0; k < 4; k++)
+                    dst[(size_t)c * rows + r + k] = ((float)s[(size_t)k * cols + c] - zp) * scale;
+            }
+        }
+#endif
+        for (; r < rows; r++)
+        {
+            const uint8_t* s = src + (size_t)r * cols;
+            for (int c = 0; c < cols; c++)
+                dst[(size_t)c * rows + r] = ((float)s[c] - zp) * scale;
+        }
+    }
+
+    static inline void nhwc2nchw(const float* src, int h, int w, int c, float* dst)
+    {
+        transpose_f32(src, h * w, c, dst);
+    }
+
+    static inline void nchw2nhwc(const float* src, int h, int w, int c, float* dst)
+    {
+        transpose_f32(src, c, h * w, dst);
+    }
+
+    /// @brief u8 NHWC feature map to float NCHW
+    static inline void dequant_nhwc2nchw_u8(const uint8_t* src, int h, int w, int c, float zp, float scale, float* dst)
+    {
+        dequant_transpose_u8(src, h * w, c, zp, scale, dst);
+    }
+
+    /// @brief Max of n u8 values
+    static inline uint8_t hmax_u8(const uint8_t* src, int n)
+    {
+        int i = 0;
+        uint8_t m = 0;
+#if defined(UTILS_SIMD_NEON)
+        if (n >= 16)
+        {
+            uint8x16_t vm = vld1q_u8(src);
+            for (i = 16; i + 16 <= n; i += 16)
+                vm = vmaxq_u8(vm, vld1q_u8(src + i));
+    #if defined(__aarch64__)
+            m = vmaxvq_u8(vm);
+    #else
+            uint8x8_t v8 = vpmax_u8(vget_low_u8(vm), vget_high_u8(vm));
+            v8 = vpmax_u8(v8, v8);
+            v8 = vpmax_u8(v8, v8);
+            v8 = vpmax_u8(v8, v8);
+            m = vget_lane_u8(v8, 0);
+    #endif
+        }
+#elif defined(UTILS_SIMD_SSE2)
+        if (n >= 16)
+        {
+            __m128i vm = _mm_loadu_si128((const __m128i*)src);
+            for (i = 16; i + 16 <= n; i += 16)
+                vm = _mm_max_epu8(vm, _mm_loadu_si128((const __m128i*)(src + i)));
+            vm = _mm_max_epu8(vm, _mm_srli_si128(vm, 8));
+            vm = _mm_max_epu8(vm, _mm_srli_si128(vm, 4));
+            vm = _mm_max_epu8(vm, _mm_srli_si128(vm, 2));
+            vm = _mm_max_epu8(vm, _mm_srli_si128(vm, 1));
+            m = (uint8_t)_mm_cvtsi128_si32(vm);
+        }
+#endif
+        for (; i < n; i++)
+            m = src[i] > m ? src[i] : m;
+        return m;
+    }
+
+    /// @brief Max of n (> 0) float values
+    static inline float hmax_f32(const float* src, int n)
+    {
+        int i = 1;
+        float m = src[0];
+#if defined(UTILS_SIMD_NEON)
+        if (n >= 4)
+        {
+            float32x4_t vm = vld1q_f32(src);
+            for (i = 4; i + 4 <= n; i += 4)
+                vm = vmaxq_f32(vm, vld1q_f32(src + i));
+    #if defined(__aarch64__)
+            m = vmaxvq_f32(vm);
+    #else
+            float32x2_t v2 = vpmax_f32(vget_low_f32(vm), vget_high_f32(vm));
+            v2 = vpmax_f32(v2, v2);
+            m = vget_lane_f32(v2, 0);
+    #endif
+        }
+#elif defined(UTILS_SIMD_SSE2)
+        if (n >= 4)
+        {
+            __m128 vm = _mm_loadu_ps(src);
+            for (i = 4; i + 4 <= n; i += 4)
+                vm = _mm_max_ps(vm, _mm_loadu_ps(src + i));
+            vm = _mm_max_ps(vm, _mm_movehl_ps(vm, vm));
+            vm = _mm_max_ss(vm, _mm_shuffle_ps(vm, vm, 1));
+            m = _mm_cvtss_f32(vm);
+        }
+#endif
+        for (; i < n; i++)
+            m = src[i] > m ? src[i] : m;
+        return m;
+    }
+
+    /// @brief Index of the first value equal to v, n if none
+    static inline int find_first_u8(const uint8_t* src, int n, uint8_t v)
+    {
+        int i = 0;
+#if defined(UTILS_SIMD_NEON)
+        const uint8x16_t vv = vdupq_n_u8(v);
+        for (; i + 16 <= n; i += 16)
+        {
+            uint64x2_t eq = vreinterpretq_u64_u8(vceqq_u8(vld1q_u8(src + i), vv));
+            if (vgetq_lane_u64(eq, 0) | vgetq_lane_u64(eq, 1))
+                break;
+        }
+#elif defined(UTILS_SIMD_SSE2)
+        const __m128i vv = _mm_set1_epi8((char)v);
+        for (; i + 16 <= n; i += 16)
+        {
+            int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(src + i)), vv));
+            if (mask)
+                return i + __builtin_ctz(mask);
+        }
+#endif
+        for (; i < n; i++)
+        {
+            if (src[i] == v)
+                return i;
+        }
+        return n;
+    }
+
+    static inline int find_first_f32(const float* src, int n, float v)
+    {
+        int i = 0;
+#if defined(UTILS_SIMD_NEON)
+        const float32x4_t vv = vdupq_n_f32(v);
+        for (; i + 4 <= n; i += 4)
+        {
+            uint64x2_t eq = vreinterpretq_u64_u32(vceqq_f32(vld1q_f32(src + i), vv));
+            if (vgetq_lane_u64(eq, 0) | vgetq_lane_u64(eq, 1))
+                break;
+        }
+#elif defined(UTILS_SIMD_SSE2)
+        const __m128 vv = _mm_set1_ps(v);
+        for (; i + 4 <= n; i += 4)
+        {
+            int mask = _mm_movemask_ps(_mm_cmpeq_ps(_mm_loadu_ps(src + i), vv));
+            if (mask)
+                return i + __builtin_ctz(mask);
+        }
+#endif
+        for (; i < n; i++)
+        {
+            if (src[i] == v)
+                return i;
+        }
+        return n;
+    }
+
+    /// @brief Index of the first max of n (> 0) values: vector max, then a vector scan for it
+    static inline int argmax_u8(const uint8_t* src, int n, uint8_t* max_value)
+    {
+        *max_value = hmax_u8(src, n);
+        return find_first_u8(src, n, *max_value);
+    }
+
+    static inline int argmax_f32(const float* src, int n, float* max_value)
+    {
+        *max_value = hmax_f32(src, n);
+        return find_first_f32(src, n, *max_value);
+    }
+
+    /// @brief Class max of NHWC u8 cells (classes contiguous, cell_stride bytes apart).
+    ///        Cells with max >= thresh are appended to cand/cand_max, returns their number.
+    static inline int class_max_nhwc_u8(const uint8_t* src, int num_cells, int cell_stride, int num_class, uint8_t thresh,
+                                        int* cand, uint8_t* cand_max)
+    {
+        int num = 0;
+        for (int i = 0; i < num_cells; i++)
+        {
+            uint8_t m = hmax_u8(src + (size_t)i * cell_stride, num_class);
+            if (m >= thresh)
+            {
+                cand[num] = i;
+                cand_max[num] = m;
+                num++;
+            }
+        }
+        return num;
+    }
+
+    /// @brief Class max and argmax of NCHW u8 planes (plane_stride bytes apart), 16 (32 with AVX2) cells at a time.
+    ///        num_class must be <= 256, ties keep the lowest class.
+    static inline void class_max_nchw_u8(const uint8_t* src, int num_cells, int plane_stride, int num_class,
+                                         uint8_t* out_max, uint8_t* out_arg)
+    {
+        int i = 0;
+#if defined(UTILS_SIMD_NEON)
+        for (; i + 16 <= num_cells; i += 16)
+        {
+            uint8x16_t vm = vld1q_u8(src + i);
+            uint8x16_t va = vdupq_n_u8(0);
+            for (int k = 1; k < num_class; k++)
+            {
+                uint8x16_t v = vld1q_u8(src + (size_t)k * plane_stride + i);
+                uint8x16_t gt = vcgtq_u8(v, vm);
+                vm = vmaxq_u8(vm, v);
+                va = vbslq_u8(gt, vdupq_n_u8((uint8_t)k), va);
+            }
+            vst1q_u8(out_max + i, vm);
+            vst1q_u8(out_arg + i, va);
+        }
+#elif defined(UTILS_SIMD_SSE2)
+    #if defined(UTILS_SIMD_AVX2)
+        const __m256i bias32 = _mm256_set1_epi8((char)0x80);
+        for (; i + 32 <= num_cells; i += 32)
+        {
+            __m256i vm = _mm256_loadu_si256((const __m256i*)(src + i));
+            __m256i va = _mm256_setzero_si256();
+            for (int k = 1; k < num_class; k++)
+            {
+                __m256i v = _mm256_loadu_si256((const __m256i*)(src + (size_t)k * plane_stride + i));
+                __m256i gt = _mm256_cmpgt_epi8(_mm256_xor_si256(v, bias32), _mm256_xor_si256(vm, bias32));
+                vm = _mm256_max_epu8(vm, v);
+                va = _mm256_blendv_epi8(va, _mm256_set1_epi8((char)k), gt);
+            }
+            _mm256_storeu_si256((__m256i*)(out_max + i), vm);
+            _mm256_storeu_si256((__m256i*)(out_arg + i), va);
+        }
+    #endif
+        // unsigned compare through the signed one with the sign bit flipped
+        const __m128i bias = _mm_set1_epi8((char)0x80);
+        for (; i + 16 <= num_cells; i += 16)
+        {
+            __m128i vm = _mm_loadu_si128((const __m128i*)(src + i));
+            __m128i va = _mm_setzero_si128();
+            for (int k = 1; k < num_class; k++)
+            {
+                __m128i v = _mm_loadu_si128((const __m128i*)(src + (size_t)k * plane_stride + i));
+                __m128i gt = _mm_cmpgt_epi8(_mm_xor_si128(v, bias), _mm_xor_si128(vm, bias));
+                vm = _mm_max_epu8(vm, v);
+                va = _mm_or_si128(_mm_and_si128(gt, _mm_set1_epi8((char)k)), _mm_andnot_si128(gt, va));
+            }
+            _mm_storeu_si128((__m128i*)(out_max + i), vm);
+            _mm_storeu_si128((__m128i*)(out_arg + i), va);
+        }
+#endif
+        for (; i < num_cells; i++)
+        {
+            uint8_t m = src[i];
+            uint8_t a = 0;
+            for (int k = 1; k < num_class; k++)
+            {
+                uint8_t v = src[(size_t)k * plane_stride + i];
+                if (v > m)
+                {
+                    m = v;
+                    a = (uint8_t)k;
+                }
+            }
+            out_max[i] = m;
+            out_arg[i] = a;
+        }
+    }
+
+    /// @brief Class max and argmax of NCHW float planes, 4 cells at a time. Ties keep the lowest class.
+    static inline void class_max_nchw_f32(const float* src, int num_cells, int plane_stride, int num_class,
+                                          float* out_max, int* out_arg)
+    {
+        int i = 0;
+#if defined(UTILS_SIMD_NEON)
+        for (; i + 4 <= num_cells; i += 4)
+        {
+            float32x4_t vm = vld1q_f32(src + i);
+            int32x4_t va = vdupq_n_s32(0);
+            for (int k = 1; k < num_class; k++)
+            {
+                float32x4_t v = vld1q_f32(src + (size_t)k * plane_stride + i);
+                uint32x4_t gt = vcgtq_f32(v, vm);
+                vm = vbslq_f32(gt, v, vm);
+                va = vbslq_s32(gt, vdupq_n_s32(k), va);
+            }
+            vst1q_f32(out_max + i, vm);
+            vst1q_s32(out_arg + i, va);
+        }
+#elif defined(UTILS_SIMD_SSE2)
+        for (; i + 4 <= num_cells; i += 4)
+        {
+            __m128 vm = _mm_loadu_ps(src + i);
+            __m128i va = _mm_setzero_si128();
+            for (int k = 1; k < num_class; k++)
+            {
+                __m128 v = _mm_loadu_ps(src + (size_t)k * plane_stride + i);
+                __m128i gt = _mm_castps_si128(_mm_cmpgt_ps(v, vm));
+                vm = _mm_max_ps(vm, v);
+                va = _mm_or_si128(_mm_and_si128(gt, _mm_set1_epi32(k)), _mm_andnot_si128(gt, va));
+            }
+            _mm_storeu_ps(out_max + i, vm);
+            _mm_storeu_si128((__m128i*)(out_arg + i), va);
+        }
+#endif
+        for (; i < num_cells; i++)
+        {
+            float m = src[i];
+            int a = 0;
+            for (int k = 1; k < num_class; k++)
+            {
+                float v = src[(size_t)k * plane_stride + i];
+                if (v > m)
+                {
+                    m = v;
+                    a = k;
+                }
+            }
+            out_max[i] = m;
+            out_arg[i] = a;
+        }
+    }
+
+    /// @brief Indices of values >= thresh, whole 16-byte chunks below thresh are skipped at once
+    static inline int select_ge_u8(const uint8_t* values, int n, uint8_t thresh, int* cand)
+    {
+        int num = 0;
+        int i = 0;
+#if defined(UTILS_SIMD_NEON)
+        const uint8x16_t vt = vdupq_n_u8(thresh);
+        for (; i + 16 <= n; i += 16)
+        {
+            uint8x16_t ge = vcgeq_u8(vld1q_u8(values + i), vt);
+            uint64x2_t g64 = vreinterpretq_u64_u8(ge);
+            if ((vgetq_lane_u64(g64, 0) | vgetq_lane_u64(g64, 1)) == 0)
+                continue;
+            for (int k = 0; k < 16; k++)
+            {
+                if (values[i + k] >= thresh)
+                    cand[num++] = i + k;
+            }
+        }
+#elif defined(UTILS_SIMD_SSE2)
+        const __m128i vt = _mm_set1_epi8((char)thresh);
+        for (; i + 16 <= n; i += 16)
+        {
+            __m128i v = _mm_loadu_si128((const __m128i*)(values + i));
+            // v >= t  <=>  max(v, t) == v
+            int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_max_epu8(v, vt), v));
+            while (mask)
+            {
+                int k = __builtin_ctz(mask);
+                cand[num++] = i + k;
+                mask &= mask - 1;
+            }
+        }
+#endif
+        for (; i < n; i++)
+        {
+            if (values[i] >= thresh)
+                cand[num++] = i;
+        }
+        return num;
+    }
+
+    /// @brief Indices of values > thresh
+    static inline int select_gt_f32(const float* values, int n, float thresh, int* cand)
+    {
+        int num = 0;
+        int i = 0;
+#if defined(UTILS_SIMD_NEON)
+        const float32x4_t vt = vdupq_n_f32(thresh);
+        for (; i + 4 <= n; i += 4)
+        {
+            uint32x4_t gt = vcgtq_f32(vld1q_f32(values + i), vt);
+            uint64x2_t g64 = vreinterpretq_u64_u32(gt);
+            if ((vgetq_lane_u64(g64, 0) | vgetq_lane_u64(g64, 1)) == 0)
+                continue;
+            for (int k = 0; k < 4; k++)
+            {
+                if (values[i + k] > thresh)
+                    cand[num++] = i + k;
+            }
+        }
+#elif defined(UTILS_SIMD_SSE2)
+        const __m128 vt = _mm_set1_ps(thresh);
+        for (; i + 4 <= n; i += 4)
+        {
+            int mask = _mm_movemask_ps(_mm_cmpgt_ps(_mm_loadu_ps(values + i), vt));
+            while (mask)
+            {
+                int k = __builtin_ctz(mask);
+                cand[num++] = i + k;
+                mask &= mask - 1;
+            }
+        }
+#endif
+        for (; i < n; i++)
+        {
+            if (values[i] > thresh)
+                cand[num++] = i;
+        }
+        return num;
+    }
+
+    static inline float exp_f32_scalar(float x)
+    {
+        x = std::min(std::max(x, -87.3f), 88.3f);
+        float n = std::floor(x * 1.44269504088896341f + 0.5f);
+        x = x - n * 0.693359375f + n * 2.12194440e-4f;
+        float y = 1.9875691500E-4f;
+        y = y * x + 1.3981999507E-3f;
+        y = y * x + 8.3334519073E-3f;
+        y = y * x + 4.1665795894E-2f;
+        y = y * x + 1.6666665459E-1f;
+        y = y * x + 5.0000001201E-1f;
+        y = y * (x * x) + x + 1.f;
+        int32_t e = ((int32_t)n + 127) << 23;
+        float p;
+        memcpy(&p, &e, sizeof(p));
+        return y * p;
+    }
+
+    /// @brief dst[i] = exp(src[i]), in place allowed
+    static inline void exp_f32(const float* src, float* dst, int n)
+    {
+        int i = 0;
+#if defined(UTILS_SIMD_NEON)
+        const float32x4_t lo = vdupq_n_f32(-87.3f), hi = vdupq_n_f32(88.3f);
+        for (; i + 4 <= n; i += 4)
+        {
+            float32x4_t x = vminq_f32(vmaxq_f32(vld1q_f32(src + i), lo), hi);
+            float32x4_t fx = vaddq_f32(vmulq_f32(x, vdupq_n_f32(1.44269504088896341f)), vdupq_n_f32(0.5f));
+            // floor: truncate, then step down where truncation rounded up
+            float32x4_t t = vcvtq_f32_s32(vcvtq_s32_f32(fx));
+            float32x4_t fl = vsubq_f32(t, vreinterpretq_f32_u32(vandq_u32(vcgtq_f32(t, fx), vreinterpretq_u32_f32(vdupq_n_f32(1.f)))));
+            x = vsubq_f32(x, vmulq_f32(fl, vdupq_n_f32(0.693359375f)));
+            x = vaddq_f32(x, vmulq_f32(fl, vdupq_n_f32(2.12194440e-4f)));
+            float32x4_t y = vdupq_n_f32(1.9875691500E-4f);
+            y = vaddq_f32(vmulq_f32(y, x), vdupq_n_f32(1.3981999507E-3f));
+            y = vaddq_f32(vmulq_f32(y, x), vdupq_n_f32(8.3334519073E-3f));
+            y = vaddq_f32(vmulq_f32(y, x), vdupq_n_f32(4.1665795894E-2f));
+            y = vaddq_f32(vmulq_f32(y, x), vdupq_n_f32(1.6666665459E-1f));
+            y = vaddq_f32(vmulq_f32(y, x), vdupq_n_f32(5.0000001201E-1f));
+            y = vaddq_f32(vaddq_f32(vmulq_f32(y, vmulq_f32(x, x)), x), vdupq_n_f32(1.f));
+            int32x4_t e = vshlq_n_s32(vaddq_s32(vcvtq_s32_f32(fl), vdupq_n_s32(127)), 23);
+            vst1q_f32(dst + i, vmulq_f32(y, vreinterpretq_f32_s32(e)));
+        }
+#elif defined(UTILS_SIMD_SSE2)
+        const __m128 lo = _mm_set1_ps(-87.3f), hi = _mm_set1_ps(88.3f);
+        for (; i + 4 <= n; i += 4)
+        {
+            __m128 x = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(src + i), lo), hi);
+            __m128 fx = _mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(1.44269504088896341f)), _mm_set1_ps(0.5f));
+            // floor: truncate, then step down where truncation rounded up
+            __m128 t = _mm_cvtepi32_ps(_mm_cvttps_epi32(fx));
+            __m128 fl = _mm_sub_ps(t, _mm_and_ps(_mm_cmpgt_ps(t, fx), _mm_set1_ps(1.f)));
+            x = _mm_sub_ps(x, _mm_mul_ps(fl, _mm_set1_ps(0.693359375f)));
+            x = _mm_add_ps(x, _mm_mul_ps(fl, _mm_set1_ps(2.12194440e-4f)));
+            __m128 y = _mm_set1_ps(1.9875691500E-4f);
+            y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(1.3981999507E-3f));
+            y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(8.3334519073E-3f));
+            y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(4.1665795894E-2f));
+            y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(1.6666665459E-1f));
+            y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(5.0000001201E-1f));
+            y = _mm_add_ps(_mm_add_ps(_mm_mul_ps(y, _mm_mul_ps(x, x)), x), _mm_set1_ps(1.f));
+            __m128i e = _mm_slli_epi32(_mm_add_epi32(_mm_cvttps_epi32(fl), _mm_set1_epi32(127)), 23);
+            _mm_storeu_ps(dst + i, _mm_mul_ps(y, _mm_castsi128_ps(e)));
+        }
+#endif
+        for (; i < n; i++)
+            dst[i] = exp_f32_scalar(src[i]);
+    }
+}
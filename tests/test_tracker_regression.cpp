@@ -0,0 +1,102 @@
+//
+// Seeded ByteTrack regression: every frame of the scenarios is checked against a reference written by
+// an earlier build. Association (track count, order, ids, labels, user_data) has to match exactly,
+// boxes and scores within float rounding.
+//
+// test_tracker_regression <reference>          compare
+// test_tracker_regression --write <reference>  write the reference with this build
+//
+#include "tracker_scenario.hpp"
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+struct FrameSummary {
+    int scenario;
+    int frame;
+    int n_tracks;
+    unsigned long long hash; // FNV-1a over label, track id and user_data of every track, in order
+    double box_sum;
+    double prob_sum;
+};
+
+static void Summarize(int scenario, int frame, const bytetrack_object_t& objs, FrameSummary& summary) {
+    summary.scenario = scenario;
+    summary.frame = frame;
+    summary.n_tracks = objs.n_track_objects;
+    summary.hash = 0xcbf29ce484222325ull;
+    summary.box_sum = 0;
+    summary.prob_sum = 0;
+    for (int i = 0; i < objs.n_track_objects; i++) {
+        const track_object_t& t = objs.track_objects[i];
+        long long fields[3] = {t.label, (long long)t.track_id, (long long)(intptr_t)t.user_data};
+        for (long long v : fields) {
+            summary.hash = (summary.hash ^ (unsigned long long)v) * 0x100000001b3ull;
+        }
+        summary.box_sum += (double)t.rect.x + t.rect.y + t.rect.width + t.rect.height;
+        summary.prob_sum += t.prob;
+    }
+}
+
+int main(int argc, char** argv) {
+    bool write = argc == 3 && strcmp(argv[1], "--write") == 0;
+    if (argc != 2 && !write) {
+        printf("usage: %s [--write] <reference>\n", argv[0]);
+        return -1;
+    }
+
+    FILE* fp = fopen(argv[argc - 1], write ? "w" : "r");
+    if (!fp) {
+        printf("can not open %s\n", argv[argc - 1]);
+        return -1;
+    }
+
+    int checked = 0;
+    int num_scenarios = sizeof(g_tracker_scenarios) / sizeof(g_tracker_scenarios[0]);
+    static bytetrack_object_t objs;
+    std::vector<track_object_t> dets;
+    for (int s = 0; s < num_scenarios; s++) {
+        TrackerScenario scenario(g_tracker_scenarios[s]);
+        bytetracker_t tracker = bytetracker_create(30, 30);
+        for (int f = 0; f < g_tracker_scenarios[s].frames; f++) {
+            bool detect = scenario.Next(dets);
+            TrackFrame(tracker, detect, dets, objs);
+
+            FrameSummary got;
+            Summarize(s, f, objs, got);
+            if (write) {
+                fprintf(fp, "%d %d %d %016llx %.4f %.5f\n", got.scenario, got.frame, got.n_tracks, got.hash, got.box_sum, got.prob_sum);
+                continue;
+            }
+
+            FrameSummary want;
+            if (fscanf(fp, "%d %d %d %llx %lf %lf", &want.scenario, &want.frame, &want.n_tracks, &want.hash, &want.box_sum, &want.prob_sum) != 6
+                || want.scenario != s || want.frame != f) {
+                printf("reference ends before scenario %d frame %d\n", s, f);
+                fclose(fp);
+                return -1;
+            }
+            // the box sum adds up 4 rounded coordinates per track
+            double box_tol = 1e-3 * 4 * (got.n_tracks + 1);
+            double prob_tol = 1e-4 * (got.n_tracks + 1);
+            if (got.n_tracks != want.n_tracks || got.hash != want.hash
+                || std::fabs(got.box_sum - want.box_sum) > box_tol || std::fabs(got.prob_sum - want.prob_sum) > prob_tol) {
+                printf("scenario %d frame %d differs\n", s, f);
+                printf("  want: %d tracks %016llx %.4f %.5f\n", want.n_tracks, want.hash, want.box_sum, want.prob_sum);
+                printf("  got:  %d tracks %016llx %.4f %.5f\n", got.n_tracks, got.hash, got.box_sum, got.prob_sum);
+                fclose(fp);
+                return 1;
+            }
+            checked++;
+        }
+        bytetracker_release(&tracker);
+    }
+    fclose(fp);
+
+    if (write)
+        printf("reference written to %s\n", argv[2]);
+    else
+        printf("%d frames match the reference\n", checked);
+    return 0;
+}
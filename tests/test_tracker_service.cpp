@@ -0,0 +1,150 @@
+//
+// ByteTrack service ordering: channels submitted from several threads have to deliver every frame
+// once, in submit order, with the tracks a tracker of their own gives on the same frames. Control
+// calls are mixed in: schedule changes from the callback and a snapshot while frames keep coming.
+//
+// Track ids come from one counter per process, so the channels interleave their ids; a channel's ids
+// have to map one to one onto the ids of its own tracker.
+//
+#include "tracker_scenario.hpp"
+
+#include <atomic>
+#include <cstdio>
+#include <map>
+#include <string>
+#include <thread>
+
+#define NUM_CHANNELS    6
+#define NUM_SUBMITTERS  2
+
+struct ChannelCheck {
+    TrackerScenario::Params params;
+    std::vector<std::vector<track_object_t>> expected; // tracks per frame
+    int delivered;
+    std::map<long, long> ids; // own tracker id -> service id
+    std::map<long, long> ids_back;
+};
+
+static ChannelCheck g_channels[NUM_CHANNELS];
+static bytetrack_service_t g_service;
+static std::atomic<int> g_errors(0);
+
+static void Fail(int channel, int frame, const char* what) {
+    if (g_errors++ < 10)
+        printf("channel %d frame %d: %s\n", channel, frame, what);
+}
+
+static bool SameId(ChannelCheck& ch, long expected_id, long id) {
+    auto it = ch.ids.find(expected_id);
+    if (it != ch.ids.end())
+        return it->second == id;
+    if (ch.ids_back.count(id))
+        return false;
+    ch.ids[expected_id] = id;
+    ch.ids_back[id] = expected_id;
+    return true;
+}
+
+// runs on the workers, at most one call per channel at a time
+static void OnTracks(int channel, const track_object_t* tracks, int n_tracks, void* frame_user, void* user) {
+    ChannelCheck& ch = g_channels[channel];
+    int frame = (int)(intptr_t)frame_user;
+    if (frame != ch.delivered) {
+        Fail(channel, frame, ("delivered out of order, expected frame " + std::to_string(ch.delivered)).c_str());
+        ch.delivered = frame;
+    }
+    ch.delivered++;
+    if (frame < 0 || frame >= (int)ch.expected.size())
+        return;
+
+    const std::vector<track_object_t>& expected = ch.expected[frame];
+    if (n_tracks != (int)expected.size()) {
+        Fail(channel, frame, "track count differs");
+        return;
+    }
+    for (int i = 0; i < n_tracks; i++) {
+        const track_object_t& x = expected[i];
+        const track_object_t& y = tracks[i];
+        if (x.label != y.label || x.prob != y.prob || x.user_data != y.user_data
+            || x.rect.x != y.rect.x || x.rect.y != y.rect.y || x.rect.width != y.rect.width || x.rect.height != y.rect.height
+            || !SameId(ch, x.track_id, y.track_id)) {
+            Fail(channel, frame, "tracks differ");
+            return;
+        }
+    }
+
+    // a control call from the callback only queues, the schedule does not change the tracks
+    if (frame % 50 == 25) {
+        bytetrack_schedule_t schedule = {1, 4, 0.05f, 0.5f, 0.9f};
+        bytetrack_service_set_schedule(g_service, channel, &schedule);
+    }
+}
+
+static void Submit(int submitter) {
+    TrackerScenario* scenarios[NUM_CHANNELS] = {};
+    for (int c = submitter; c < NUM_CHANNELS; c += NUM_SUBMITTERS)
+        scenarios[c] = new TrackerScenario(g_channels[c].params);
+
+    std::vector<track_object_t> dets;
+    for (int f = 0; f < g_tracker_scenarios[0].frames; f++) {
+        for (int c = submitter; c < NUM_CHANNELS; c += NUM_SUBMITTERS) {
+            bool detect = scenarios[c]->Next(dets);
+            if (bytetrack_service_submit(g_service, c, detect ? dets.data() : nullptr, (int)dets.size(), (void*)(intptr_t)f) != 0)
+                Fail(c, f, "submit failed");
+        }
+        // waits only for the frames submitted before it
+        if (submitter == 0 && f % 100 == 50 && bytetrack_service_snapshot_file(g_service, 0, "tracker_service.bin") != 0)
+            Fail(0, f, "snapshot failed");
+    }
+
+    for (int c = submitter; c < NUM_CHANNELS; c += NUM_SUBMITTERS)
+        delete scenarios[c];
+}
+
+int main() {
+    static bytetrack_object_t objs;
+    std::vector<track_object_t> dets;
+    int num_scenarios = sizeof(g_tracker_scenarios) / sizeof(g_tracker_scenarios[0]);
+    for (int c = 0; c < NUM_CHANNELS; c++) {
+        ChannelCheck& ch = g_channels[c];
+        ch.params = g_tracker_scenarios[c % num_scenarios];
+        ch.params.seed += 100 * c;
+        ch.params.frames = g_tracker_scenarios[0].frames;
+        ch.delivered = 0;
+
+        TrackerScenario scenario(ch.params);
+        bytetracker_t tracker = bytetracker_create(30, 30);
+        for (int f = 0; f < ch.params.frames; f++) {
+            bool detect = scenario.Next(dets);
+            TrackFrame(tracker, detect, dets, objs);
+            ch.expected.emplace_back(objs.track_objects, objs.track_objects + objs.n_track_objects);
+        }
+        bytetracker_release(&tracker);
+    }
+
+    remove("tracker_service.bin");
+    g_service = bytetrack_service_create(4, 30, 30, 0, OnTracks, nullptr);
+    if (bytetrack_service_need_detect(g_service, NUM_CHANNELS) != 1)
+        Fail(NUM_CHANNELS, 0, "an unknown channel does not ask for a detection");
+
+    std::vector<std::thread> submitters;
+    for (int i = 0; i < NUM_SUBMITTERS; i++)
+        submitters.emplace_back(Submit, i);
+    for (auto& t : submitters)
+        t.join();
+    bytetrack_service_flush(g_service);
+
+    for (int c = 0; c < NUM_CHANNELS; c++) {
+        bytetrack_health_t health;
+        bytetrack_service_get_health(g_service, c, &health);
+        if (g_channels[c].delivered != g_channels[c].params.frames || health.frames != g_channels[c].params.frames)
+            Fail(c, g_channels[c].delivered, "frames missing");
+    }
+    bytetrack_service_release(&g_service);
+    remove("tracker_service.bin");
+
+    if (g_errors > 0)
+        return 1;
+    printf("%d channels delivered in order and match their own trackers\n", NUM_CHANNELS);
+    return 0;
+}
@@ -0,0 +1,137 @@
+//
+// ByteTrack snapshot / restore: a tracker restored halfway through a scenario has to continue exactly
+// like the one that ran through, through a memory snapshot and through a snapshot file.
+//
+// Track ids come from one counter per process, so the restored tracker runs in a forked process,
+// like a restarted pipeline would, and records its frames for the parent to compare.
+//
+#include "tracker_scenario.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// user_data is not part of a snapshot, restored tracks have none
+static bool SameTracks(const bytetrack_object_t& a, const track_object_t* b, int n) {
+    if (a.n_track_objects != n)
+        return false;
+    for (int i = 0; i < n; i++) {
+        const track_object_t& x = a.track_objects[i];
+        const track_object_t& y = b[i];
+        if (x.label != y.label || x.track_id != y.track_id || x.prob != y.prob
+            || x.rect.x != y.rect.x || x.rect.y != y.rect.y || x.rect.width != y.rect.width || x.rect.height != y.rect.height)
+            return false;
+    }
+    return true;
+}
+
+// restores a new tracker from tracker, through path when set, and writes the tracks of the remaining frames to record
+static int RunRestored(bytetracker_t tracker, const char* path, TrackerScenario& scenario, int from, const std::string& record) {
+    bytetracker_t restored = bytetracker_create(30, 30);
+    int ret = 0;
+    if (path) {
+        ret = bytetracker_snapshot_file(tracker, path);
+        if (ret == 0)
+            ret = bytetracker_restore_file(restored, path);
+    } else {
+        std::vector<unsigned char> buf(bytetracker_snapshot(tracker, nullptr, 0));
+        ret = bytetracker_snapshot(tracker, buf.data(), (int)buf.size()) == (int)buf.size() ? 0 : -1;
+        if (ret == 0)
+            ret = bytetracker_restore(restored, buf.data(), (int)buf.size());
+    }
+    if (ret != 0) {
+        printf("snapshot %s failed\n", path ? path : "to memory");
+        bytetracker_release(&restored);
+        return ret;
+    }
+
+    FILE* fp = fopen(record.c_str(), "wb");
+    if (!fp) {
+        bytetracker_release(&restored);
+        return -1;
+    }
+    static bytetrack_object_t objs;
+    std::vector<track_object_t> dets;
+    for (int f = from; f < scenario.GetParams().frames; f++) {
+        bool detect = scenario.Next(dets);
+        TrackFrame(restored, detect, dets, objs);
+        fwrite(&objs.n_track_objects, sizeof(int), 1, fp);
+        fwrite(objs.track_objects, sizeof(track_object_t), objs.n_track_objects, fp);
+    }
+    fclose(fp);
+    bytetracker_release(&restored);
+    return 0;
+}
+
+// path: restore through a snapshot file, nullptr: through memory
+static int RunScenario(int s, const char* path, const std::string& record) {
+    const TrackerScenario::Params& params = g_tracker_scenarios[s];
+    TrackerScenario scenario(params);
+    bytetracker_t tracker = bytetracker_create(30, 30);
+    static bytetrack_object_t objs;
+    std::vector<track_object_t> dets;
+
+    int half = params.frames / 2;
+    for (int f = 0; f < half; f++) {
+        bool detect = scenario.Next(dets);
+        TrackFrame(tracker, detect, dets, objs);
+    }
+
+    fflush(stdout);
+    pid_t pid = fork();
+    if (pid == 0)
+        _exit(RunRestored(tracker, path, scenario, half, record) == 0 ? 0 : 1);
+    int status = 0;
+    if (pid < 0 || waitpid(pid, &status, 0) != pid || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        printf("scenario %d: the restored run failed\n", s);
+        bytetracker_release(&tracker);
+        return -1;
+    }
+
+    FILE* fp = fopen(record.c_str(), "rb");
+    int ret = fp ? 0 : -1;
+    std::vector<track_object_t> tracks;
+    for (int f = half; f < params.frames && ret == 0; f++) {
+        bool detect = scenario.Next(dets);
+        TrackFrame(tracker, detect, dets, objs);
+
+        int n = 0;
+        if (fread(&n, sizeof(int), 1, fp) != 1 || n < 0 || n > TRACK_OBJETCS_MAX_SIZE) {
+            printf("scenario %d frame %d: the restored run recorded no tracks\n", s, f);
+            ret = -1;
+            break;
+        }
+        tracks.resize(n);
+        if (fread(tracks.data(), sizeof(track_object_t), n, fp) != (size_t)n || !SameTracks(objs, tracks.data(), n)) {
+            printf("scenario %d frame %d: the restored tracker differs (%d vs %d tracks)\n", s, f, n, objs.n_track_objects);
+            ret = 1;
+        }
+    }
+    if (fp)
+        fclose(fp);
+    remove(record.c_str());
+    bytetracker_release(&tracker);
+    return ret;
+}
+
+int main(int argc, char** argv) {
+    std::string path = argc > 1 ? argv[1] : "tracker_snapshot.bin";
+    std::string record = path + ".frames";
+
+    int num_scenarios = sizeof(g_tracker_scenarios) / sizeof(g_tracker_scenarios[0]);
+    for (int s = 0; s < num_scenarios; s++) {
+        int ret = RunScenario(s, nullptr, record);
+        if (ret == 0) {
+            // a fresh file, so restore can not pick up a newer slot of an earlier run
+            remove(path.c_str());
+            ret = RunScenario(s, path.c_str(), record);
+        }
+        if (ret != 0)
+            return ret;
+    }
+    remove(path.c_str());
+    printf("%d scenarios continue identically after restore\n", num_scenarios);
+    return 0;
+}
@@ -0,0 +1,141 @@
+//
+// Seeded synthetic detections shared by the tracker tests.
+//
+#pragma once
+
+#include "bytetrack.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Objects drift across a 1920x1080 frame, appear and vanish; their detections jitter, get missed,
+// come with low scores and next to false positives. The same seed gives the same frames on every build.
+class TrackerScenario {
+public:
+    struct Params {
+        int seed;
+        int frames;
+        int num_objects;
+        int predict_interval; // > 0: only every n-th frame has detections, 0: all of them
+    };
+
+    explicit TrackerScenario(const Params& params) : m_params(params), m_frame(0) {
+        m_state = 0x9E3779B97F4A7C15ull * params.seed + 1;
+        m_objects.resize(params.num_objects);
+        for (auto& o : m_objects) {
+            o.alive = Uniform() < 0.7f;
+            o.x = Uniform() * 1800;
+            o.y = Uniform() * 1000;
+            o.w = 20 + Uniform() * 80;
+            o.h = o.w * (1.5f + Uniform());
+            o.vx = (Uniform() - 0.5f) * 8;
+            o.vy = (Uniform() - 0.5f) * 4;
+            o.label = Random() % 2;
+        }
+    }
+
+    /// @brief Detections of the next frame, false: a frame without detections (bytetracker_predict)
+    bool Next(std::vector<track_object_t>& dets) {
+        dets.clear();
+        for (auto& o : m_objects) {
+            if (!o.alive) {
+                if (Uniform() < 0.01f) {
+                    o.alive = true;
+                    o.x = Uniform() * 1800;
+                    o.y = Uniform() * 1000;
+                }
+                continue;
+            }
+            if (Uniform() < 0.003f) {
+                o.alive = false;
+                continue;
+            }
+            o.x += o.vx;
+            o.y += o.vy;
+            if (Uniform() < 0.05f) {
+                o.vx += (Uniform() - 0.5f) * 3;
+                o.vy += (Uniform() - 0.5f) * 2;
+            }
+            if (o.x < 0 || o.x > 1900) o.vx = -o.vx;
+            if (o.y < 0 || o.y > 1060) o.vy = -o.vy;
+        }
+
+        int frame = m_frame++;
+        if (m_params.predict_interval > 0 && frame % m_params.predict_interval != 0)
+            return false;
+
+        for (auto& o : m_objects) {
+            if (!o.alive || Uniform() < 0.08f || (int)dets.size() >= TRACK_OBJETCS_MAX_SIZE)
+                continue;
+            track_object_t d = {};
+            d.label = o.label;
+            d.prob = Uniform() < 0.2f ? 0.1f + Uniform() * 0.25f : 0.4f + Uniform() * 0.6f;
+            d.rect.x = o.x + (Uniform() - 0.5f) * 4;
+            d.rect.y = o.y + (Uniform() - 0.5f) * 4;
+            d.rect.width = o.w * (0.95f + Uniform() * 0.1f);
+            d.rect.height = o.h * (0.95f + Uniform() * 0.1f);
+            dets.push_back(d);
+            dets.back().user_data = (void*)(intptr_t)dets.size();
+        }
+        for (int k = 0; k < 2 && (int)dets.size() < TRACK_OBJETCS_MAX_SIZE; k++) {
+            if (Uniform() < 0.3f) {
+                track_object_t d = {};
+                d.label = Random() % 2;
+                d.prob = Uniform();
+                d.rect.x = Uniform() * 1800;
+                d.rect.y = Uniform() * 1000;
+                d.rect.width = 30;
+                d.rect.height = 60;
+                dets.push_back(d);
+            }
+        }
+        return true;
+    }
+
+    const Params& GetParams() const {
+        return m_params;
+    }
+
+private:
+    struct Object {
+        float x, y, w, h, vx, vy;
+        int label;
+        bool alive;
+    };
+
+    uint32_t Random() {
+        m_state ^= m_state << 13;
+        m_state ^= m_state >> 7;
+        m_state ^= m_state << 17;
+        return (uint32_t)m_state;
+    }
+
+    float Uniform() {
+        return (Random() & 0xFFFFFF) / 16777216.f;
+    }
+
+    Params m_params;
+    int m_frame;
+    uint64_t m_state;
+    std::vector<Object> m_objects;
+};
+
+static const TrackerScenario::Params g_tracker_scenarios[] = {
+    {1, 300, 30, 0},
+    {3, 300, 20, 3},
+    {4, 300, 60, 0},
+    {5, 300, 40, 2},
+};
+
+/// @brief Classic API step: track dets, or predict when there are none
+static inline void TrackFrame(bytetracker_t tracker, bool detect, const std::vector<track_object_t>& dets, bytetrack_object_t& objs) {
+    if (!detect) {
+        bytetracker_predict(tracker, &objs);
+        return;
+    }
+    objs.n_objects = (int)dets.size();
+    for (size_t i = 0; i < dets.size(); i++)
+        objs.objects[i] = dets[i];
+    bytetracker_track(tracker, &objs);
+}
@@ -1,7 +1,11 @@
 #pragma once
 
 #include "STrack.h"
+#include "GatedAssignment.h"
+#include "FeatureGallery.h"
+#include "Snapshot.h"
 #include "bytetrack.h"
+#include <utility>
 // struct rect_t
 // {
 // 	float x,y,width,height;
@@ -20,23 +24,54 @@ public:
 	BYTETracker(int frame_rate = 30, int track_buffer = 30);
 	~BYTETracker();
 
-	std::vector<STrack> update(track_object_t *objects, int len);
+	// Tracks stay in the tracker slots, the returned list is valid until the next update() / predict()
+	const std::vector<STrack *> &update(const track_object_t *objects, int len);
+	// Advance one frame without detections: Kalman-propagate the tracks, returns them like update()
+	const std::vector<STrack *> &predict();
+
+	int num_tracked() const;
+	int num_unconfirmed() const;
+	int num_lost() const;
+	// Removed tracks are not kept: a removed track leaves the lost list on the next frame and its slot is
+	// reused, so memory follows the peak of tracks held at once, never the uptime
+	int num_removed() const; // on the last frame
+	long long total_removed() const;
+	int num_slots() const;
+
+	void set_reid(const bytetrack_reid_t &reid);
+	// Camera motion since the last update() / predict(), before calling it: moves the tracked and lost tracks
+	// into the coordinates of the coming frame
+	void apply_motion(float scale, float tx, float ty);
+
+	// Tracks with their Kalman state and re-ID galleries, and the frame counter. load() replaces the state
+	// of the tracker, false when the data is short or inconsistent. user_data is not kept.
+	void save(SnapshotWriter &out) const;
+	bool load(SnapshotReader &in);
 
 private:
-	std::vector<STrack *> joint_stracks(std::vector<STrack *> &tlista, std::vector<STrack> &tlistb);
-	std::vector<STrack> joint_stracks(std::vector<STrack> &tlista, std::vector<STrack> &tlistb);
+	int new_slot(const STrack &track);
+	void release_slots();
+	const std::vector<STrack *> &output_stracks(const std::vector<int> &index);
 
-	std::vector<STrack> sub_stracks(std::vector<STrack> &tlista, std::vector<STrack> &tlistb);
-	void remove_duplicate_stracks(std::vector<STrack> &resa, std::vector<STrack> &resb, std::vector<STrack> &stracksa, std::vector<STrack> &stracksb);
+	// Track lists are slot indices and a track id lives in exactly one slot, so set operations
+	// stamp slots with a fresh generation instead of building id maps. Results go to res.
+	unsigned int next_stamp();
+	void joint_stracks(const std::vector<int> &tlista, const std::vector<int> &tlistb, std::vector<int> &res);
+	void sub_stracks(const std::vector<int> &tlista, const std::vector<int> &tlistb, std::vector<int> &res);
+	void sub_removed(const std::vector<int> &tlista, std::vector<int> &res);
+	void merge_by_id(const std::vector<int> &sorted, std::vector<int> &tlistb, std::vector<int> &res);
+	void remove_duplicate_stracks(std::vector<int> &resa, std::vector<int> &resb, const std::vector<int> &stracksa, const std::vector<int> &stracksb);
 
-	void linear_assignment(std::vector<std::vector<float>> &cost_matrix, int cost_matrix_size, int cost_matrix_size_size, float thresh,
-						   std::vector<std::vector<int>> &matches, std::vector<int> &unmatched_a, std::vector<int> &unmatched_b);
-	std::vector<std::vector<float>> iou_distance(std::vector<STrack *> &atracks, std::vector<STrack> &btracks, int &dist_size, int &dist_size_size);
-	std::vector<std::vector<float>> iou_distance(std::vector<STrack> &atracks, std::vector<STrack> &btracks);
-	std::vector<std::vector<float>> ious(std::vector<std::vector<float>> &atlbrs, std::vector<std::vector<float>> &btlbrs);
+	// Assignment of the pairs gated by the last iou_distance(), matches are (index in a, index in b)
+	void linear_assignment(float thresh, std::vector<std::pair<int, int>> &matches, std::vector<int> &unmatched_a, std::vector<int> &unmatched_b);
+	// 1 - IoU of a (indices into astore) against b (indices into bstore), only the pairs below max_cost
+	void iou_distance(const std::vector<STrack> &astore, const std::vector<int> &atracks, const std::vector<STrack> &bstore, const std::vector<int> &btracks, float max_cost);
 
-	double lapjv(const std::vector<std::vector<float>> &cost, std::vector<int> &rowsol, std::vector<int> &colsol,
-				 bool extend_cost = false, float cost_limit = LONG_MAX, bool return_cost = true);
+	// re-ID: feature of detection det, extracted on first use, nullptr when extraction failed
+	const float *det_feature(int det);
+	// lower the gated costs of ambiguous pairs by appearance, a indexes tracks, b detections
+	void fuse_appearance(const std::vector<int> &atracks, const std::vector<int> &bdets);
+	void update_gallery(int slot, int det);
 
 private:
 	float track_thresh;
@@ -45,8 +80,39 @@ private:
 	int frame_id;
 	int max_time_lost;
 
-	std::vector<STrack> tracked_stracks;
-	std::vector<STrack> lost_stracks;
-	std::vector<STrack> removed_stracks;
+	// persistent track storage, a slot is reused once its track left both lists
+	std::vector<STrack> tracks;
+	std::vector<char> slot_used;
+	std::vector<int> free_slots;
+	std::vector<unsigned int> slot_stamp;
+	unsigned int stamp_gen;
+	// the track was put on the removed list, it only matters while the track still holds its slot
+	std::vector<char> slot_removed;
+	long long removed_count;
+
+	std::vector<int> tracked_stracks;
+	std::vector<int> lost_stracks; // sorted by track id
 	byte_kalman::KalmanFilter kalman_filter;
+
+	// per frame scratch, kept for its capacity
+	std::vector<STrack> detections;
+	std::vector<int> det_high, det_low, det_remain;
+	std::vector<int> unconfirmed, activated_tracked, strack_pool, r_tracked_stracks;
+	std::vector<int> activated_stracks, refind_stracks, lost_new, removed_new;
+	std::vector<int> list_a, list_b;
+	std::vector<std::pair<int, int>> matches;
+	std::vector<int> u_track, u_detection, u_unconfirmed;
+	std::vector<std::pair<int, int>> dup_pairs;
+	std::vector<char> dupa, dupb;
+	std::vector<STrack *> outputs;
+
+	bytetrack_reid_t reid;
+	FeatureGallery gallery; // by slot
+	std::vector<float> det_features;
+	std::vector<signed char> det_feature_state; // 0: not extracted, 1: done, -1: failed
+	std::vector<int> deg_a, deg_b;
+
+	// tlbr of the lists given to iou_distance
+	std::vector<float> box_a, box_b;
+	GatedAssignment assignment;
 };
\ No newline at end of file
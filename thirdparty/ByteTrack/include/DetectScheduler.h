@@ -0,0 +1,40 @@
+#pragma once
+
+#include "bytetrack.h"
+
+// Tracker state after one frame, the cues the scheduler adapts on
+struct ScheduleStats
+{
+	float max_speed; // fastest activated track, box heights per frame
+	int num_tracks;
+	int num_unconfirmed;
+	int num_lost;
+};
+
+// Decides per frame whether to run the detector or only propagate the tracks with predict().
+// The interval between detections halves on new, lost or fast tracks, and grows by one frame
+// on calm scenes or when the npu is overloaded.
+class DetectScheduler
+{
+public:
+	DetectScheduler();
+	~DetectScheduler();
+
+	void set_config(const bytetrack_schedule_t &config);
+	void set_npu_load(float load);
+
+	bool need_detect() const;
+	void on_detect(const ScheduleStats &stats);
+	void on_predict(const ScheduleStats &stats);
+	int interval() const;
+
+private:
+	bytetrack_schedule_t config;
+	int m_interval;
+	int frames_since_detect;
+	float drift;
+	float max_speed;
+	bool force;
+	float npu_load;
+	int last_tracks;
+};
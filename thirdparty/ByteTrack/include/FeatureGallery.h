@@ -0,0 +1,37 @@
+#pragma once
+
+#include <vector>
+
+// Appearance features of the tracks, a ring of the last size features per tracker slot, all in one
+// contiguous buffer: slot s, entry k starts at (s * size + k) * dim. Features are stored l2 normalised.
+class FeatureGallery
+{
+public:
+	FeatureGallery();
+
+	void configure(int dim, int size);
+	int feature_dim() const;
+	void resize(int slots);
+	void clear(int slot);
+
+	// feature is l2 normalised, see normalize()
+	void push(int slot, const float *feature, int frame_id);
+	int count(int slot) const;
+	int last_frame(int slot) const;
+	// entry k of slot, oldest first, k < count(slot)
+	const float *feature(int slot, int k) const;
+
+	// smallest (1 - cos) / 2 over the features of slot, in [0, 1]; feature normalised. 1 when empty
+	float distance(int slot, const float *feature) const;
+
+	static float dot(const float *a, const float *b, int dim);
+	static void normalize(float *feature, int dim);
+
+private:
+	int dim;
+	int size;
+	std::vector<float> features;
+	std::vector<int> counts;
+	std::vector<int> heads;
+	std::vector<int> frames;
+};
\ No newline at end of file
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <utility>
+#include <vector>
+
+// Linear assignment on 1 - IoU costs without the dense rows x cols matrix: candidate pairs are the
+// boxes that overlap, found through a grid over the b boxes, the candidate graph splits into connected
+// components and every component is solved alone. The work follows the local crowding, not the
+// number of tracks times detections. Buffers are kept for their capacity between calls.
+class GatedAssignment
+{
+public:
+	struct Edge
+	{
+		int row;
+		int col;
+		float cost;
+	};
+
+	GatedAssignment();
+
+	// boxa / boxb are tlbr, 4 floats per box. Keeps the pairs with 1 - IoU below max_cost
+	void gate(const float *boxa, int na, const float *boxb, int nb, float max_cost);
+	const std::vector<Edge> &get_edges() const;
+	// costs may be changed before solve(), edges at or above its thresh drop out
+	std::vector<Edge> &get_edges();
+
+	// Same optimum as lapjv on the dense matrix extended with cost_limit thresh: a pair is matched when
+	// its cost beats leaving its row and column unmatched at thresh / 2 each. Lists are in index order.
+	void solve(float thresh, std::vector<std::pair<int, int>> &matches, std::vector<int> &unmatched_a, std::vector<int> &unmatched_b);
+
+private:
+	int find(int node);
+	void solve_component(const Edge *edges, int num_edges, const int *rows, int nr, const int *cols, int nc, float thresh);
+
+	int num_a;
+	int num_b;
+	std::vector<Edge> edges;
+
+	// grid over the b boxes, cell_start / cell_items in CSR layout
+	std::vector<int> cell_start, cell_items;
+	std::vector<int> b_stamp;
+
+	// components: union-find over rows then columns, members and edges grouped per component
+	std::vector<int> parent;
+	std::vector<int> comp_id;
+	std::vector<int> comp_row_start, comp_rows, comp_col_start, comp_cols, comp_edge_start, comp_fill;
+	std::vector<Edge> comp_edges;
+	std::vector<int> local;
+	std::vector<int> row_match, col_match;
+
+	// lapjv of one component, (nr + nc) square
+	std::vector<float> lap_cost;
+	std::vector<float *> lap_rows;
+	std::vector<int> lap_x, lap_y;
+	std::vector<char> lap_work;
+};
\ No newline at end of file
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Global camera motion between frames as x' = scale * x + tx, y' = scale * y + ty: pan, tilt and zoom.
+// push() only hands the luma plane to a background thread that area-downscales it, block matches it against
+// the previous frame and fits the motion, overlapping the detector on that frame. The plane is read until
+// take() returns.
+class MotionEstimator
+{
+public:
+	struct Motion
+	{
+		float scale;
+		float tx;
+		float ty;
+		bool valid; // false: identity, no frame before or too few blocks agreeing on a motion
+	};
+
+	explicit MotionEstimator(int work_width = 320);
+	~MotionEstimator();
+
+	// waits for the estimate of the previous push() when it was not taken yet
+	void push(const unsigned char *luma, int width, int height, int stride);
+	// Motion of the frames pushed since the last take(), composed, in full resolution pixels. Waits for
+	// the estimate still running. Identity when nothing was pushed in between.
+	Motion take();
+
+	static Motion identity();
+	// first a, then b
+	static Motion compose(const Motion &a, const Motion &b);
+
+private:
+	struct Plane
+	{
+		std::vector<unsigned char> data;
+		int width = 0;
+		int height = 0;
+	};
+
+	void worker();
+	Motion estimate();
+	bool match_block(int bx, int by, float &dx, float &dy);
+	static void downscale(const unsigned char *src, int width, int height, int stride, int factor, Plane &dst, std::vector<unsigned int> &row_sum);
+	static void halve(const Plane &src, Plane &dst);
+
+	int work_width;
+	int factor; // full resolution pixels per work pixel
+	int full_width, full_height;
+
+	// [0] at work resolution, [1] half of it; prev is the frame pushed before cur
+	Plane cur[2], prev[2];
+	bool has_prev;
+	const unsigned char *luma; // pushed, not downscaled yet
+	int stride;
+	std::vector<unsigned int> row_sum;
+
+	// block centres in prev and where they went in cur, work pixels
+	std::vector<float> px, py, qx, qy;
+	std::vector<char> inlier, best_inlier;
+
+	std::mutex lock;
+	std::condition_variable cv;
+	bool pending; // luma waits for the worker
+	bool stop;
+	Motion motion; // composed since the last take()
+	std::thread thread;
+};
\ No newline at end of file
@@ -11,44 +11,45 @@ enum TrackState
 	Removed
 };
 
+// Plain track record: fixed size boxes and the Kalman state, stored in the tracker slots
+// and referenced by index, the filter itself is shared through BYTETracker
 class STrack
 {
 public:
-	STrack(std::vector<float> tlwh_, float score, void *user_data);
+	STrack();
+	STrack(const float *tlwh_, float score, void *user_data);
 	~STrack();
 
-	std::vector<float> static tlbr_to_tlwh(std::vector<float> &tlbr);
-	void static multi_predict(std::vector<STrack *> &stracks, byte_kalman::KalmanFilter &kalman_filter);
+	void static tlbr_to_tlwh(const float *tlbr, float *tlwh);
+	void static tlwh_to_xyah(const float *tlwh, float *xyah);
+	void static multi_predict(std::vector<STrack> &stracks, const std::vector<int> &index, byte_kalman::KalmanFilter &kalman_filter);
 	void static_tlwh();
 	void static_tlbr();
-	std::vector<float> tlwh_to_xyah(std::vector<float> tlwh_tmp);
-	std::vector<float> to_xyah();
 	void mark_lost();
 	void mark_removed();
 	int next_id();
-	int end_frame();
+	// the id counter shared by every tracker, reserve_ids() moves it to at least id
+	static int last_id();
+	static void reserve_ids(int id);
+	int end_frame() const;
 
 	void activate(byte_kalman::KalmanFilter &kalman_filter, int frame_id);
-	void re_activate(STrack &new_track, int frame_id, bool new_id = false);
-	void update(STrack &new_track, int frame_id);
+	void re_activate(byte_kalman::KalmanFilter &kalman_filter, const STrack &new_track, int frame_id, bool new_id = false);
+	void update(byte_kalman::KalmanFilter &kalman_filter, const STrack &new_track, int frame_id);
 
 public:
 	bool is_activated;
 	int track_id;
 	int state;
 
-	std::vector<float> _tlwh;
-	std::vector<float> tlwh;
-	std::vector<float> tlbr;
+	float _tlwh[4];
+	float tlwh[4];
+	float tlbr[4];
 	int frame_id;
 	int tracklet_len;
 	int start_frame;
 
-	KAL_MEAN mean;
-	KAL_COVA covariance;
+	byte_kalman::KalmanState kalman;
 	float score;
 	void *user_data = nullptr;
-
-private:
-	byte_kalman::KalmanFilter kalman_filter;
 };
\ No newline at end of file
@@ -0,0 +1,10 @@
+#pragma once
+
+// 4 lane float SIMD of the target, the kernels keep a scalar path for the rest
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define BYTETRACK_SIMD_NEON
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define BYTETRACK_SIMD_SSE2
+#endif
\ No newline at end of file
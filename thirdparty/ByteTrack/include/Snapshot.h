@@ -0,0 +1,89 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// payload of bytetracker_snapshot(), bump the version on any layout change
+#define BYTETRACK_SNAPSHOT_MAGIC 0x53535442u // "BTSS"
+#define BYTETRACK_SNAPSHOT_VERSION 1u
+
+// Fixed size fields appended in host byte order, a snapshot is read back by the device that wrote it
+class SnapshotWriter
+{
+public:
+	explicit SnapshotWriter(std::vector<unsigned char> &buf) : buf(buf) {}
+
+	template <typename T>
+	void put(const T &value)
+	{
+		put_bytes(&value, sizeof(T));
+	}
+	void put_bytes(const void *data, size_t size)
+	{
+		const unsigned char *p = (const unsigned char *)data;
+		buf.insert(buf.end(), p, p + size);
+	}
+
+private:
+	std::vector<unsigned char> &buf;
+};
+
+// Reads fields back in writing order, every get fails once the data ran short
+class SnapshotReader
+{
+public:
+	SnapshotReader(const unsigned char *data, size_t size) : cur(data), end(data + size) {}
+
+	template <typename T>
+	bool get(T &value)
+	{
+		return get_bytes(&value, sizeof(T));
+	}
+	bool get_bytes(void *data, size_t size)
+	{
+		if ((size_t)(end - cur) < size)
+		{
+			cur = end;
+			return false;
+		}
+		memcpy(data, cur, size);
+		cur += size;
+		return true;
+	}
+	bool done() const
+	{
+		return cur == end;
+	}
+
+private:
+	const unsigned char *cur;
+	const unsigned char *end;
+};
+
+// Snapshots in a memory mapped file, kept mapped between writes. The file has two slots written in
+// turn, each with a sequence number and a checksum over its payload, so a crash during a write
+// leaves the previous snapshot readable. Slots grow with the payload.
+class SnapshotFile
+{
+public:
+	SnapshotFile();
+	~SnapshotFile();
+
+	int write(const char *path, const unsigned char *data, size_t size);
+	// payload of the newest valid slot
+	static int read(const char *path, std::vector<unsigned char> &data);
+
+private:
+	int open_file(const char *path);
+	int grow(size_t slot_size);
+	void close_file();
+
+	std::string path;
+	int fd;
+	unsigned char *base;
+	size_t slot_size; // header included
+	uint64_t seq;	  // of the newest slot
+	int next_slot;
+};
\ No newline at end of file
@@ -0,0 +1,80 @@
+#pragma once
+
+#include "bytetrack.h"
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Owns the trackers of every channel and runs them on a pool of worker threads. Every channel is a
+// strand: its frames queue up, at most one worker runs the channel at a time and takes its frames in
+// submit order, so channels track in parallel while each one sees and delivers its frames in order.
+class TrackerService
+{
+public:
+	TrackerService(int num_workers, int frame_rate, int track_buffer, int max_pending,
+				   bytetrack_service_cb_t callback, void *user);
+	~TrackerService();
+
+	// objects == nullptr: a frame without detections, the tracks are only predicted
+	int submit(int channel, const track_object_t *objects, int n_objects, void *frame_user);
+	int need_detect(int channel);
+	// control calls run on the strand behind the frames queued before them. set_schedule and set_reid
+	// only queue, snapshot_file and restore_file wait for their turn and must not be called from the callback
+	int set_schedule(int channel, const bytetrack_schedule_t &schedule);
+	int set_reid(int channel, const bytetrack_reid_t &reid);
+	void get_health(int channel, bytetrack_health_t &health);
+	int snapshot_file(int channel, const char *path);
+	int restore_file(int channel, const char *path);
+	void flush();
+
+private:
+	// a frame to track, or a control call when control is set
+	struct Frame
+	{
+		std::vector<track_object_t> objects;
+		bool predict;
+		void *user;
+		std::function<int(bytetracker_t)> control;
+		int *result; // set with done when the caller waits for the control
+		bool *done;
+	};
+
+	struct Channel
+	{
+		int id;
+		bytetracker_t tracker;
+		std::deque<Frame> pending;
+		bool scheduled; // in ready or held by a worker
+		bytetrack_health_t health; // after the last delivered frame
+		int frames; // frames queued and not delivered yet
+		int need_detect; // scheduler after the last delivered frame
+		int interval;
+		int since_detect; // predict frames submitted since the last detect frame
+	};
+
+	Channel *get_channel(int channel);
+	int queue(Channel *ch, std::unique_lock<std::mutex> &guard);
+	int call(int channel, std::function<int(bytetracker_t)> control, bool wait);
+	void worker();
+
+	int frame_rate;
+	int track_buffer;
+	int max_pending;
+	bytetrack_service_cb_t callback;
+	void *user;
+
+	std::mutex lock;
+	std::condition_variable work_cv;
+	std::condition_variable idle_cv;
+	std::map<int, std::unique_ptr<Channel>> channels;
+	std::deque<Channel *> ready;
+	std::vector<std::vector<track_object_t>> spare; // object buffers of delivered frames
+	int in_flight; // submitted and not delivered yet
+	bool stop;
+	std::vector<std::thread> workers;
+};
\ No newline at end of file
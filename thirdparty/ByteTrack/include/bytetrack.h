@@ -19,6 +19,8 @@ extern "C"
         void *user_data;
     } track_object_t;
 
+    // Fixed size frame of the original API, tracks past TRACK_OBJETCS_MAX_SIZE are dropped.
+    // The *_span functions take any number of objects.
     typedef struct
     {
         track_object_t objects[TRACK_OBJETCS_MAX_SIZE];
@@ -28,12 +30,133 @@ extern "C"
         int n_track_objects;
     } bytetrack_object_t;
 
+    typedef struct
+    {
+        int min_interval;    // frames between two detections, 1: every frame
+        int max_interval;    // min_interval == max_interval: fixed interval
+        float motion_thresh; // track speed, box heights per frame, above which the scene is active
+        float drift_thresh;  // predicted travel since the last detection, box heights, that forces one
+        float load_high;     // npu load (0..1) above which the interval grows even on active scenes
+    } bytetrack_schedule_t;
+
+    // Optional re-ID stage, BoT-SORT style. On the first association a pair close by IoU takes the
+    // appearance cost instead when that is lower and the detection is inside the Mahalanobis gate of the
+    // track. Detection features are only extracted for ambiguous pairs (a track or detection with several
+    // candidates, or a lost track) and to keep the galleries of matched tracks fresh.
+    typedef int (*bytetrack_reid_extract_t)(void *user, const float *tlwh, void *user_data, float *feature);
+
+    typedef struct
+    {
+        int feature_dim;                  // 0: re-ID off
+        int gallery_size;                 // features kept per track
+        float appearance_thresh;          // (1 - cos) / 2 from which appearance is ignored
+        float proximity_thresh;           // 1 - IoU from which appearance is ignored
+        float gate_chi2;                  // squared Mahalanobis gate, 9.4877 is chi2 95% at 4 dof. <= 0: no gate
+        int refresh_interval;             // frames before a matched track takes a new feature when not ambiguous
+        bytetrack_reid_extract_t extract; // feature_dim floats of the detection at tlwh (user_data its object's), 0 on success
+        void *user;
+    } bytetrack_reid_t;
+
+    // Tracker health over every label tracker. Removed tracks are not retained, their records are reused
+    // from the next frame on, so num_slots is bounded by the peak of tracks held at once, not by uptime.
+    typedef struct
+    {
+        int num_tracked;        // activated tracks, the output of the last frame
+        int num_unconfirmed;
+        int num_lost;
+        int num_removed;        // removed on the last frame
+        long long total_removed;
+        int num_slots;          // track records allocated
+        long long frames;       // track / predict calls
+        float frame_us;         // wall time of the last call, waiting for the motion estimate included
+        float frame_us_avg;     // exponential average over about 32 calls
+        float frame_us_max;
+    } bytetrack_health_t;
+
     typedef void *bytetracker_t;
 
     bytetracker_t bytetracker_create(int frame_rate, int track_buffer);
     void bytetracker_release(bytetracker_t *ptracker);
     void bytetracker_track(bytetracker_t tracker, bytetrack_object_t *objs);
 
+    // Span API: n_objects detections in, up to max_tracks tracks written to tracks. Returns the number of
+    // tracks of the frame, when that is above max_tracks bytetracker_get_tracks() gets them all once the
+    // buffer is grown. objects is only read and may be in any label order.
+    int bytetracker_track_span(bytetracker_t tracker, const track_object_t *objects, int n_objects, track_object_t *tracks, int max_tracks);
+    int bytetracker_predict_span(bytetracker_t tracker, track_object_t *tracks, int max_tracks);
+    // tracks of the last track / predict call, same return
+    int bytetracker_get_tracks(bytetracker_t tracker, track_object_t *tracks, int max_tracks);
+
+    // Detect-every-N scheduling, one tracker per channel. Each frame:
+    // bytetracker_need_detect() ? detect + bytetracker_track() : bytetracker_predict()
+    // The default schedule detects every frame.
+    void bytetracker_set_schedule(bytetracker_t tracker, const bytetrack_schedule_t *schedule);
+    void bytetracker_set_npu_load(bytetracker_t tracker, float load);
+    int bytetracker_need_detect(bytetracker_t tracker);
+    int bytetracker_get_interval(bytetracker_t tracker);
+    // A frame without detections: fills track_objects with the Kalman predicted tracks, objects are ignored
+    void bytetracker_predict(bytetracker_t tracker, bytetrack_object_t *objs);
+
+    // every label tracker of the handle, present and future. extract runs on the thread that tracks
+    void bytetracker_set_reid(bytetracker_t tracker, const bytetrack_reid_t *reid);
+
+    // Optional camera motion compensation for moving and PTZ cameras: before association the tracks follow
+    // the global pan, tilt and zoom between frames. Push the luma plane (plane 0 of NV12) of every frame as
+    // soon as it arrives; the motion is estimated on a background thread while the detector runs, and the
+    // next track / predict call applies it. The plane is read until that call returns.
+    // work_width: the plane is box-downscaled to about this width for the estimate, <= 0: off
+    void bytetracker_set_gmc(bytetracker_t tracker, int work_width);
+    void bytetracker_push_frame(bytetracker_t tracker, const unsigned char *luma, int width, int height, int stride);
+    // motion known to the caller (PTZ feedback), x' = scale * x + tx, y' = scale * y + ty in frame pixels,
+    // applied by the next track / predict call after the estimated one
+    void bytetracker_apply_motion(bytetracker_t tracker, float scale, float tx, float ty);
+    // motion applied by the last track / predict call, returns 0 when that was none
+    int bytetracker_get_motion(bytetracker_t tracker, float *scale, float *tx, float *ty);
+
+    void bytetracker_get_health(bytetracker_t tracker, bytetrack_health_t *health);
+
+    // Snapshot of the whole tracker state (tracks with their Kalman state and re-ID galleries, frame counters,
+    // the track id counter) so a restarted pipeline keeps its ids. user_data of restored tracks is NULL.
+    // Returns the bytes of the snapshot, written to buf when size is enough.
+    int bytetracker_snapshot(bytetracker_t tracker, void *buf, int size);
+    // 0 on success, -1 when buf holds no snapshot of this version; the tracker is unchanged then
+    int bytetracker_restore(bytetracker_t tracker, const void *buf, int size);
+    // Periodic snapshots to a memory mapped file that stays mapped between calls. Its two slots are written
+    // in turn, so a crash during a write leaves the previous snapshot. 0 on success
+    int bytetracker_snapshot_file(bytetracker_t tracker, const char *path);
+    // restores the newest complete snapshot of the file, 0 on success
+    int bytetracker_restore_file(bytetracker_t tracker, const char *path);
+
+    // Tracker service: the trackers of all channels on one pool of worker threads, channels track in
+    // parallel. callback runs on a worker thread, per channel in submit order, tracks are valid during the call.
+    typedef void (*bytetrack_service_cb_t)(int channel, const track_object_t *tracks, int n_tracks, void *frame_user, void *user);
+    typedef void *bytetrack_service_t;
+
+    // num_workers <= 0: one per core. max_pending > 0: frames queued per channel before submit fails
+    bytetrack_service_t bytetrack_service_create(int num_workers, int frame_rate, int track_buffer, int max_pending,
+                                                 bytetrack_service_cb_t callback, void *user);
+    // delivers the frames still queued, then stops the workers
+    void bytetrack_service_release(bytetrack_service_t *pservice);
+    // objects are copied, NULL queues a frame without detections (bytetracker_predict). 0: queued, -1: queue full
+    int bytetrack_service_submit(bytetrack_service_t service, int channel, const track_object_t *objects, int n_objects, void *frame_user);
+    // bytetracker_need_detect for the next frame of the channel. Exact once the channel's frames are delivered,
+    // while frames are queued the predict frames submitted since the last detect frame count against the interval.
+    // 1 for a channel never submitted to
+    int bytetrack_service_need_detect(bytetrack_service_t service, int channel);
+    // Schedule and re-ID changes are queued on the channel and apply between the frames submitted before and
+    // after them, the calls return at once and may be made from the callback
+    void bytetrack_service_set_schedule(bytetrack_service_t service, int channel, const bytetrack_schedule_t *schedule);
+    // extract runs on the workers, at most one call per channel at a time
+    void bytetrack_service_set_reid(bytetrack_service_t service, int channel, const bytetrack_reid_t *reid);
+    // health of the channel after its last delivered frame, does not wait for the channel. Zero for a channel never submitted to
+    void bytetrack_service_get_health(bytetrack_service_t service, int channel, bytetrack_health_t *health);
+    // snapshot / restore of a channel once the frames submitted before are tracked, see bytetracker_snapshot_file.
+    // Blocks until then, must not be called from the callback
+    int bytetrack_service_snapshot_file(bytetrack_service_t service, int channel, const char *path);
+    int bytetrack_service_restore_file(bytetrack_service_t service, int channel, const char *path);
+    // blocks until every submitted frame is delivered
+    void bytetrack_service_flush(bytetrack_service_t service);
+
 #ifdef __cplusplus
 }
 #endif
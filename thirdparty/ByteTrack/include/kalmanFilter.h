@@ -4,6 +4,17 @@
 
 namespace byte_kalman
 {
+	// Track state for the batched filter. The constant velocity model only couples every xyah coordinate
+	// with its own velocity, so starting from the diagonal initiate() the 8x8 covariance stays 4 independent
+	// 2x2 blocks [pp pv; pv vv], one per coordinate, and a track is 4 lanes of the same scalar filter
+	struct KalmanState
+	{
+		alignas(16) float mean[8];	// x y a h, vx vy va vh
+		alignas(16) float pp[4];
+		alignas(16) float pv[4];
+		alignas(16) float vv[4];
+	};
+
 	class KalmanFilter
 	{
 	public:
@@ -22,6 +33,16 @@ namespace byte_kalman
 			const std::vector<DETECTBOX>& measurements,
 			bool only_position = false);
 
+		// Block filter on KalmanState, same model as above without the 8x8 products and the Cholesky solve
+		void initiate(const float *xyah, KalmanState &state);
+		void predict(KalmanState &state);
+		void update(KalmanState &state, const float *xyah);
+		// squared Mahalanobis distance of a measurement, the innovation covariance is diagonal here
+		float gating_distance(const KalmanState &state, const float *xyah);
+		// camera motion x' = scale * x + tx, y' = scale * y + ty. Without rotation x and y stay uncoupled,
+		// so the blocks keep their structure
+		void warp(KalmanState &state, float scale, float tx, float ty);
+
 	private:
 		Eigen::Matrix<float, 8, 8, Eigen::RowMajor> _motion_mat;
 		Eigen::Matrix<float, 4, 8, Eigen::RowMajor> _update_mat;
@@ -52,12 +52,16 @@
 
 typedef signed int int_t;
 typedef unsigned int uint_t;
-typedef double cost_t;
+typedef float cost_t;
 typedef char boolean;
 typedef enum fp_t { FP_1 = 1, FP_2 = 2, FP_DYNAMIC = 3 } fp_t;
 
+#include <stddef.h>
+
+// scratch of lapjv_internal for size n, callers solving many problems keep one buffer
+extern size_t lapjv_workspace_size(const uint_t n);
 extern int_t lapjv_internal(
 	const uint_t n, cost_t *cost[],
-	int_t *x, int_t *y);
+	int_t *x, int_t *y, void *workspace);
 
 #endif // LAPJV_H
\ No newline at end of file
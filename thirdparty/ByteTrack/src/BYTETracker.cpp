@@ -1,5 +1,7 @@
 #include "BYTETracker.h"
 #include <fstream>
+#include <cstring>
+#include <algorithm>
 
 BYTETracker::BYTETracker(int frame_rate, int track_buffer)
 {
@@ -9,6 +11,9 @@ BYTETracker::BYTETracker(int frame_rate, int track_buffer)
 
 	frame_id = 0;
 	max_time_lost = int(frame_rate / 30.0 * track_buffer);
+	stamp_gen = 0;
+	removed_count = 0;
+	memset(&reid, 0, sizeof(reid));
 	std::cout << "Init ByteTrack!" << std::endl;
 }
 
@@ -16,225 +21,587 @@ BYTETracker::~BYTETracker()
 {
 }
 
-std::vector<STrack> BYTETracker::update(track_object_t *objects, int len)
+const std::vector<STrack *> &BYTETracker::update(const track_object_t *objects, int len)
 {
 
 	////////////////// Step 1: Get detections //////////////////
 	this->frame_id++;
-	std::vector<STrack> activated_stracks;
-	std::vector<STrack> refind_stracks;
-	std::vector<STrack> removed_stracks;
-	std::vector<STrack> lost_stracks;
-	std::vector<STrack> detections;
-	std::vector<STrack> detections_low;
-
-	std::vector<STrack> detections_cp;
-	std::vector<STrack> tracked_stracks_swap;
-	std::vector<STrack> resa, resb;
-	std::vector<STrack> output_stracks;
-
-	std::vector<STrack *> unconfirmed;
-	std::vector<STrack *> tracked_stracks;
-	std::vector<STrack *> strack_pool;
-	std::vector<STrack *> r_tracked_stracks;
-
-	if (len > 0)
-	{
-		for (int i = 0; i < len; i++)
-		{
-			std::vector<float> tlbr_;
-			tlbr_.resize(4);
-			tlbr_[0] = objects[i].rect.x;
-			tlbr_[1] = objects[i].rect.y;
-			tlbr_[2] = objects[i].rect.x + objects[i].rect.width;
-			tlbr_[3] = objects[i].rect.y + objects[i].rect.height;
-
-			float score = objects[i].prob;
-
-			STrack strack(STrack::tlbr_to_tlwh(tlbr_), score, objects[i].user_data);
-			if (score >= track_thresh)
-			{
-				detections.push_back(strack);
-			}
-			else
-			{
-				detections_low.push_back(strack);
-			}
+	activated_stracks.clear();
+	refind_stracks.clear();
+	removed_new.clear();
+	lost_new.clear();
+
+	detections.clear();
+	det_high.clear();
+	det_low.clear();
+	det_remain.clear();
+
+	unconfirmed.clear();
+	activated_tracked.clear();
+	r_tracked_stracks.clear();
+
+	for (int i = 0; i < len; i++)
+	{
+		float tlbr_[4], tlwh_[4];
+		tlbr_[0] = objects[i].rect.x;
+		tlbr_[1] = objects[i].rect.y;
+		tlbr_[2] = objects[i].rect.x + objects[i].rect.width;
+		tlbr_[3] = objects[i].rect.y + objects[i].rect.height;
+		STrack::tlbr_to_tlwh(tlbr_, tlwh_);
+
+		float score = objects[i].prob;
+
+		detections.push_back(STrack(tlwh_, score, objects[i].user_data));
+		if (score >= track_thresh)
+		{
+			det_high.push_back(i);
+		}
+		else
+		{
+			det_low.push_back(i);
 		}
 	}
 
+	if (reid.feature_dim > 0)
+	{
+		det_feature_state.assign(len, 0);
+		det_features.resize((size_t)len * reid.feature_dim);
+	}
+
 	// Add newly detected tracklets to tracked_stracks
 	for (size_t i = 0; i < this->tracked_stracks.size(); i++)
 	{
-		if (!this->tracked_stracks[i].is_activated)
-			unconfirmed.push_back(&this->tracked_stracks[i]);
+		if (!tracks[this->tracked_stracks[i]].is_activated)
+			unconfirmed.push_back(this->tracked_stracks[i]);
 		else
-			tracked_stracks.push_back(&this->tracked_stracks[i]);
+			activated_tracked.push_back(this->tracked_stracks[i]);
 	}
 
 	////////////////// Step 2: First association, with IoU //////////////////
-	strack_pool = joint_stracks(tracked_stracks, this->lost_stracks);
-	STrack::multi_predict(strack_pool, this->kalman_filter);
-
-	std::vector<std::vector<float>> dists;
-	int dist_size = 0, dist_size_size = 0;
-	dists = iou_distance(strack_pool, detections, dist_size, dist_size_size);
+	joint_stracks(activated_tracked, this->lost_stracks, strack_pool);
+	STrack::multi_predict(tracks, strack_pool, this->kalman_filter);
 
-	std::vector<std::vector<int>> matches;
-	std::vector<int> u_track, u_detection;
-	linear_assignment(dists, dist_size, dist_size_size, match_thresh, matches, u_track, u_detection);
+	iou_distance(tracks, strack_pool, detections, det_high, match_thresh);
+	if (reid.feature_dim > 0)
+		fuse_appearance(strack_pool, det_high);
+	linear_assignment(match_thresh, matches, u_track, u_detection);
 
 	for (size_t i = 0; i < matches.size(); i++)
 	{
-		STrack *track = strack_pool[matches[i][0]];
-		STrack *det = &detections[matches[i][1]];
-		if (track->state == TrackState::Tracked)
+		int slot = strack_pool[matches[i].first];
+		STrack &track = tracks[slot];
+		const STrack &det = detections[det_high[matches[i].second]];
+		if (track.state == TrackState::Tracked)
 		{
-			track->update(*det, this->frame_id);
-			activated_stracks.push_back(*track);
+			track.update(this->kalman_filter, det, this->frame_id);
+			activated_stracks.push_back(slot);
 		}
 		else
 		{
-			track->re_activate(*det, this->frame_id, false);
-			refind_stracks.push_back(*track);
+			track.re_activate(this->kalman_filter, det, this->frame_id, false);
+			refind_stracks.push_back(slot);
 		}
+		update_gallery(slot, det_high[matches[i].second]);
 	}
 
 	////////////////// Step 3: Second association, using low score dets //////////////////
 	for (size_t i = 0; i < u_detection.size(); i++)
 	{
-		detections_cp.push_back(detections[u_detection[i]]);
+		det_remain.push_back(det_high[u_detection[i]]);
 	}
-	detections.clear();
-	detections.assign(detections_low.begin(), detections_low.end());
 
 	for (size_t i = 0; i < u_track.size(); i++)
 	{
-		if (strack_pool[u_track[i]]->state == TrackState::Tracked)
+		if (tracks[strack_pool[u_track[i]]].state == TrackState::Tracked)
 		{
 			r_tracked_stracks.push_back(strack_pool[u_track[i]]);
 		}
 	}
 
-	dists.clear();
-	dists = iou_distance(r_tracked_stracks, detections, dist_size, dist_size_size);
-
-	matches.clear();
-	u_track.clear();
-	u_detection.clear();
-	linear_assignment(dists, dist_size, dist_size_size, 0.5, matches, u_track, u_detection);
+	iou_distance(tracks, r_tracked_stracks, detections, det_low, 0.5);
+	linear_assignment(0.5, matches, u_track, u_detection);
 
 	for (size_t i = 0; i < matches.size(); i++)
 	{
-		STrack *track = r_tracked_stracks[matches[i][0]];
-		STrack *det = &detections[matches[i][1]];
-		if (track->state == TrackState::Tracked)
+		int slot = r_tracked_stracks[matches[i].first];
+		STrack &track = tracks[slot];
+		const STrack &det = detections[det_low[matches[i].second]];
+		if (track.state == TrackState::Tracked)
 		{
-			track->update(*det, this->frame_id);
-			activated_stracks.push_back(*track);
+			track.update(this->kalman_filter, det, this->frame_id);
+			activated_stracks.push_back(slot);
 		}
 		else
 		{
-			track->re_activate(*det, this->frame_id, false);
-			refind_stracks.push_back(*track);
+			track.re_activate(this->kalman_filter, det, this->frame_id, false);
+			refind_stracks.push_back(slot);
 		}
+		update_gallery(slot, det_low[matches[i].second]);
 	}
 
 	for (size_t i = 0; i < u_track.size(); i++)
 	{
-		STrack *track = r_tracked_stracks[u_track[i]];
-		if (track->state != TrackState::Lost)
+		int slot = r_tracked_stracks[u_track[i]];
+		if (tracks[slot].state != TrackState::Lost)
 		{
-			track->mark_lost();
-			lost_stracks.push_back(*track);
+			tracks[slot].mark_lost();
+			lost_new.push_back(slot);
 		}
 	}
 
 	// Deal with unconfirmed tracks, usually tracks with only one beginning frame
-	detections.clear();
-	detections.assign(detections_cp.begin(), detections_cp.end());
-
-	dists.clear();
-	dists = iou_distance(unconfirmed, detections, dist_size, dist_size_size);
-
-	matches.clear();
-	std::vector<int> u_unconfirmed;
-	u_detection.clear();
-	linear_assignment(dists, dist_size, dist_size_size, 0.7, matches, u_unconfirmed, u_detection);
+	iou_distance(tracks, unconfirmed, detections, det_remain, 0.7);
+	linear_assignment(0.7, matches, u_unconfirmed, u_detection);
 
 	for (size_t i = 0; i < matches.size(); i++)
 	{
-		unconfirmed[matches[i][0]]->update(detections[matches[i][1]], this->frame_id);
-		activated_stracks.push_back(*unconfirmed[matches[i][0]]);
+		int slot = unconfirmed[matches[i].first];
+		tracks[slot].update(this->kalman_filter, detections[det_remain[matches[i].second]], this->frame_id);
+		activated_stracks.push_back(slot);
+		update_gallery(slot, det_remain[matches[i].second]);
 	}
 
 	for (size_t i = 0; i < u_unconfirmed.size(); i++)
 	{
-		STrack *track = unconfirmed[u_unconfirmed[i]];
-		track->mark_removed();
-		removed_stracks.push_back(*track);
+		int slot = unconfirmed[u_unconfirmed[i]];
+		tracks[slot].mark_removed();
+		removed_new.push_back(slot);
 	}
 
 	////////////////// Step 4: Init new stracks //////////////////
 	for (size_t i = 0; i < u_detection.size(); i++)
 	{
-		STrack *track = &detections[u_detection[i]];
-		if (track->score < this->high_thresh)
+		STrack &track = detections[det_remain[u_detection[i]]];
+		if (track.score < this->high_thresh)
 			continue;
-		track->activate(this->kalman_filter, this->frame_id);
-		activated_stracks.push_back(*track);
+		track.activate(this->kalman_filter, this->frame_id);
+		int slot = new_slot(track);
+		activated_stracks.push_back(slot);
+		update_gallery(slot, det_remain[u_detection[i]]);
 	}
 
 	////////////////// Step 5: Update state //////////////////
 	for (size_t i = 0; i < this->lost_stracks.size(); i++)
 	{
-		if (this->frame_id - this->lost_stracks[i].end_frame() > this->max_time_lost)
+		// a track timed out on the last frame is still listed here, it is removed already
+		if (slot_removed[this->lost_stracks[i]])
+			continue;
+		STrack &track = tracks[this->lost_stracks[i]];
+		if (this->frame_id - track.end_frame() > this->max_time_lost)
 		{
-			this->lost_stracks[i].mark_removed();
-			removed_stracks.push_back(this->lost_stracks[i]);
+			track.mark_removed();
+			removed_new.push_back(this->lost_stracks[i]);
 		}
 	}
 
+	list_a.clear();
 	for (size_t i = 0; i < this->tracked_stracks.size(); i++)
 	{
-		if (this->tracked_stracks[i].state == TrackState::Tracked)
+		if (tracks[this->tracked_stracks[i]].state == TrackState::Tracked)
 		{
-			tracked_stracks_swap.push_back(this->tracked_stracks[i]);
+			list_a.push_back(this->tracked_stracks[i]);
 		}
 	}
-	this->tracked_stracks.clear();
-	this->tracked_stracks.assign(tracked_stracks_swap.begin(), tracked_stracks_swap.end());
 
-	this->tracked_stracks = joint_stracks(this->tracked_stracks, activated_stracks);
-	this->tracked_stracks = joint_stracks(this->tracked_stracks, refind_stracks);
+	joint_stracks(list_a, activated_stracks, list_b);
+	joint_stracks(list_b, refind_stracks, this->tracked_stracks);
+
+	sub_stracks(this->lost_stracks, this->tracked_stracks, list_a);
+	merge_by_id(list_a, lost_new, list_b);
+
+	// removed on this frame only leave the lost list on the next one
+	sub_removed(list_b, this->lost_stracks);
+	for (size_t i = 0; i < removed_new.size(); i++)
+	{
+		slot_removed[removed_new[i]] = 1;
+	}
+	removed_count += removed_new.size();
+
+	remove_duplicate_stracks(list_a, list_b, this->tracked_stracks, this->lost_stracks);
+	this->tracked_stracks.swap(list_a);
+	this->lost_stracks.swap(list_b);
 
-	// std::std::cout << activated_stracks.size() << std::endl;
+	release_slots();
 
-	this->lost_stracks = sub_stracks(this->lost_stracks, this->tracked_stracks);
-	for (size_t i = 0; i < lost_stracks.size(); i++)
+	list_a.clear();
+	for (size_t i = 0; i < this->tracked_stracks.size(); i++)
 	{
-		this->lost_stracks.push_back(lost_stracks[i]);
+		if (tracks[this->tracked_stracks[i]].is_activated)
+		{
+			list_a.push_back(this->tracked_stracks[i]);
+		}
 	}
+	return output_stracks(list_a);
+}
+
+const std::vector<STrack *> &BYTETracker::predict()
+{
+	this->frame_id++;
+	removed_new.clear();
 
-	this->lost_stracks = sub_stracks(this->lost_stracks, this->removed_stracks);
-	for (size_t i = 0; i < removed_stracks.size(); i++)
+	// Same pool as the first association of update(), lost tracks keep ageing through frame_id
+	activated_tracked.clear();
+	for (size_t i = 0; i < this->tracked_stracks.size(); i++)
 	{
-		this->removed_stracks.push_back(removed_stracks[i]);
+		if (tracks[this->tracked_stracks[i]].is_activated)
+			activated_tracked.push_back(this->tracked_stracks[i]);
 	}
+	joint_stracks(activated_tracked, this->lost_stracks, strack_pool);
+	STrack::multi_predict(tracks, strack_pool, this->kalman_filter);
 
-	remove_duplicate_stracks(resa, resb, this->tracked_stracks, this->lost_stracks);
+	return output_stracks(activated_tracked);
+}
 
-	this->tracked_stracks.clear();
-	this->tracked_stracks.assign(resa.begin(), resa.end());
-	this->lost_stracks.clear();
-	this->lost_stracks.assign(resb.begin(), resb.end());
+int BYTETracker::num_tracked() const
+{
+	return (int)this->tracked_stracks.size() - num_unconfirmed();
+}
 
+int BYTETracker::num_unconfirmed() const
+{
+	int num = 0;
 	for (size_t i = 0; i < this->tracked_stracks.size(); i++)
 	{
-		if (this->tracked_stracks[i].is_activated)
+		if (!tracks[this->tracked_stracks[i]].is_activated)
+			num++;
+	}
+	return num;
+}
+
+int BYTETracker::num_lost() const
+{
+	return (int)this->lost_stracks.size();
+}
+
+int BYTETracker::num_removed() const
+{
+	return (int)removed_new.size();
+}
+
+long long BYTETracker::total_removed() const
+{
+	return removed_count;
+}
+
+int BYTETracker::num_slots() const
+{
+	return (int)tracks.size();
+}
+
+void BYTETracker::apply_motion(float scale, float tx, float ty)
+{
+	for (int k = 0; k < 2; k++)
+	{
+		const std::vector<int> &list = k == 0 ? this->tracked_stracks : this->lost_stracks;
+		for (size_t i = 0; i < list.size(); i++)
+		{
+			STrack &track = tracks[list[i]];
+			kalman_filter.warp(track.kalman, scale, tx, ty);
+			track.static_tlwh();
+			track.static_tlbr();
+		}
+	}
+}
+
+// one track of a snapshot, 4 byte fields only so the layout has no padding
+struct SnapshotTrack
+{
+	int32_t track_id;
+	int32_t state;
+	int32_t is_activated;
+	int32_t frame_id;
+	int32_t tracklet_len;
+	int32_t start_frame;
+	int32_t removed;
+	float score;
+	float tlwh[4];
+	float mean[8];
+	float pp[4];
+	float pv[4];
+	float vv[4];
+};
+
+void BYTETracker::save(SnapshotWriter &out) const
+{
+	// every listed slot once, the lists as indices into them
+	std::vector<int> record(tracks.size(), -1);
+	std::vector<int> slots;
+	for (int k = 0; k < 2; k++)
+	{
+		const std::vector<int> &list = k == 0 ? this->tracked_stracks : this->lost_stracks;
+		for (size_t i = 0; i < list.size(); i++)
 		{
-			output_stracks.push_back(this->tracked_stracks[i]);
+			if (record[list[i]] < 0)
+			{
+				record[list[i]] = (int)slots.size();
+				slots.push_back(list[i]);
+			}
 		}
 	}
-	return output_stracks;
+
+	out.put<int32_t>(this->frame_id);
+	out.put<int32_t>((int32_t)slots.size());
+	for (size_t i = 0; i < slots.size(); i++)
+	{
+		const STrack &track = tracks[slots[i]];
+		SnapshotTrack rec;
+		rec.track_id = track.track_id;
+		rec.state = track.state;
+		rec.is_activated = track.is_activated ? 1 : 0;
+		rec.frame_id = track.frame_id;
+		rec.tracklet_len = track.tracklet_len;
+		rec.start_frame = track.start_frame;
+		rec.removed = slot_removed[slots[i]];
+		rec.score = track.score;
+		memcpy(rec.tlwh, track._tlwh, sizeof(rec.tlwh));
+		memcpy(rec.mean, track.kalman.mean, sizeof(rec.mean));
+		memcpy(rec.pp, track.kalman.pp, sizeof(rec.pp));
+		memcpy(rec.pv, track.kalman.pv, sizeof(rec.pv));
+		memcpy(rec.vv, track.kalman.vv, sizeof(rec.vv));
+		out.put(rec);
+	}
+	for (int k = 0; k < 2; k++)
+	{
+		const std::vector<int> &list = k == 0 ? this->tracked_stracks : this->lost_stracks;
+		out.put<int32_t>((int32_t)list.size());
+		for (size_t i = 0; i < list.size(); i++)
+			out.put<int32_t>(record[list[i]]);
+	}
+
+	// re-ID galleries, oldest feature first
+	const int dim = gallery.feature_dim();
+	out.put<int32_t>(dim);
+	for (size_t i = 0; i < slots.size() && dim > 0; i++)
+	{
+		int count = gallery.count(slots[i]);
+		out.put<int32_t>(count);
+		out.put<int32_t>(gallery.last_frame(slots[i]));
+		for (int k = 0; k < count; k++)
+			out.put_bytes(gallery.feature(slots[i], k), dim * sizeof(float));
+	}
+}
+
+bool BYTETracker::load(SnapshotReader &in)
+{
+	int32_t frame, n;
+	if (!in.get(frame) || !in.get(n) || n < 0)
+		return false;
+
+	std::vector<STrack> store(n);
+	std::vector<char> removed(n);
+	for (int i = 0; i < n; i++)
+	{
+		SnapshotTrack rec;
+		if (!in.get(rec))
+			return false;
+		STrack &track = store[i];
+		track.track_id = rec.track_id;
+		track.state = rec.state;
+		track.is_activated = rec.is_activated != 0;
+		track.frame_id = rec.frame_id;
+		track.tracklet_len = rec.tracklet_len;
+		track.start_frame = rec.start_frame;
+		track.score = rec.score;
+		memcpy(track._tlwh, rec.tlwh, sizeof(rec.tlwh));
+		memcpy(track.kalman.mean, rec.mean, sizeof(rec.mean));
+		memcpy(track.kalman.pp, rec.pp, sizeof(rec.pp));
+		memcpy(track.kalman.pv, rec.pv, sizeof(rec.pv));
+		memcpy(track.kalman.vv, rec.vv, sizeof(rec.vv));
+		track.user_data = nullptr;
+		track.static_tlwh();
+		track.static_tlbr();
+		removed[i] = rec.removed != 0;
+	}
+
+	std::vector<int> lists[2];
+	for (int k = 0; k < 2; k++)
+	{
+		int32_t m;
+		if (!in.get(m) || m < 0 || m > n)
+			return false;
+		lists[k].resize(m);
+		for (int i = 0; i < m; i++)
+		{
+			int32_t r;
+			if (!in.get(r) || r < 0 || r >= n)
+				return false;
+			lists[k][i] = r;
+		}
+	}
+
+	// galleries of another feature size are read past and dropped
+	int32_t dim;
+	if (!in.get(dim) || dim < 0)
+		return false;
+	std::vector<int> counts, last_frames;
+	std::vector<float> features;
+	for (int i = 0; i < n && dim > 0; i++)
+	{
+		int32_t count, last;
+		if (!in.get(count) || !in.get(last) || count < 0)
+			return false;
+		counts.push_back(count);
+		last_frames.push_back(last);
+		size_t begin = features.size();
+		features.resize(begin + (size_t)count * dim);
+		if (!in.get_bytes(&features[begin], (size_t)count * dim * sizeof(float)))
+			return false;
+	}
+
+	this->frame_id = frame;
+	tracks.swap(store);
+	slot_used.assign(n, 1);
+	slot_stamp.assign(n, 0);
+	slot_removed.swap(removed);
+	free_slots.clear();
+	this->tracked_stracks.swap(lists[0]);
+	this->lost_stracks.swap(lists[1]);
+
+	gallery.resize(n);
+	const float *feature = features.data();
+	for (int i = 0; i < n; i++)
+	{
+		gallery.clear(i);
+		if (dim == 0)
+			continue;
+		for (int k = 0; k < counts[i]; k++, feature += dim)
+		{
+			if (dim == gallery.feature_dim())
+				gallery.push(i, feature, last_frames[i]);
+		}
+	}
+	return true;
+}
+
+void BYTETracker::set_reid(const bytetrack_reid_t &reid)
+{
+	this->reid = reid;
+	if (!reid.extract)
+		this->reid.feature_dim = 0;
+	gallery.configure(this->reid.feature_dim, reid.gallery_size);
+	gallery.resize((int)tracks.size());
+}
+
+const float *BYTETracker::det_feature(int det)
+{
+	float *feature = &det_features[(size_t)det * reid.feature_dim];
+	if (det_feature_state[det] == 0)
+	{
+		const STrack &d = detections[det];
+		det_feature_state[det] = reid.extract(reid.user, d._tlwh, d.user_data, feature) == 0 ? 1 : -1;
+		if (det_feature_state[det] > 0)
+			FeatureGallery::normalize(feature, reid.feature_dim);
+	}
+	return det_feature_state[det] > 0 ? feature : nullptr;
+}
+
+// BoT-SORT fusion: min(IoU cost, appearance cost) for pairs close by IoU whose appearance is similar.
+// Only pairs with a choice pay for the extraction, a lone pair matches on IoU anyway.
+void BYTETracker::fuse_appearance(const std::vector<int> &atracks, const std::vector<int> &bdets)
+{
+	std::vector<GatedAssignment::Edge> &edges = assignment.get_edges();
+	deg_a.assign(atracks.size(), 0);
+	deg_b.assign(bdets.size(), 0);
+	for (size_t k = 0; k < edges.size(); k++)
+	{
+		deg_a[edges[k].row]++;
+		deg_b[edges[k].col]++;
+	}
+
+	for (size_t k = 0; k < edges.size(); k++)
+	{
+		GatedAssignment::Edge &e = edges[k];
+		int slot = atracks[e.row];
+		const STrack &track = tracks[slot];
+		if (e.cost >= reid.proximity_thresh || gallery.count(slot) == 0)
+			continue;
+		if (deg_a[e.row] < 2 && deg_b[e.col] < 2 && track.state != TrackState::Lost)
+			continue;
+
+		int det = bdets[e.col];
+		if (reid.gate_chi2 > 0)
+		{
+			float xyah[4];
+			STrack::tlwh_to_xyah(detections[det].tlwh, xyah);
+			if (kalman_filter.gating_distance(track.kalman, xyah) > reid.gate_chi2)
+				continue;
+		}
+
+		const float *feature = det_feature(det);
+		if (!feature)
+			continue;
+		float cost = gallery.distance(slot, feature);
+		if (cost < reid.appearance_thresh)
+			e.cost = std::min(e.cost, cost);
+	}
+}
+
+// the feature extracted for an ambiguous pair is kept, otherwise only a track without one or past
+// refresh_interval extracts
+void BYTETracker::update_gallery(int slot, int det)
+{
+	if (reid.feature_dim <= 0)
+		return;
+	if (det_feature_state[det] == 0 && gallery.count(slot) > 0 && this->frame_id - gallery.last_frame(slot) < reid.refresh_interval)
+		return;
+
+	const float *feature = det_feature(det);
+	if (feature)
+		gallery.push(slot, feature, this->frame_id);
+}
+
+int BYTETracker::new_slot(const STrack &track)
+{
+	int slot;
+	if (!free_slots.empty())
+	{
+		slot = free_slots.back();
+		free_slots.pop_back();
+		tracks[slot] = track;
+	}
+	else
+	{
+		slot = (int)tracks.size();
+		tracks.push_back(track);
+		slot_used.push_back(0);
+		slot_stamp.push_back(0);
+		slot_removed.push_back(0);
+	}
+	slot_used[slot] = 1;
+	slot_removed[slot] = 0;
+	gallery.resize((int)tracks.size());
+	gallery.clear(slot);
+	return slot;
+}
+
+void BYTETracker::release_slots()
+{
+	// 2: still listed, 1: in use but dropped from both lists
+	for (size_t i = 0; i < this->tracked_stracks.size(); i++)
+		slot_used[this->tracked_stracks[i]] = 2;
+	for (size_t i = 0; i < this->lost_stracks.size(); i++)
+		slot_used[this->lost_stracks[i]] = 2;
+
+	for (size_t i = 0; i < slot_used.size(); i++)
+	{
+		if (slot_used[i] == 1)
+		{
+			slot_used[i] = 0;
+			free_slots.push_back((int)i);
+		}
+		else if (slot_used[i] == 2)
+		{
+			slot_used[i] = 1;
+		}
+	}
+}
+
+const std::vector<STrack *> &BYTETracker::output_stracks(const std::vector<int> &index)
+{
+	outputs.resize(index.size());
+	for (size_t i = 0; i < index.size(); i++)
+	{
+		outputs[i] = &tracks[index[i]];
+	}
+	return outputs;
 }
\ No newline at end of file
@@ -0,0 +1,78 @@
+#include "DetectScheduler.h"
+#include <algorithm>
+
+DetectScheduler::DetectScheduler()
+{
+	config.min_interval = 1;
+	config.max_interval = 1;
+	config.motion_thresh = 0.02f;
+	config.drift_thresh = 0.3f;
+	config.load_high = 0.9f;
+
+	m_interval = 1;
+	frames_since_detect = 0;
+	drift = 0;
+	max_speed = 0;
+	force = true;
+	npu_load = 0;
+	last_tracks = 0;
+}
+
+DetectScheduler::~DetectScheduler()
+{
+}
+
+void DetectScheduler::set_config(const bytetrack_schedule_t &config)
+{
+	this->config = config;
+	this->config.min_interval = std::max(config.min_interval, 1);
+	this->config.max_interval = std::max(config.max_interval, this->config.min_interval);
+	m_interval = this->config.min_interval;
+	force = true;
+}
+
+void DetectScheduler::set_npu_load(float load)
+{
+	npu_load = load;
+}
+
+bool DetectScheduler::need_detect() const
+{
+	return force || frames_since_detect + 1 >= m_interval;
+}
+
+void DetectScheduler::on_detect(const ScheduleStats &stats)
+{
+	frames_since_detect = 0;
+	drift = 0;
+	max_speed = stats.max_speed;
+	// new tracks are only confirmed by a detection on the next frame
+	force = stats.num_unconfirmed > 0;
+
+	bool changed = stats.num_tracks != last_tracks || stats.num_unconfirmed > 0;
+	bool overloaded = npu_load > config.load_high;
+	if (changed || (stats.max_speed > config.motion_thresh && !overloaded))
+	{
+		m_interval = std::max(config.min_interval, m_interval / 2);
+	}
+	else if (stats.max_speed < config.motion_thresh * 0.5f || overloaded)
+	{
+		m_interval = std::min(config.max_interval, m_interval + 1);
+	}
+	last_tracks = stats.num_tracks;
+}
+
+void DetectScheduler::on_predict(const ScheduleStats &stats)
+{
+	frames_since_detect++;
+	// predictions drift away from the objects, detect before they slip out of the IoU gate
+	max_speed = std::max(max_speed, stats.max_speed);
+	drift += max_speed;
+	if (drift > config.drift_thresh)
+		force = true;
+}
+
+int DetectScheduler::interval() const
+{
+	return m_interval;
+}
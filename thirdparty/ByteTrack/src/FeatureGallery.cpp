@@ -0,0 +1,133 @@
+#include "FeatureGallery.h"
+#include "SimdDefs.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+FeatureGallery::FeatureGallery()
+{
+	dim = 0;
+	size = 0;
+}
+
+void FeatureGallery::configure(int dim, int size)
+{
+	this->dim = std::max(dim, 0);
+	this->size = std::max(size, 1);
+	int slots = (int)counts.size();
+	features.assign((size_t)slots * this->size * this->dim, 0.f);
+	counts.assign(slots, 0);
+	heads.assign(slots, 0);
+	frames.assign(slots, 0);
+}
+
+int FeatureGallery::feature_dim() const
+{
+	return dim;
+}
+
+void FeatureGallery::resize(int slots)
+{
+	if (slots <= (int)counts.size())
+		return;
+	features.resize((size_t)slots * size * dim, 0.f);
+	counts.resize(slots, 0);
+	heads.resize(slots, 0);
+	frames.resize(slots, 0);
+}
+
+void FeatureGallery::clear(int slot)
+{
+	if (slot < (int)counts.size())
+	{
+		counts[slot] = 0;
+		heads[slot] = 0;
+	}
+}
+
+void FeatureGallery::push(int slot, const float *feature, int frame_id)
+{
+	if (dim == 0)
+		return;
+	resize(slot + 1);
+	memcpy(&features[((size_t)slot * size + heads[slot]) * dim], feature, dim * sizeof(float));
+	heads[slot] = (heads[slot] + 1) % size;
+	counts[slot] = std::min(counts[slot] + 1, size);
+	frames[slot] = frame_id;
+}
+
+int FeatureGallery::count(int slot) const
+{
+	return slot < (int)counts.size() ? counts[slot] : 0;
+}
+
+int FeatureGallery::last_frame(int slot) const
+{
+	return slot < (int)frames.size() ? frames[slot] : 0;
+}
+
+const float *FeatureGallery::feature(int slot, int k) const
+{
+	// a full ring starts at its head, the next entry to be overwritten
+	int index = counts[slot] == size ? (heads[slot] + k) % size : k;
+	return &features[((size_t)slot * size + index) * dim];
+}
+
+float FeatureGallery::distance(int slot, const float *feature) const
+{
+	int n = count(slot);
+	float best = -1.f;
+	const float *entry = n > 0 ? &features[(size_t)slot * size * dim] : nullptr;
+	for (int k = 0; k < n; k++, entry += dim)
+	{
+		best = std::max(best, dot(entry, feature, dim));
+	}
+	return std::min(std::max((1.f - best) / 2, 0.f), 1.f);
+}
+
+float FeatureGallery::dot(const float *a, const float *b, int dim)
+{
+	int i = 0;
+	float sum = 0;
+#if defined(BYTETRACK_SIMD_NEON)
+	float32x4_t acc0 = vdupq_n_f32(0.f);
+	float32x4_t acc1 = vdupq_n_f32(0.f);
+	for (; i + 8 <= dim; i += 8)
+	{
+		acc0 = vmlaq_f32(acc0, vld1q_f32(a + i), vld1q_f32(b + i));
+		acc1 = vmlaq_f32(acc1, vld1q_f32(a + i + 4), vld1q_f32(b + i + 4));
+	}
+	float32x4_t acc = vaddq_f32(acc0, acc1);
+	float32x2_t half = vadd_f32(vget_low_f32(acc), vget_high_f32(acc));
+	sum = vget_lane_f32(vpadd_f32(half, half), 0);
+#elif defined(BYTETRACK_SIMD_SSE2)
+	__m128 acc0 = _mm_setzero_ps();
+	__m128 acc1 = _mm_setzero_ps();
+	for (; i + 8 <= dim; i += 8)
+	{
+		acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+		acc1 = _mm_add_ps(acc1, _mm_mul_ps(_mm_loadu_ps(a + i + 4), _mm_loadu_ps(b + i + 4)));
+	}
+	__m128 acc = _mm_add_ps(acc0, acc1);
+	acc = _mm_add_ps(acc, _mm_movehl_ps(acc, acc));
+	acc = _mm_add_ss(acc, _mm_shuffle_ps(acc, acc, 1));
+	sum = _mm_cvtss_f32(acc);
+#endif
+	for (; i < dim; i++)
+	{
+		sum += a[i] * b[i];
+	}
+	return sum;
+}
+
+void FeatureGallery::normalize(float *feature, int dim)
+{
+	float norm = std::sqrt(dot(feature, feature, dim));
+	if (norm <= 1e-12f)
+		return;
+	float inv = 1.f / norm;
+	for (int i = 0; i < dim; i++)
+	{
+		feature[i] *= inv;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,315 @@
+#include "GatedAssignment.h"
+#include "lapjv.h"
+#include <algorithm>
+#include <numeric>
+
+// below this many pairs a plain loop is cheaper than the grid
+#define GATE_DENSE_PAIRS 256
+#define GATE_MAX_CELLS 64
+
+static inline float box_iou(const float *a, const float *b)
+{
+	float iw = std::min(a[2], b[2]) - std::max(a[0], b[0]) + 1;
+	if (iw <= 0)
+		return 0;
+	float ih = std::min(a[3], b[3]) - std::max(a[1], b[1]) + 1;
+	if (ih <= 0)
+		return 0;
+	float box_area = (b[2] - b[0] + 1) * (b[3] - b[1] + 1);
+	float ua = (a[2] - a[0] + 1) * (a[3] - a[1] + 1) + box_area - iw * ih;
+	return iw * ih / ua;
+}
+
+GatedAssignment::GatedAssignment()
+{
+	num_a = 0;
+	num_b = 0;
+}
+
+void GatedAssignment::gate(const float *boxa, int na, const float *boxb, int nb, float max_cost)
+{
+	num_a = na;
+	num_b = nb;
+	edges.clear();
+	if (na == 0 || nb == 0)
+		return;
+
+	if ((long long)na * nb <= GATE_DENSE_PAIRS)
+	{
+		for (int i = 0; i < na; i++)
+		{
+			for (int j = 0; j < nb; j++)
+			{
+				float cost = 1 - box_iou(boxa + 4 * i, boxb + 4 * j);
+				if (cost < max_cost)
+					edges.push_back({i, j, cost});
+			}
+		}
+		return;
+	}
+
+	// cells of about the mean b box size over the extent of the b boxes
+	float x0 = boxb[0], y0 = boxb[1], x1 = boxb[2], y1 = boxb[3];
+	float sum_w = 0, sum_h = 0;
+	for (int j = 0; j < nb; j++)
+	{
+		const float *b = boxb + 4 * j;
+		x0 = std::min(x0, b[0]);
+		y0 = std::min(y0, b[1]);
+		x1 = std::max(x1, b[2]);
+		y1 = std::max(y1, b[3]);
+		sum_w += b[2] - b[0] + 1;
+		sum_h += b[3] - b[1] + 1;
+	}
+	float cell = std::max(std::max(sum_w, sum_h) / nb, 1.f);
+	int gw = std::min((int)((x1 - x0) / cell) + 1, GATE_MAX_CELLS);
+	int gh = std::min((int)((y1 - y0) / cell) + 1, GATE_MAX_CELLS);
+	float sx = gw / (x1 - x0 + 1);
+	float sy = gh / (y1 - y0 + 1);
+	auto cell_x = [&](float x) { return std::min(std::max((int)((x - x0) * sx), 0), gw - 1); };
+	auto cell_y = [&](float y) { return std::min(std::max((int)((y - y0) * sy), 0), gh - 1); };
+
+	// count, prefix sum to the cell ends, then insert backwards so cell_start ends at the cell starts
+	int num_cells = gw * gh;
+	cell_start.assign(num_cells + 1, 0);
+	for (int j = 0; j < nb; j++)
+	{
+		const float *b = boxb + 4 * j;
+		for (int cy = cell_y(b[1]); cy <= cell_y(b[3]); cy++)
+			for (int cx = cell_x(b[0]); cx <= cell_x(b[2]); cx++)
+				cell_start[cy * gw + cx]++;
+	}
+	for (int c = 1; c < num_cells; c++)
+		cell_start[c] += cell_start[c - 1];
+	cell_start[num_cells] = cell_start[num_cells - 1];
+	cell_items.resize(cell_start[num_cells]);
+	for (int j = 0; j < nb; j++)
+	{
+		const float *b = boxb + 4 * j;
+		for (int cy = cell_y(b[1]); cy <= cell_y(b[3]); cy++)
+			for (int cx = cell_x(b[0]); cx <= cell_x(b[2]); cx++)
+				cell_items[--cell_start[cy * gw + cx]] = j;
+	}
+
+	// boxes overlap from 1 pixel apart on with the + 1 of box_iou
+	b_stamp.assign(nb, -1);
+	for (int i = 0; i < na; i++)
+	{
+		const float *a = boxa + 4 * i;
+		int cx0 = cell_x(a[0] - 1), cx1 = cell_x(a[2] + 1);
+		int cy0 = cell_y(a[1] - 1), cy1 = cell_y(a[3] + 1);
+		for (int cy = cy0; cy <= cy1; cy++)
+		{
+			for (int cx = cx0; cx <= cx1; cx++)
+			{
+				int c = cy * gw + cx;
+				for (int k = cell_start[c]; k < cell_start[c + 1]; k++)
+				{
+					int j = cell_items[k];
+					if (b_stamp[j] == i)
+						continue;
+					b_stamp[j] = i;
+
+					float cost = 1 - box_iou(a, boxb + 4 * j);
+					if (cost < max_cost)
+						edges.push_back({i, j, cost});
+				}
+			}
+		}
+	}
+}
+
+const std::vector<GatedAssignment::Edge> &GatedAssignment::get_edges() const
+{
+	return edges;
+}
+
+std::vector<GatedAssignment::Edge> &GatedAssignment::get_edges()
+{
+	return edges;
+}
+
+int GatedAssignment::find(int node)
+{
+	while (parent[node] != node)
+	{
+		parent[node] = parent[parent[node]];
+		node = parent[node];
+	}
+	return node;
+}
+
+void GatedAssignment::solve(float thresh, std::vector<std::pair<int, int>> &matches, std::vector<int> &unmatched_a, std::vector<int> &unmatched_b)
+{
+	matches.clear();
+	unmatched_a.clear();
+	unmatched_b.clear();
+	row_match.assign(num_a, -1);
+	col_match.assign(num_b, -1);
+
+	// a pair at thresh or above never beats leaving both unmatched, it does not connect anything
+	int num_nodes = num_a + num_b;
+	parent.resize(num_nodes);
+	std::iota(parent.begin(), parent.end(), 0);
+	for (size_t k = 0; k < edges.size(); k++)
+	{
+		if (edges[k].cost >= thresh)
+			continue;
+		int ra = find(edges[k].row);
+		int rb = find(num_a + edges[k].col);
+		if (ra != rb)
+			parent[rb] = ra;
+	}
+
+	// only roots of an edge get a component, nodes without an edge stay unmatched
+	comp_id.assign(num_nodes, -1);
+	int num_comp = 0;
+	for (size_t k = 0; k < edges.size(); k++)
+	{
+		if (edges[k].cost >= thresh)
+			continue;
+		int r = find(edges[k].row);
+		if (comp_id[r] < 0)
+			comp_id[r] = num_comp++;
+	}
+
+	// members of every component in index order, CSR
+	comp_row_start.assign(num_comp + 1, 0);
+	comp_col_start.assign(num_comp + 1, 0);
+	comp_edge_start.assign(num_comp + 1, 0);
+	for (int i = 0; i < num_a; i++)
+	{
+		int c = comp_id[find(i)];
+		if (c >= 0)
+			comp_row_start[c + 1]++;
+	}
+	for (int j = 0; j < num_b; j++)
+	{
+		int c = comp_id[find(num_a + j)];
+		if (c >= 0)
+			comp_col_start[c + 1]++;
+	}
+	for (size_t k = 0; k < edges.size(); k++)
+	{
+		if (edges[k].cost < thresh)
+			comp_edge_start[comp_id[find(edges[k].row)] + 1]++;
+	}
+	for (int c = 0; c < num_comp; c++)
+	{
+		comp_row_start[c + 1] += comp_row_start[c];
+		comp_col_start[c + 1] += comp_col_start[c];
+		comp_edge_start[c + 1] += comp_edge_start[c];
+	}
+
+	comp_rows.resize(comp_row_start[num_comp]);
+	comp_cols.resize(comp_col_start[num_comp]);
+	comp_edges.resize(comp_edge_start[num_comp]);
+	local.resize(num_nodes);
+
+	comp_fill.assign(comp_row_start.begin(), comp_row_start.end() - 1);
+	for (int i = 0; i < num_a; i++)
+	{
+		int c = comp_id[find(i)];
+		if (c >= 0)
+		{
+			local[i] = comp_fill[c] - comp_row_start[c];
+			comp_rows[comp_fill[c]++] = i;
+		}
+	}
+	comp_fill.assign(comp_col_start.begin(), comp_col_start.end() - 1);
+	for (int j = 0; j < num_b; j++)
+	{
+		int c = comp_id[find(num_a + j)];
+		if (c >= 0)
+		{
+			local[num_a + j] = comp_fill[c] - comp_col_start[c];
+			comp_cols[comp_fill[c]++] = j;
+		}
+	}
+	comp_fill.assign(comp_edge_start.begin(), comp_edge_start.end() - 1);
+	for (size_t k = 0; k < edges.size(); k++)
+	{
+		if (edges[k].cost < thresh)
+			comp_edges[comp_fill[comp_id[find(edges[k].row)]]++] = edges[k];
+	}
+
+	for (int c = 0; c < num_comp; c++)
+	{
+		solve_component(&comp_edges[comp_edge_start[c]], comp_edge_start[c + 1] - comp_edge_start[c],
+						&comp_rows[comp_row_start[c]], comp_row_start[c + 1] - comp_row_start[c],
+						&comp_cols[comp_col_start[c]], comp_col_start[c + 1] - comp_col_start[c], thresh);
+	}
+
+	for (int i = 0; i < num_a; i++)
+	{
+		if (row_match[i] >= 0)
+			matches.push_back(std::pair<int, int>(i, row_match[i]));
+		else
+			unmatched_a.push_back(i);
+	}
+	for (int j = 0; j < num_b; j++)
+	{
+		if (col_match[j] < 0)
+			unmatched_b.push_back(j);
+	}
+}
+
+void GatedAssignment::solve_component(const Edge *edges, int num_edges, const int *rows, int nr, const int *cols, int nc, float thresh)
+{
+	// one row or one column: its cheapest pair, every edge beats leaving both unmatched
+	if (nr == 1 || nc == 1)
+	{
+		const Edge *best = edges;
+		for (int k = 1; k < num_edges; k++)
+		{
+			const Edge &e = edges[k];
+			if (e.cost < best->cost || (e.cost == best->cost && (e.row < best->row || (e.row == best->row && e.col < best->col))))
+				best = &e;
+		}
+		row_match[best->row] = best->col;
+		col_match[best->col] = best->row;
+		return;
+	}
+
+	// dense extended matrix of the component like BYTETracker::lapjv had for the whole frame,
+	// pairs not gated cost 1 and lose against thresh / 2 + thresh / 2 anyway
+	int n = nr + nc;
+	float fill = thresh / 2;
+	lap_cost.resize((size_t)n * n);
+	lap_rows.resize(n);
+	for (int i = 0; i < n; i++)
+	{
+		float *row = &lap_cost[(size_t)i * n];
+		lap_rows[i] = row;
+		if (i < nr)
+		{
+			std::fill(row, row + nc, 1.f);
+			std::fill(row + nc, row + n, fill);
+		}
+		else
+		{
+			std::fill(row, row + nc, fill);
+			std::fill(row + nc, row + n, 0.f);
+		}
+	}
+	for (int k = 0; k < num_edges; k++)
+	{
+		lap_rows[local[edges[k].row]][local[num_a + edges[k].col]] = edges[k].cost;
+	}
+
+	lap_x.resize(n);
+	lap_y.resize(n);
+	lap_work.resize(lapjv_workspace_size(n));
+	if (lapjv_internal(n, lap_rows.data(), lap_x.data(), lap_y.data(), lap_work.data()) != 0)
+		return;
+
+	for (int i = 0; i < nr; i++)
+	{
+		int j = lap_x[i];
+		if (j >= 0 && j < nc)
+		{
+			row_match[rows[i]] = cols[j];
+			col_match[cols[j]] = rows[i];
+		}
+	}
+}
\ No newline at end of file
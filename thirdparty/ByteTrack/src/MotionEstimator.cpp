@@ -0,0 +1,431 @@
+#include "MotionEstimator.h"
+#include "SimdDefs.h"
+#include <algorithm>
+#include <climits>
+#include <cstdlib>
+
+#define GMC_BLOCK 16			// block side at work resolution
+#define GMC_COARSE_RADIUS 8		// search radius on the half plane, 2 * 8 work pixels of motion
+#define GMC_FINE_RADIUS 2
+#define GMC_MIN_TEXTURE 2		// mean abs gradient, both directions, of a block worth matching
+#define GMC_MAX_SAD 24			// mean abs difference of a usable match
+#define GMC_MIN_BLOCKS 8
+#define GMC_MIN_INLIER_RATIO 0.3f
+#define GMC_INLIER_DIST 1.f		// work pixels
+#define GMC_RANSAC_ITERS 64
+#define GMC_SCALE_MIN 0.8f
+#define GMC_SCALE_MAX 1.25f
+
+// sum of abs differences of size x size blocks, size 8 or 16
+static int sad(const unsigned char *a, int astride, const unsigned char *b, int bstride, int size)
+{
+#if defined(BYTETRACK_SIMD_NEON)
+	uint16x8_t acc = vdupq_n_u16(0);
+	if (size == 16)
+	{
+		for (int y = 0; y < 16; y++, a += astride, b += bstride)
+			acc = vpadalq_u8(acc, vabdq_u8(vld1q_u8(a), vld1q_u8(b)));
+	}
+	else
+	{
+		for (int y = 0; y < size; y++, a += astride, b += bstride)
+			acc = vabal_u8(acc, vld1_u8(a), vld1_u8(b));
+	}
+	uint64x2_t sum = vpaddlq_u32(vpaddlq_u16(acc));
+	return (int)(vgetq_lane_u64(sum, 0) + vgetq_lane_u64(sum, 1));
+#elif defined(BYTETRACK_SIMD_SSE2)
+	__m128i acc = _mm_setzero_si128();
+	if (size == 16)
+	{
+		for (int y = 0; y < 16; y++, a += astride, b += bstride)
+			acc = _mm_add_epi64(acc, _mm_sad_epu8(_mm_loadu_si128((const __m128i *)a), _mm_loadu_si128((const __m128i *)b)));
+	}
+	else
+	{
+		for (int y = 0; y < size; y++, a += astride, b += bstride)
+			acc = _mm_add_epi64(acc, _mm_sad_epu8(_mm_loadl_epi64((const __m128i *)a), _mm_loadl_epi64((const __m128i *)b)));
+	}
+	return _mm_cvtsi128_si32(acc) + _mm_cvtsi128_si32(_mm_srli_si128(acc, 8));
+#else
+	int sum = 0;
+	for (int y = 0; y < size; y++, a += astride, b += bstride)
+	{
+		for (int x = 0; x < size; x++)
+			sum += std::abs(a[x] - b[x]);
+	}
+	return sum;
+#endif
+}
+
+// min of the summed horizontal and vertical gradients, flat blocks and plain edges match anywhere along them
+static int texture(const unsigned char *a, int stride, int size)
+{
+	int gx = 0, gy = 0;
+	for (int y = 0; y + 1 < size; y++, a += stride)
+	{
+		for (int x = 0; x + 1 < size; x++)
+		{
+			gx += std::abs(a[x + 1] - a[x]);
+			gy += std::abs(a[x + stride] - a[x]);
+		}
+	}
+	return std::min(gx, gy);
+}
+
+MotionEstimator::MotionEstimator(int work_width)
+{
+	this->work_width = std::max(work_width, 4 * GMC_BLOCK);
+	factor = 1;
+	full_width = 0;
+	full_height = 0;
+	has_prev = false;
+	luma = nullptr;
+	stride = 0;
+	pending = false;
+	stop = false;
+	motion = identity();
+	thread = std::thread(&MotionEstimator::worker, this);
+}
+
+MotionEstimator::~MotionEstimator()
+{
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		stop = true;
+	}
+	cv.notify_all();
+	thread.join();
+}
+
+MotionEstimator::Motion MotionEstimator::identity()
+{
+	Motion m;
+	m.scale = 1.f;
+	m.tx = 0.f;
+	m.ty = 0.f;
+	m.valid = false;
+	return m;
+}
+
+MotionEstimator::Motion MotionEstimator::compose(const Motion &a, const Motion &b)
+{
+	if (!a.valid)
+		return b;
+	if (!b.valid)
+		return a;
+	Motion m;
+	m.scale = b.scale * a.scale;
+	m.tx = b.scale * a.tx + b.tx;
+	m.ty = b.scale * a.ty + b.ty;
+	m.valid = true;
+	return m;
+}
+
+void MotionEstimator::push(const unsigned char *luma, int width, int height, int stride)
+{
+	std::unique_lock<std::mutex> guard(lock);
+	cv.wait(guard, [this] { return !pending; });
+
+	if (width != full_width || height != full_height)
+	{
+		// new stream geometry, nothing to compare against
+		full_width = width;
+		full_height = height;
+		factor = std::max(width / work_width, 1);
+		has_prev = false;
+	}
+	else
+	{
+		std::swap(cur[0], prev[0]);
+		std::swap(cur[1], prev[1]);
+		has_prev = true;
+	}
+	this->luma = luma;
+	this->stride = stride;
+	pending = true;
+	cv.notify_all();
+}
+
+MotionEstimator::Motion MotionEstimator::take()
+{
+	std::unique_lock<std::mutex> guard(lock);
+	cv.wait(guard, [this] { return !pending; });
+	Motion m = motion;
+	motion = identity();
+	return m;
+}
+
+void MotionEstimator::worker()
+{
+	std::unique_lock<std::mutex> guard(lock);
+	for (;;)
+	{
+		cv.wait(guard, [this] { return pending || stop; });
+		if (stop)
+			break;
+
+		// push() does not touch the planes while pending
+		guard.unlock();
+		downscale(luma, full_width, full_height, stride, factor, cur[0], row_sum);
+		halve(cur[0], cur[1]);
+		Motion m = has_prev ? estimate() : identity();
+		guard.lock();
+
+		motion = compose(motion, m);
+		pending = false;
+		cv.notify_all();
+	}
+}
+
+void MotionEstimator::downscale(const unsigned char *src, int width, int height, int stride, int factor, Plane &dst, std::vector<unsigned int> &row_sum)
+{
+	dst.width = width / factor;
+	dst.height = height / factor;
+	dst.data.resize((size_t)dst.width * dst.height);
+	if (factor == 1)
+	{
+		for (int y = 0; y < dst.height; y++)
+			std::copy(src + (size_t)y * stride, src + (size_t)y * stride + dst.width, &dst.data[(size_t)y * dst.width]);
+		return;
+	}
+
+	// box average of factor x factor pixels, a column sum over the rows then the row
+	const int span = dst.width * factor;
+	const unsigned int area = factor * factor;
+	row_sum.resize(span);
+	for (int y = 0; y < dst.height; y++)
+	{
+		std::fill(row_sum.begin(), row_sum.end(), 0u);
+		const unsigned char *row = src + (size_t)y * factor * stride;
+		for (int k = 0; k < factor; k++, row += stride)
+		{
+			for (int x = 0; x < span; x++)
+				row_sum[x] += row[x];
+		}
+		unsigned char *out = &dst.data[(size_t)y * dst.width];
+		for (int x = 0; x < dst.width; x++)
+		{
+			unsigned int sum = 0;
+			for (int k = 0; k < factor; k++)
+				sum += row_sum[x * factor + k];
+			out[x] = (unsigned char)((sum + area / 2) / area);
+		}
+	}
+}
+
+void MotionEstimator::halve(const Plane &src, Plane &dst)
+{
+	dst.width = src.width / 2;
+	dst.height = src.height / 2;
+	dst.data.resize((size_t)dst.width * dst.height);
+	for (int y = 0; y < dst.height; y++)
+	{
+		const unsigned char *r0 = &src.data[(size_t)2 * y * src.width];
+		const unsigned char *r1 = r0 + src.width;
+		unsigned char *out = &dst.data[(size_t)y * dst.width];
+		for (int x = 0; x < dst.width; x++)
+			out[x] = (unsigned char)((r0[2 * x] + r0[2 * x + 1] + r1[2 * x] + r1[2 * x + 1] + 2) / 4);
+	}
+}
+
+// Motion of the block at (bx, by) of prev: full search on the half planes, +-GMC_FINE_RADIUS around it at
+// work resolution, then a parabola through the neighbouring SADs for the sub-pixel part
+bool MotionEstimator::match_block(int bx, int by, float &dx, float &dy)
+{
+	const int size = GMC_BLOCK;
+	const int half = GMC_BLOCK / 2;
+
+	const Plane &p1 = prev[1];
+	const Plane &c1 = cur[1];
+	const int cx = bx / 2, cy = by / 2;
+	const unsigned char *ref1 = &p1.data[(size_t)cy * p1.width + cx];
+	int x_lo = std::max(-GMC_COARSE_RADIUS, -cx), x_hi = std::min(GMC_COARSE_RADIUS, c1.width - half - cx);
+	int y_lo = std::max(-GMC_COARSE_RADIUS, -cy), y_hi = std::min(GMC_COARSE_RADIUS, c1.height - half - cy);
+	int best = INT_MAX, best_dx = 0, best_dy = 0;
+	for (int v = y_lo; v <= y_hi; v++)
+	{
+		for (int u = x_lo; u <= x_hi; u++)
+		{
+			int s = sad(ref1, p1.width, &c1.data[(size_t)(cy + v) * c1.width + cx + u], c1.width, half);
+			// ties go to the smaller motion, a static background wins over a repeated pattern
+			if (s < best || (s == best && std::abs(u) + std::abs(v) < std::abs(best_dx) + std::abs(best_dy)))
+			{
+				best = s;
+				best_dx = u;
+				best_dy = v;
+			}
+		}
+	}
+
+	const Plane &p0 = prev[0];
+	const Plane &c0 = cur[0];
+	const unsigned char *ref0 = &p0.data[(size_t)by * p0.width + bx];
+	const int r = GMC_FINE_RADIUS;
+	int sads[2 * r + 1][2 * r + 1];
+	best = INT_MAX;
+	int fine_u = 0, fine_v = 0;
+	for (int j = -r; j <= r; j++)
+	{
+		for (int i = -r; i <= r; i++)
+		{
+			int x = bx + 2 * best_dx + i, y = by + 2 * best_dy + j;
+			int &s = sads[j + r][i + r];
+			s = INT_MAX;
+			if (x < 0 || y < 0 || x + size > c0.width || y + size > c0.height)
+				continue;
+			s = sad(ref0, p0.width, &c0.data[(size_t)y * c0.width + x], c0.width, size);
+			if (s < best)
+			{
+				best = s;
+				fine_u = i;
+				fine_v = j;
+			}
+		}
+	}
+	if (best > GMC_MAX_SAD * size * size)
+		return false;
+
+	float sub_x = 0.f, sub_y = 0.f;
+	const int i = fine_u + r, j = fine_v + r;
+	if (i > 0 && i < 2 * r && sads[j][i - 1] != INT_MAX && sads[j][i + 1] != INT_MAX)
+	{
+		float den = (float)sads[j][i - 1] - 2.f * best + sads[j][i + 1];
+		if (den > 0)
+			sub_x = 0.5f * (sads[j][i - 1] - sads[j][i + 1]) / den;
+	}
+	if (j > 0 && j < 2 * r && sads[j - 1][i] != INT_MAX && sads[j + 1][i] != INT_MAX)
+	{
+		float den = (float)sads[j - 1][i] - 2.f * best + sads[j + 1][i];
+		if (den > 0)
+			sub_y = 0.5f * (sads[j - 1][i] - sads[j + 1][i]) / den;
+	}
+	dx = 2 * best_dx + fine_u + sub_x;
+	dy = 2 * best_dy + fine_v + sub_y;
+	return true;
+}
+
+// least squares scale and translation of the flagged pairs, q = scale * p + t
+static bool fit_motion(const std::vector<float> &px, const std::vector<float> &py, const std::vector<float> &qx, const std::vector<float> &qy,
+					   const std::vector<char> &use, float &scale, float &tx, float &ty)
+{
+	double mpx = 0, mpy = 0, mqx = 0, mqy = 0;
+	int n = 0;
+	for (size_t k = 0; k < px.size(); k++)
+	{
+		if (!use[k])
+			continue;
+		mpx += px[k];
+		mpy += py[k];
+		mqx += qx[k];
+		mqy += qy[k];
+		n++;
+	}
+	if (n < 2)
+		return false;
+	mpx /= n;
+	mpy /= n;
+	mqx /= n;
+	mqy /= n;
+
+	double spq = 0, spp = 0;
+	for (size_t k = 0; k < px.size(); k++)
+	{
+		if (!use[k])
+			continue;
+		double ux = px[k] - mpx, uy = py[k] - mpy;
+		spq += ux * (qx[k] - mqx) + uy * (qy[k] - mqy);
+		spp += ux * ux + uy * uy;
+	}
+	double s = spp > 0 ? spq / spp : 1.0;
+	s = std::min(std::max(s, (double)GMC_SCALE_MIN), (double)GMC_SCALE_MAX);
+	scale = (float)s;
+	tx = (float)(mqx - s * mpx);
+	ty = (float)(mqy - s * mpy);
+	return true;
+}
+
+static int count_inliers(const std::vector<float> &px, const std::vector<float> &py, const std::vector<float> &qx, const std::vector<float> &qy,
+						 float scale, float tx, float ty, std::vector<char> &inlier)
+{
+	const float dist2 = GMC_INLIER_DIST * GMC_INLIER_DIST;
+	int count = 0;
+	inlier.resize(px.size());
+	for (size_t k = 0; k < px.size(); k++)
+	{
+		float ex = scale * px[k] + tx - qx[k];
+		float ey = scale * py[k] + ty - qy[k];
+		inlier[k] = ex * ex + ey * ey <= dist2;
+		count += inlier[k];
+	}
+	return count;
+}
+
+// Block motions of the textured blocks of prev, then a RANSAC fit so the moving objects drop out
+MotionEstimator::Motion MotionEstimator::estimate()
+{
+	const Plane &p0 = prev[0];
+	px.clear();
+	py.clear();
+	qx.clear();
+	qy.clear();
+	for (int by = GMC_BLOCK / 2; by + GMC_BLOCK + GMC_BLOCK / 2 <= p0.height; by += GMC_BLOCK)
+	{
+		for (int bx = GMC_BLOCK / 2; bx + GMC_BLOCK + GMC_BLOCK / 2 <= p0.width; bx += GMC_BLOCK)
+		{
+			if (texture(&p0.data[(size_t)by * p0.width + bx], p0.width, GMC_BLOCK) < GMC_MIN_TEXTURE * GMC_BLOCK * GMC_BLOCK)
+				continue;
+			float dx, dy;
+			if (!match_block(bx, by, dx, dy))
+				continue;
+			float cx = bx + GMC_BLOCK / 2.f, cy = by + GMC_BLOCK / 2.f;
+			px.push_back(cx);
+			py.push_back(cy);
+			qx.push_back(cx + dx);
+			qy.push_back(cy + dy);
+		}
+	}
+
+	const int n = (int)px.size();
+	if (n < GMC_MIN_BLOCKS)
+		return identity();
+
+	// 2 blocks fix scale and translation; seeded per call so equal frames give equal motions
+	const float min_dist2 = (2.f * GMC_BLOCK) * (2.f * GMC_BLOCK);
+	unsigned int seed = 0x9E3779B9u;
+	int best_count = 0;
+	for (int it = 0; it < GMC_RANSAC_ITERS; it++)
+	{
+		seed = seed * 1664525u + 1013904223u;
+		int a = (seed >> 8) % n;
+		seed = seed * 1664525u + 1013904223u;
+		int b = (seed >> 8) % n;
+		float ux = px[b] - px[a], uy = py[b] - py[a];
+		float den = ux * ux + uy * uy;
+		if (den < min_dist2)
+			continue;
+		float scale = ((qx[b] - qx[a]) * ux + (qy[b] - qy[a]) * uy) / den;
+		if (scale < GMC_SCALE_MIN || scale > GMC_SCALE_MAX)
+			continue;
+		int count = count_inliers(px, py, qx, qy, scale, qx[a] - scale * px[a], qy[a] - scale * py[a], inlier);
+		if (count > best_count)
+		{
+			best_count = count;
+			best_inlier.swap(inlier);
+		}
+	}
+	if (best_count < std::max(GMC_MIN_BLOCKS, (int)(GMC_MIN_INLIER_RATIO * n)))
+		return identity();
+
+	// refit on the consensus, once more on its own inliers
+	Motion m;
+	if (!fit_motion(px, py, qx, qy, best_inlier, m.scale, m.tx, m.ty))
+		return identity();
+	if (count_inliers(px, py, qx, qy, m.scale, m.tx, m.ty, inlier) >= best_count)
+		fit_motion(px, py, qx, qy, inlier, m.scale, m.tx, m.ty);
+
+	// work pixel x covers [x * factor, (x + 1) * factor) of the frame
+	m.tx *= factor;
+	m.ty *= factor;
+	m.valid = true;
+	return m;
+}
\ No newline at end of file
@@ -1,16 +1,31 @@
 #include "STrack.h"
+#include <atomic>
 
-STrack::STrack(std::vector<float> tlwh_, float _score, void *_user_data)
+STrack::STrack()
 {
-	_tlwh.resize(4);
-	_tlwh.assign(tlwh_.begin(), tlwh_.end());
-
 	is_activated = false;
 	track_id = 0;
 	state = TrackState::New;
+	for (int i = 0; i < 4; i++)
+	{
+		_tlwh[i] = 0;
+		tlwh[i] = 0;
+		tlbr[i] = 0;
+	}
+	frame_id = 0;
+	tracklet_len = 0;
+	start_frame = 0;
+	score = 0;
+}
 
-	tlwh.resize(4);
-	tlbr.resize(4);
+STrack::STrack(const float *tlwh_, float _score, void *_user_data)
+{
+	for (int i = 0; i < 4; i++)
+		_tlwh[i] = tlwh_[i];
+
+	is_activated = false;
+	track_id = 0;
+	state = TrackState::New;
 
 	static_tlwh();
 	static_tlbr();
@@ -27,23 +42,11 @@ STrack::~STrack()
 
 void STrack::activate(byte_kalman::KalmanFilter &kalman_filter, int frame_id)
 {
-	this->kalman_filter = kalman_filter;
 	this->track_id = this->next_id();
 
-	std::vector<float> _tlwh_tmp(4);
-	_tlwh_tmp[0] = this->_tlwh[0];
-	_tlwh_tmp[1] = this->_tlwh[1];
-	_tlwh_tmp[2] = this->_tlwh[2];
-	_tlwh_tmp[3] = this->_tlwh[3];
-	std::vector<float> xyah = tlwh_to_xyah(_tlwh_tmp);
-	DETECTBOX xyah_box;
-	xyah_box[0] = xyah[0];
-	xyah_box[1] = xyah[1];
-	xyah_box[2] = xyah[2];
-	xyah_box[3] = xyah[3];
-	auto mc = this->kalman_filter.initiate(xyah_box);
-	this->mean = mc.first;
-	this->covariance = mc.second;
+	float xyah_box[4];
+	tlwh_to_xyah(this->_tlwh, xyah_box);
+	kalman_filter.initiate(xyah_box, this->kalman);
 
 	static_tlwh();
 	static_tlbr();
@@ -59,17 +62,11 @@ void STrack::activate(byte_kalman::KalmanFilter &kalman_filter, int frame_id)
 	this->start_frame = frame_id;
 }
 
-void STrack::re_activate(STrack &new_track, int frame_id, bool new_id)
+void STrack::re_activate(byte_kalman::KalmanFilter &kalman_filter, const STrack &new_track, int frame_id, bool new_id)
 {
-	std::vector<float> xyah = tlwh_to_xyah(new_track.tlwh);
-	DETECTBOX xyah_box;
-	xyah_box[0] = xyah[0];
-	xyah_box[1] = xyah[1];
-	xyah_box[2] = xyah[2];
-	xyah_box[3] = xyah[3];
-	auto mc = this->kalman_filter.update(this->mean, this->covariance, xyah_box);
-	this->mean = mc.first;
-	this->covariance = mc.second;
+	float xyah_box[4];
+	tlwh_to_xyah(new_track.tlwh, xyah_box);
+	kalman_filter.update(this->kalman, xyah_box);
 
 	static_tlwh();
 	static_tlbr();
@@ -83,21 +80,14 @@ void STrack::re_activate(STrack &new_track, int frame_id, bool new_id)
 		this->track_id = next_id();
 }
 
-void STrack::update(STrack &new_track, int frame_id)
+void STrack::update(byte_kalman::KalmanFilter &kalman_filter, const STrack &new_track, int frame_id)
 {
 	this->frame_id = frame_id;
 	this->tracklet_len++;
 
-	std::vector<float> xyah = tlwh_to_xyah(new_track.tlwh);
-	DETECTBOX xyah_box;
-	xyah_box[0] = xyah[0];
-	xyah_box[1] = xyah[1];
-	xyah_box[2] = xyah[2];
-	xyah_box[3] = xyah[3];
-
-	auto mc = this->kalman_filter.update(this->mean, this->covariance, xyah_box);
-	this->mean = mc.first;
-	this->covariance = mc.second;
+	float xyah_box[4];
+	tlwh_to_xyah(new_track.tlwh, xyah_box);
+	kalman_filter.update(this->kalman, xyah_box);
 
 	static_tlwh();
 	static_tlbr();
@@ -119,10 +109,10 @@ void STrack::static_tlwh()
 		return;
 	}
 
-	tlwh[0] = mean[0];
-	tlwh[1] = mean[1];
-	tlwh[2] = mean[2];
-	tlwh[3] = mean[3];
+	tlwh[0] = kalman.mean[0];
+	tlwh[1] = kalman.mean[1];
+	tlwh[2] = kalman.mean[2];
+	tlwh[3] = kalman.mean[3];
 
 	tlwh[2] *= tlwh[3];
 	tlwh[0] -= tlwh[2] / 2;
@@ -131,31 +121,26 @@ void STrack::static_tlwh()
 
 void STrack::static_tlbr()
 {
-	tlbr.clear();
-	tlbr.assign(tlwh.begin(), tlwh.end());
-	tlbr[2] += tlbr[0];
-	tlbr[3] += tlbr[1];
+	tlbr[0] = tlwh[0];
+	tlbr[1] = tlwh[1];
+	tlbr[2] = tlwh[2] + tlbr[0];
+	tlbr[3] = tlwh[3] + tlbr[1];
 }
 
-std::vector<float> STrack::tlwh_to_xyah(std::vector<float> tlwh_tmp)
+void STrack::tlwh_to_xyah(const float *tlwh, float *xyah)
 {
-	std::vector<float> tlwh_output = tlwh_tmp;
-	tlwh_output[0] += tlwh_output[2] / 2;
-	tlwh_output[1] += tlwh_output[3] / 2;
-	tlwh_output[2] /= tlwh_output[3];
-	return tlwh_output;
+	xyah[0] = tlwh[0] + tlwh[2] / 2;
+	xyah[1] = tlwh[1] + tlwh[3] / 2;
+	xyah[2] = tlwh[2] / tlwh[3];
+	xyah[3] = tlwh[3];
 }
 
-std::vector<float> STrack::to_xyah()
+void STrack::tlbr_to_tlwh(const float *tlbr, float *tlwh)
 {
-	return tlwh_to_xyah(tlwh);
-}
-
-std::vector<float> STrack::tlbr_to_tlwh(std::vector<float> &tlbr)
-{
-	tlbr[2] -= tlbr[0];
-	tlbr[3] -= tlbr[1];
-	return tlbr;
+	tlwh[0] = tlbr[0];
+	tlwh[1] = tlbr[1];
+	tlwh[2] = tlbr[2] - tlbr[0];
+	tlwh[3] = tlbr[3] - tlbr[1];
 }
 
 void STrack::mark_lost()
@@ -168,28 +153,43 @@ void STrack::mark_removed()
 	state = TrackState::Removed;
 }
 
+// ids stay unique over every tracker, which may run on several threads
+static std::atomic<int> id_count(0);
+
 int STrack::next_id()
 {
-	static int _count = 0;
-	_count++;
-	return _count;
+	return ++id_count;
+}
+
+int STrack::last_id()
+{
+	return id_count.load();
+}
+
+void STrack::reserve_ids(int id)
+{
+	int cur = id_count.load();
+	while (cur < id && !id_count.compare_exchange_weak(cur, id))
+	{
+	}
 }
 
-int STrack::end_frame()
+int STrack::end_frame() const
 {
 	return this->frame_id;
 }
 
-void STrack::multi_predict(std::vector<STrack *> &stracks, byte_kalman::KalmanFilter &kalman_filter)
+void STrack::multi_predict(std::vector<STrack> &stracks, const std::vector<int> &index, byte_kalman::KalmanFilter &kalman_filter)
 {
-	for (size_t i = 0; i < stracks.size(); i++)
+	for (size_t i = 0; i < index.size(); i++)
 	{
-		if (stracks[i]->state != TrackState::Tracked)
+		STrack &strack = stracks[index[i]];
+		if (strack.state != TrackState::Tracked)
 		{
-			stracks[i]->mean[7] = 0;
+			strack.kalman.mean[7] = 0;
 		}
-		kalman_filter.predict(stracks[i]->mean, stracks[i]->covariance);
-		stracks[i]->static_tlwh();
-		stracks[i]->static_tlbr();
+		kalman_filter.predict(strack.kalman);
+		strack.static_tlwh();
+		strack.static_tlbr();
 	}
 }
\ No newline at end of file
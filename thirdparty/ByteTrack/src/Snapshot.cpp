@@ -0,0 +1,231 @@
+#include "Snapshot.h"
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define SNAPSHOT_FILE_MAGIC 0x46535442u // "BTSF"
+#define SNAPSHOT_FILE_VERSION 1u
+#define SNAPSHOT_SLOT_MAGIC 0x4C535442u // "BTSL"
+#define SNAPSHOT_FILE_HEADER 64			// slot 0 starts here, slot 1 one slot_size further
+#define SNAPSHOT_PAGE 4096
+
+struct SnapshotFileHeader
+{
+	uint32_t magic;
+	uint32_t version;
+	uint64_t slot_size;
+};
+
+struct SnapshotSlotHeader
+{
+	uint32_t magic;
+	uint32_t checksum; // FNV-1a over seq, size and the payload
+	uint64_t seq;
+	uint64_t size;
+};
+
+static uint32_t fnv1a(const void *data, size_t size, uint32_t hash)
+{
+	const unsigned char *p = (const unsigned char *)data;
+	for (size_t i = 0; i < size; i++)
+	{
+		hash ^= p[i];
+		hash *= 16777619u;
+	}
+	return hash;
+}
+
+static uint32_t slot_checksum(const SnapshotSlotHeader &header, const unsigned char *payload)
+{
+	uint32_t hash = fnv1a(&header.seq, sizeof(header.seq), 2166136261u);
+	hash = fnv1a(&header.size, sizeof(header.size), hash);
+	return fnv1a(payload, header.size, hash);
+}
+
+static bool valid_slot(const unsigned char *slot, size_t slot_size, SnapshotSlotHeader &header)
+{
+	memcpy(&header, slot, sizeof(header));
+	return header.magic == SNAPSHOT_SLOT_MAGIC && header.size <= slot_size - sizeof(SnapshotSlotHeader) &&
+		   slot_checksum(header, slot + sizeof(SnapshotSlotHeader)) == header.checksum;
+}
+
+SnapshotFile::SnapshotFile()
+{
+	fd = -1;
+	base = nullptr;
+	slot_size = 0;
+	seq = 0;
+	next_slot = 0;
+}
+
+SnapshotFile::~SnapshotFile()
+{
+	close_file();
+}
+
+void SnapshotFile::close_file()
+{
+	if (base)
+		munmap(base, SNAPSHOT_FILE_HEADER + 2 * slot_size);
+	if (fd >= 0)
+		close(fd);
+	fd = -1;
+	base = nullptr;
+	slot_size = 0;
+	seq = 0;
+	next_slot = 0;
+	path.clear();
+}
+
+// Maps an existing snapshot file and continues its sequence, anything else is rewritten on the first write
+int SnapshotFile::open_file(const char *path)
+{
+	close_file();
+	fd = open(path, O_RDWR | O_CREAT, 0644);
+	if (fd < 0)
+	{
+		printf("SnapshotFile: cannot open %s, errno %d\n", path, errno);
+		return -1;
+	}
+	this->path = path;
+
+	struct stat st;
+	SnapshotFileHeader file_header;
+	if (fstat(fd, &st) != 0 || st.st_size < SNAPSHOT_FILE_HEADER ||
+		pread(fd, &file_header, sizeof(file_header), 0) != (ssize_t)sizeof(file_header))
+		return 0;
+	if (file_header.magic != SNAPSHOT_FILE_MAGIC || file_header.version != SNAPSHOT_FILE_VERSION ||
+		file_header.slot_size <= sizeof(SnapshotSlotHeader) || (uint64_t)st.st_size < SNAPSHOT_FILE_HEADER + 2 * file_header.slot_size)
+		return 0;
+
+	void *map = mmap(nullptr, SNAPSHOT_FILE_HEADER + 2 * file_header.slot_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	if (map == MAP_FAILED)
+		return 0;
+	base = (unsigned char *)map;
+	slot_size = file_header.slot_size;
+	for (int i = 0; i < 2; i++)
+	{
+		SnapshotSlotHeader header;
+		if (valid_slot(base + SNAPSHOT_FILE_HEADER + i * slot_size, slot_size, header) && header.seq >= seq)
+		{
+			seq = header.seq;
+			next_slot = 1 - i;
+		}
+	}
+	return 0;
+}
+
+// Slot 0 keeps its offset and data when the slots grow, slot 1 moves and is written next
+int SnapshotFile::grow(size_t need)
+{
+	size_t new_size = (2 * need + SNAPSHOT_PAGE - 1) / SNAPSHOT_PAGE * SNAPSHOT_PAGE;
+	bool keep_slot0 = false;
+	if (base)
+	{
+		SnapshotSlotHeader header;
+		keep_slot0 = valid_slot(base + SNAPSHOT_FILE_HEADER, slot_size, header);
+		munmap(base, SNAPSHOT_FILE_HEADER + 2 * slot_size);
+		base = nullptr;
+	}
+	slot_size = 0;
+
+	if (ftruncate(fd, SNAPSHOT_FILE_HEADER + 2 * new_size) != 0)
+	{
+		printf("SnapshotFile: cannot resize %s, errno %d\n", path.c_str(), errno);
+		return -1;
+	}
+	void *map = mmap(nullptr, SNAPSHOT_FILE_HEADER + 2 * new_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	if (map == MAP_FAILED)
+	{
+		printf("SnapshotFile: cannot map %s, errno %d\n", path.c_str(), errno);
+		return -1;
+	}
+	base = (unsigned char *)map;
+	slot_size = new_size;
+
+	SnapshotFileHeader file_header = {SNAPSHOT_FILE_MAGIC, SNAPSHOT_FILE_VERSION, new_size};
+	memcpy(base, &file_header, sizeof(file_header));
+	if (!keep_slot0)
+		memset(base + SNAPSHOT_FILE_HEADER, 0, sizeof(SnapshotSlotHeader));
+	memset(base + SNAPSHOT_FILE_HEADER + slot_size, 0, sizeof(SnapshotSlotHeader));
+	next_slot = 1;
+	return 0;
+}
+
+int SnapshotFile::write(const char *path, const unsigned char *data, size_t size)
+{
+	if (fd < 0 || this->path != path)
+	{
+		if (open_file(path) != 0)
+			return -1;
+	}
+	if (sizeof(SnapshotSlotHeader) + size > slot_size && grow(sizeof(SnapshotSlotHeader) + size) != 0)
+		return -1;
+
+	// the slot reads as invalid until its header lands after the payload
+	unsigned char *slot = base + SNAPSHOT_FILE_HEADER + next_slot * slot_size;
+	memset(slot, 0, sizeof(SnapshotSlotHeader));
+	memcpy(slot + sizeof(SnapshotSlotHeader), data, size);
+
+	SnapshotSlotHeader header;
+	header.magic = SNAPSHOT_SLOT_MAGIC;
+	header.seq = seq + 1;
+	header.size = size;
+	header.checksum = slot_checksum(header, slot + sizeof(SnapshotSlotHeader));
+	std::atomic_thread_fence(std::memory_order_release);
+	memcpy(slot, &header, sizeof(header));
+	msync(base, SNAPSHOT_FILE_HEADER + 2 * slot_size, MS_ASYNC);
+
+	seq = header.seq;
+	next_slot = 1 - next_slot;
+	return 0;
+}
+
+int SnapshotFile::read(const char *path, std::vector<unsigned char> &data)
+{
+	int fd = open(path, O_RDONLY);
+	if (fd < 0)
+		return -1;
+	struct stat st;
+	if (fstat(fd, &st) != 0 || st.st_size < SNAPSHOT_FILE_HEADER)
+	{
+		close(fd);
+		return -1;
+	}
+	void *map = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if (map == MAP_FAILED)
+		return -1;
+
+	const unsigned char *base = (const unsigned char *)map;
+	SnapshotFileHeader file_header;
+	memcpy(&file_header, base, sizeof(file_header));
+	int ret = -1;
+	if (file_header.magic == SNAPSHOT_FILE_MAGIC && file_header.version == SNAPSHOT_FILE_VERSION &&
+		file_header.slot_size > sizeof(SnapshotSlotHeader) && (uint64_t)st.st_size >= SNAPSHOT_FILE_HEADER + 2 * file_header.slot_size)
+	{
+		const unsigned char *best = nullptr;
+		SnapshotSlotHeader best_header;
+		for (int i = 0; i < 2; i++)
+		{
+			const unsigned char *slot = base + SNAPSHOT_FILE_HEADER + i * file_header.slot_size;
+			SnapshotSlotHeader header;
+			if (valid_slot(slot, file_header.slot_size, header) && (!best || header.seq > best_header.seq))
+			{
+				best = slot;
+				best_header = header;
+			}
+		}
+		if (best)
+		{
+			data.assign(best + sizeof(SnapshotSlotHeader), best + sizeof(SnapshotSlotHeader) + best_header.size);
+			ret = 0;
+		}
+	}
+	munmap(map, st.st_size);
+	return ret;
+}
\ No newline at end of file
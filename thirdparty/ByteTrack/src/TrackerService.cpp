@@ -0,0 +1,273 @@
+#include "TrackerService.h"
+#include <algorithm>
+#include <cstring>
+#include <string>
+
+TrackerService::TrackerService(int num_workers, int frame_rate, int track_buffer, int max_pending,
+							   bytetrack_service_cb_t callback, void *user)
+{
+	this->frame_rate = frame_rate;
+	this->track_buffer = track_buffer;
+	this->max_pending = max_pending;
+	this->callback = callback;
+	this->user = user;
+	in_flight = 0;
+	stop = false;
+
+	if (num_workers <= 0)
+		num_workers = std::max((int)std::thread::hardware_concurrency(), 1);
+	for (int i = 0; i < num_workers; i++)
+	{
+		workers.push_back(std::thread(&TrackerService::worker, this));
+	}
+}
+
+// queued frames are still tracked and delivered before the workers exit
+TrackerService::~TrackerService()
+{
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		stop = true;
+	}
+	work_cv.notify_all();
+	for (size_t i = 0; i < workers.size(); i++)
+	{
+		workers[i].join();
+	}
+
+	for (auto &it : channels)
+	{
+		bytetracker_release(&it.second->tracker);
+	}
+}
+
+TrackerService::Channel *TrackerService::get_channel(int channel)
+{
+	std::unique_ptr<Channel> &ch = channels[channel];
+	if (!ch)
+	{
+		ch.reset(new Channel);
+		ch->id = channel;
+		ch->tracker = bytetracker_create(frame_rate, track_buffer);
+		ch->scheduled = false;
+		memset(&ch->health, 0, sizeof(ch->health));
+		ch->frames = 0;
+		ch->need_detect = bytetracker_need_detect(ch->tracker);
+		ch->interval = bytetracker_get_interval(ch->tracker);
+		ch->since_detect = 0;
+	}
+	return ch.get();
+}
+
+// schedules the channel for the entry just queued, unlocks when it wakes a worker
+int TrackerService::queue(Channel *ch, std::unique_lock<std::mutex> &guard)
+{
+	in_flight++;
+	if (!ch->scheduled)
+	{
+		ch->scheduled = true;
+		ready.push_back(ch);
+		guard.unlock();
+		work_cv.notify_one();
+	}
+	return 0;
+}
+
+int TrackerService::submit(int channel, const track_object_t *objects, int n_objects, void *frame_user)
+{
+	std::unique_lock<std::mutex> guard(lock);
+	if (stop)
+		return -1;
+
+	Channel *ch = get_channel(channel);
+	if (max_pending > 0 && (int)ch->pending.size() >= max_pending)
+		return -1;
+
+	ch->pending.emplace_back();
+	Frame &frame = ch->pending.back();
+	if (!spare.empty())
+	{
+		frame.objects.swap(spare.back());
+		spare.pop_back();
+	}
+	frame.predict = objects == nullptr;
+	frame.user = frame_user;
+	frame.result = nullptr;
+	frame.done = nullptr;
+	if (objects)
+		frame.objects.assign(objects, objects + std::max(n_objects, 0));
+	else
+		frame.objects.clear();
+
+	ch->frames++;
+	ch->since_detect = frame.predict ? ch->since_detect + 1 : 0;
+	return queue(ch, guard);
+}
+
+// The scheduler only sees a frame once a worker tracks it. With none of the channel's frames
+// outstanding its answer is exact, otherwise the predict frames submitted since the last detect
+// frame are counted against its interval
+int TrackerService::need_detect(int channel)
+{
+	std::lock_guard<std::mutex> guard(lock);
+	auto it = channels.find(channel);
+	if (it == channels.end())
+		return 1; // the default schedule detects the first frame
+	Channel *ch = it->second.get();
+	if (ch->frames == 0)
+		return ch->need_detect;
+	return ch->since_detect + 1 >= ch->interval;
+}
+
+// Control calls are queued on the strand like frames, not limited by max_pending, so they apply between
+// the frames submitted before and after them and never wait for the channel to go idle
+int TrackerService::call(int channel, std::function<int(bytetracker_t)> control, bool wait)
+{
+	std::unique_lock<std::mutex> guard(lock);
+	if (stop)
+		return -1;
+
+	Channel *ch = get_channel(channel);
+	int result = -1;
+	bool done = false;
+	ch->pending.emplace_back();
+	Frame &frame = ch->pending.back();
+	frame.predict = false;
+	frame.user = nullptr;
+	frame.control = std::move(control);
+	frame.result = wait ? &result : nullptr;
+	frame.done = wait ? &done : nullptr;
+	queue(ch, guard);
+	if (!wait)
+		return 0;
+
+	if (!guard.owns_lock())
+		guard.lock();
+	idle_cv.wait(guard, [&done] { return done; });
+	return result;
+}
+
+int TrackerService::set_schedule(int channel, const bytetrack_schedule_t &schedule)
+{
+	return call(channel, [schedule](bytetracker_t tracker) {
+		bytetracker_set_schedule(tracker, &schedule);
+		return 0;
+	}, false);
+}
+
+int TrackerService::set_reid(int channel, const bytetrack_reid_t &reid)
+{
+	return call(channel, [reid](bytetracker_t tracker) {
+		bytetracker_set_reid(tracker, &reid);
+		return 0;
+	}, false);
+}
+
+void TrackerService::get_health(int channel, bytetrack_health_t &health)
+{
+	std::lock_guard<std::mutex> guard(lock);
+	auto it = channels.find(channel);
+	if (it == channels.end())
+		memset(&health, 0, sizeof(health));
+	else
+		health = it->second->health;
+}
+
+int TrackerService::snapshot_file(int channel, const char *path)
+{
+	std::string file(path);
+	return call(channel, [file](bytetracker_t tracker) {
+		return bytetracker_snapshot_file(tracker, file.c_str());
+	}, true);
+}
+
+int TrackerService::restore_file(int channel, const char *path)
+{
+	std::string file(path);
+	return call(channel, [file](bytetracker_t tracker) {
+		return bytetracker_restore_file(tracker, file.c_str());
+	}, true);
+}
+
+void TrackerService::flush()
+{
+	std::unique_lock<std::mutex> guard(lock);
+	idle_cv.wait(guard, [this] { return in_flight == 0; });
+}
+
+void TrackerService::worker()
+{
+	std::vector<track_object_t> tracks(TRACK_OBJETCS_MAX_SIZE);
+	std::unique_lock<std::mutex> guard(lock);
+	for (;;)
+	{
+		work_cv.wait(guard, [this] { return stop || !ready.empty(); });
+		if (ready.empty())
+			break;
+
+		// the channel is held until its frame is delivered, no other worker touches its trackers
+		Channel *ch = ready.front();
+		ready.pop_front();
+		Frame frame = std::move(ch->pending.front());
+		ch->pending.pop_front();
+		guard.unlock();
+
+		int n_tracks = 0;
+		int result = 0;
+		bytetrack_health_t health;
+		if (frame.control)
+		{
+			result = frame.control(ch->tracker);
+		}
+		else
+		{
+			if (frame.predict)
+				n_tracks = bytetracker_predict_span(ch->tracker, tracks.data(), (int)tracks.size());
+			else
+				n_tracks = bytetracker_track_span(ch->tracker, frame.objects.data(), (int)frame.objects.size(), tracks.data(), (int)tracks.size());
+			if (n_tracks > (int)tracks.size())
+			{
+				tracks.resize(n_tracks);
+				bytetracker_get_tracks(ch->tracker, tracks.data(), n_tracks);
+			}
+			if (callback)
+				callback(ch->id, tracks.data(), n_tracks, frame.user, user);
+			bytetracker_get_health(ch->tracker, &health);
+		}
+		int need = bytetracker_need_detect(ch->tracker);
+		int interval = bytetracker_get_interval(ch->tracker);
+
+		guard.lock();
+		ch->need_detect = need;
+		ch->interval = interval;
+		bool answered = false;
+		if (frame.control)
+		{
+			if (frame.done)
+			{
+				*frame.result = result;
+				*frame.done = true;
+				answered = true;
+			}
+		}
+		else
+		{
+			ch->health = health;
+			ch->frames--;
+			spare.push_back(std::move(frame.objects));
+		}
+		in_flight--;
+		if (ch->pending.empty())
+		{
+			ch->scheduled = false;
+		}
+		else
+		{
+			// back of the queue, so a busy channel does not starve the others
+			ready.push_back(ch);
+			work_cv.notify_one();
+		}
+		if (answered || in_flight == 0 || !ch->scheduled)
+			idle_cv.notify_all();
+	}
+}
\ No newline at end of file
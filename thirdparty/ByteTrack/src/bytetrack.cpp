@@ -1,13 +1,37 @@
 #include "bytetrack.h"
 #include "BYTETracker.h"
-#include "map"
+#include "DetectScheduler.h"
+#include "TrackerService.h"
+#include "MotionEstimator.h"
+#include "Snapshot.h"
+#include "cstring"
 #include "memory"
+#include "cmath"
+#include "algorithm"
+#include "chrono"
 
 struct bytetrack_handle_t
 {
-    std::map<int, std::shared_ptr<BYTETracker>> m_label_tracker;
+    // one tracker per label, labels sorted so the tracks come out in label order
+    std::vector<int> labels;
+    std::vector<std::unique_ptr<BYTETracker>> label_trackers;
     int frame_rate;
     int track_buffer;
+    DetectScheduler scheduler;
+    bytetrack_reid_t reid;
+    std::unique_ptr<MotionEstimator> gmc;
+    MotionEstimator::Motion motion;      // caller given, for the next frame
+    MotionEstimator::Motion last_motion; // applied on the last frame
+    long long frames;
+    float frame_us, frame_us_avg, frame_us_max;
+    SnapshotFile snapshot_file;
+    std::vector<unsigned char> snapshot_buf;
+
+    // per call buffers, kept for their capacity
+    std::vector<int> det_label;
+    std::vector<int> label_start, label_fill;
+    std::vector<track_object_t> sorted_objs;
+    std::vector<track_object_t> track_objs;
 };
 
 bytetracker_t bytetracker_create(int frame_rate, int track_buffer)
@@ -15,6 +39,13 @@ bytetracker_t bytetracker_create(int frame_rate, int track_buffer)
     bytetrack_handle_t *handle = new bytetrack_handle_t;
     handle->frame_rate = frame_rate;
     handle->track_buffer = track_buffer;
+    memset(&handle->reid, 0, sizeof(handle->reid));
+    handle->frames = 0;
+    handle->frame_us = 0;
+    handle->frame_us_avg = 0;
+    handle->frame_us_max = 0;
+    handle->motion = MotionEstimator::identity();
+    handle->last_motion = MotionEstimator::identity();
     return handle;
 }
 void bytetracker_release(bytetracker_t *ptracker)
@@ -27,49 +58,399 @@ void bytetracker_release(bytetracker_t *ptracker)
         *ptracker = nullptr;
     }
 }
-void _bytetracker_track(BYTETracker *tracker, std::vector<track_object_t> &objs, std::vector<track_object_t> &track_objects, int label)
+
+int _bytetracker_find_label(const bytetrack_handle_t *tracker, int label)
+{
+    return (int)(std::lower_bound(tracker->labels.begin(), tracker->labels.end(), label) - tracker->labels.begin());
+}
+
+void _bytetracker_add_label(bytetrack_handle_t *tracker, int label)
 {
-    auto track_results = tracker->update(objs.data(), objs.size());
-    // objs->n_track_objects = track_results.size() > TRACK_OBJETCS_MAX_SIZE ? TRACK_OBJETCS_MAX_SIZE : track_results.size();
+    int pos = _bytetracker_find_label(tracker, label);
+    if (pos < (int)tracker->labels.size() && tracker->labels[pos] == label)
+        return;
+    tracker->labels.insert(tracker->labels.begin() + pos, label);
+    tracker->label_trackers.insert(tracker->label_trackers.begin() + pos,
+                                   std::unique_ptr<BYTETracker>(new BYTETracker(tracker->frame_rate, tracker->track_buffer)));
+    tracker->label_trackers[pos]->set_reid(tracker->reid);
+}
 
+void _bytetracker_output(const std::vector<STrack *> &track_results, std::vector<track_object_t> &track_objects, int label, ScheduleStats &stats)
+{
     for (size_t i = 0; i < track_results.size(); i++)
     {
+        // center velocity of the Kalman state over the box height
+        const float *mean = track_results[i]->kalman.mean;
+        float speed = std::sqrt(mean[4] * mean[4] + mean[5] * mean[5]) / std::max(mean[3], 1.f);
+        stats.max_speed = std::max(stats.max_speed, speed);
+
         track_object_t obj = {0};
-        obj.rect.x = track_results[i].tlwh[0];
-        obj.rect.y = track_results[i].tlwh[1];
-        obj.rect.width = track_results[i].tlwh[2];
-        obj.rect.height = track_results[i].tlwh[3];
-        obj.prob = track_results[i].score;
-        obj.track_id = track_results[i].track_id;
-        obj.user_data = track_results[i].user_data;
+        obj.rect.x = track_results[i]->tlwh[0];
+        obj.rect.y = track_results[i]->tlwh[1];
+        obj.rect.width = track_results[i]->tlwh[2];
+        obj.rect.height = track_results[i]->tlwh[3];
+        obj.prob = track_results[i]->score;
+        obj.track_id = track_results[i]->track_id;
+        obj.user_data = track_results[i]->user_data;
         obj.label = label;
         track_objects.push_back(obj);
     }
+    stats.num_tracks += (int)track_results.size();
+}
+
+void _bytetracker_stats(BYTETracker *tracker, ScheduleStats &stats)
+{
+    stats.num_unconfirmed += tracker->num_unconfirmed();
+    stats.num_lost += tracker->num_lost();
+}
+
+// camera motion since the previous frame, estimated then caller given, moves every track before association
+void _bytetracker_motion(bytetrack_handle_t *tracker)
+{
+    MotionEstimator::Motion m = tracker->motion;
+    if (tracker->gmc)
+        m = MotionEstimator::compose(tracker->gmc->take(), m);
+    tracker->motion = MotionEstimator::identity();
+    tracker->last_motion = m;
+    if (!m.valid)
+        return;
+    for (size_t k = 0; k < tracker->label_trackers.size(); k++)
+    {
+        tracker->label_trackers[k]->apply_motion(m.scale, m.tx, m.ty);
+    }
+}
+
+void _bytetracker_frame_cost(bytetrack_handle_t *tracker, std::chrono::steady_clock::time_point start)
+{
+    float us = std::chrono::duration<float, std::micro>(std::chrono::steady_clock::now() - start).count();
+    tracker->frame_us = us;
+    tracker->frame_us_avg = tracker->frames == 0 ? us : tracker->frame_us_avg + (us - tracker->frame_us_avg) / 32;
+    tracker->frame_us_max = std::max(tracker->frame_us_max, us);
+    tracker->frames++;
+}
+
+int bytetracker_get_tracks(bytetracker_t _tracker, track_object_t *tracks, int max_tracks)
+{
+    bytetrack_handle_t *tracker = (bytetrack_handle_t *)_tracker;
+    int n = std::min(std::max(max_tracks, 0), (int)tracker->track_objs.size());
+    if (n > 0)
+        memcpy(tracks, tracker->track_objs.data(), n * sizeof(track_object_t));
+    return (int)tracker->track_objs.size();
+}
+
+int bytetracker_track_span(bytetracker_t _tracker, const track_object_t *objects, int n_objects, track_object_t *tracks, int max_tracks)
+{
+    bytetrack_handle_t *tracker = (bytetrack_handle_t *)_tracker;
+    auto start = std::chrono::steady_clock::now();
+    n_objects = std::max(n_objects, 0);
+
+    // stable counting sort of the detections by label
+    for (int i = 0; i < n_objects; i++)
+    {
+        if (i == 0 || objects[i].label != objects[i - 1].label)
+            _bytetracker_add_label(tracker, objects[i].label);
+    }
+    int n_labels = (int)tracker->labels.size();
+    tracker->det_label.resize(n_objects);
+    tracker->label_start.assign(n_labels + 1, 0);
+    for (int i = 0; i < n_objects; i++)
+    {
+        int k = (i > 0 && objects[i].label == objects[i - 1].label) ? tracker->det_label[i - 1] : _bytetracker_find_label(tracker, objects[i].label);
+        tracker->det_label[i] = k;
+        tracker->label_start[k + 1]++;
+    }
+    for (int k = 0; k < n_labels; k++)
+    {
+        tracker->label_start[k + 1] += tracker->label_start[k];
+    }
+    tracker->label_fill.assign(tracker->label_start.begin(), tracker->label_start.end() - 1);
+    tracker->sorted_objs.resize(n_objects);
+    for (int i = 0; i < n_objects; i++)
+    {
+        tracker->sorted_objs[tracker->label_fill[tracker->det_label[i]]++] = objects[i];
+    }
+
+    _bytetracker_motion(tracker);
+
+    // labels without detections on this frame still advance, so their tracks get lost and age
+    ScheduleStats stats = {0};
+    tracker->track_objs.clear();
+    for (int k = 0; k < n_labels; k++)
+    {
+        BYTETracker *label_tracker = tracker->label_trackers[k].get();
+        const track_object_t *label_objs = tracker->sorted_objs.data() + tracker->label_start[k];
+        const auto &track_results = label_tracker->update(label_objs, tracker->label_start[k + 1] - tracker->label_start[k]);
+        _bytetracker_output(track_results, tracker->track_objs, tracker->labels[k], stats);
+        _bytetracker_stats(label_tracker, stats);
+    }
+    tracker->scheduler.on_detect(stats);
+    _bytetracker_frame_cost(tracker, start);
+
+    return bytetracker_get_tracks(_tracker, tracks, max_tracks);
+}
+
+int bytetracker_predict_span(bytetracker_t _tracker, track_object_t *tracks, int max_tracks)
+{
+    bytetrack_handle_t *tracker = (bytetrack_handle_t *)_tracker;
+    auto start = std::chrono::steady_clock::now();
+    _bytetracker_motion(tracker);
+
+    ScheduleStats stats = {0};
+    tracker->track_objs.clear();
+    for (size_t k = 0; k < tracker->labels.size(); k++)
+    {
+        BYTETracker *label_tracker = tracker->label_trackers[k].get();
+        const auto &track_results = label_tracker->predict();
+        _bytetracker_output(track_results, tracker->track_objs, tracker->labels[k], stats);
+        _bytetracker_stats(label_tracker, stats);
+    }
+    tracker->scheduler.on_predict(stats);
+    _bytetracker_frame_cost(tracker, start);
+
+    return bytetracker_get_tracks(_tracker, tracks, max_tracks);
+}
+
+void bytetracker_track(bytetracker_t tracker, bytetrack_object_t *objs)
+{
+    int n = bytetracker_track_span(tracker, objs->objects, objs->n_objects, objs->track_objects, TRACK_OBJETCS_MAX_SIZE);
+    objs->n_track_objects = std::min(n, TRACK_OBJETCS_MAX_SIZE);
+}
+
+void bytetracker_predict(bytetracker_t tracker, bytetrack_object_t *objs)
+{
+    int n = bytetracker_predict_span(tracker, objs->track_objects, TRACK_OBJETCS_MAX_SIZE);
+    objs->n_track_objects = std::min(n, TRACK_OBJETCS_MAX_SIZE);
+}
+
+void bytetracker_set_reid(bytetracker_t _tracker, const bytetrack_reid_t *reid)
+{
+    bytetrack_handle_t *tracker = (bytetrack_handle_t *)_tracker;
+    tracker->reid = *reid;
+    for (size_t k = 0; k < tracker->label_trackers.size(); k++)
+    {
+        tracker->label_trackers[k]->set_reid(*reid);
+    }
+}
+
+void bytetracker_set_gmc(bytetracker_t _tracker, int work_width)
+{
+    bytetrack_handle_t *tracker = (bytetrack_handle_t *)_tracker;
+    if (work_width > 0)
+        tracker->gmc.reset(new MotionEstimator(work_width));
+    else
+        tracker->gmc.reset();
+}
+
+void bytetracker_push_frame(bytetracker_t _tracker, const unsigned char *luma, int width, int height, int stride)
+{
+    bytetrack_handle_t *tracker = (bytetrack_handle_t *)_tracker;
+    if (tracker->gmc && luma && width > 0 && height > 0)
+        tracker->gmc->push(luma, width, height, stride);
+}
+
+void bytetracker_apply_motion(bytetracker_t _tracker, float scale, float tx, float ty)
+{
+    bytetrack_handle_t *tracker = (bytetrack_handle_t *)_tracker;
+    MotionEstimator::Motion m;
+    m.scale = scale;
+    m.tx = tx;
+    m.ty = ty;
+    m.valid = true;
+    tracker->motion = MotionEstimator::compose(tracker->motion, m);
 }
 
-void bytetracker_track(bytetracker_t _tracker, bytetrack_object_t *objs)
+int bytetracker_get_motion(bytetracker_t _tracker, float *scale, float *tx, float *ty)
 {
     bytetrack_handle_t *tracker = (bytetrack_handle_t *)_tracker;
+    const MotionEstimator::Motion &m = tracker->last_motion;
+    if (scale)
+        *scale = m.scale;
+    if (tx)
+        *tx = m.tx;
+    if (ty)
+        *ty = m.ty;
+    return m.valid ? 1 : 0;
+}
 
-    std::map<int, std::vector<track_object_t>> m_label_objs;
-    std::vector<track_object_t> m_track_objs;
-    m_track_objs.reserve(TRACK_OBJETCS_MAX_SIZE);
+void bytetracker_get_health(bytetracker_t _tracker, bytetrack_health_t *health)
+{
+    bytetrack_handle_t *tracker = (bytetrack_handle_t *)_tracker;
+    memset(health, 0, sizeof(*health));
+    for (size_t k = 0; k < tracker->label_trackers.size(); k++)
+    {
+        const BYTETracker *label_tracker = tracker->label_trackers[k].get();
+        health->num_tracked += label_tracker->num_tracked();
+        health->num_unconfirmed += label_tracker->num_unconfirmed();
+        health->num_lost += label_tracker->num_lost();
+        health->num_removed += label_tracker->num_removed();
+        health->total_removed += label_tracker->total_removed();
+        health->num_slots += label_tracker->num_slots();
+    }
+    health->frames = tracker->frames;
+    health->frame_us = tracker->frame_us;
+    health->frame_us_avg = tracker->frame_us_avg;
+    health->frame_us_max = tracker->frame_us_max;
+}
 
-    for (int i = 0; i < objs->n_objects; i++)
+// labels in order, each followed by its tracker
+void _bytetracker_save(const bytetrack_handle_t *tracker, std::vector<unsigned char> &buf)
+{
+    buf.clear();
+    SnapshotWriter out(buf);
+    out.put<uint32_t>(BYTETRACK_SNAPSHOT_MAGIC);
+    out.put<uint32_t>(BYTETRACK_SNAPSHOT_VERSION);
+    out.put<int32_t>(STrack::last_id());
+    out.put<int32_t>((int32_t)tracker->labels.size());
+    for (size_t k = 0; k < tracker->labels.size(); k++)
     {
-        m_label_objs[objs->objects[i].label].push_back(objs->objects[i]);
+        out.put<int32_t>(tracker->labels[k]);
+        tracker->label_trackers[k]->save(out);
     }
+}
+
+// the trackers are built aside and only replace the current ones once the whole snapshot loaded
+int _bytetracker_load(bytetrack_handle_t *tracker, const unsigned char *data, size_t size)
+{
+    SnapshotReader in(data, size);
+    uint32_t magic, version;
+    int32_t last_id, n_labels;
+    if (!in.get(magic) || !in.get(version) || magic != BYTETRACK_SNAPSHOT_MAGIC || version != BYTETRACK_SNAPSHOT_VERSION)
+        return -1;
+    if (!in.get(last_id) || !in.get(n_labels) || n_labels < 0)
+        return -1;
 
-    for (auto it : m_label_objs)
+    std::vector<int> labels;
+    std::vector<std::unique_ptr<BYTETracker>> label_trackers;
+    for (int k = 0; k < n_labels; k++)
     {
-        if (tracker->m_label_tracker[it.first].get() == nullptr)
-        {
-            tracker->m_label_tracker[it.first].reset(new BYTETracker(tracker->frame_rate, tracker->track_buffer));
-        }
+        int32_t label;
+        if (!in.get(label) || (k > 0 && label <= labels.back()))
+            return -1;
+        std::unique_ptr<BYTETracker> label_tracker(new BYTETracker(tracker->frame_rate, tracker->track_buffer));
+        label_tracker->set_reid(tracker->reid);
+        if (!label_tracker->load(in))
+            return -1;
+        labels.push_back(label);
+        label_trackers.push_back(std::move(label_tracker));
+    }
+    if (!in.done())
+        return -1;
+
+    tracker->labels.swap(labels);
+    tracker->label_trackers.swap(label_trackers);
+    tracker->track_objs.clear();
+    STrack::reserve_ids(last_id);
+    return 0;
+}
+
+int bytetracker_snapshot(bytetracker_t _tracker, void *buf, int size)
+{
+    bytetrack_handle_t *tracker = (bytetrack_handle_t *)_tracker;
+    _bytetracker_save(tracker, tracker->snapshot_buf);
+    int n = (int)tracker->snapshot_buf.size();
+    if (buf && size >= n)
+        memcpy(buf, tracker->snapshot_buf.data(), n);
+    return n;
+}
+
+int bytetracker_restore(bytetracker_t _tracker, const void *buf, int size)
+{
+    bytetrack_handle_t *tracker = (bytetrack_handle_t *)_tracker;
+    if (!buf || size <= 0)
+        return -1;
+    return _bytetracker_load(tracker, (const unsigned char *)buf, size);
+}
+
+int bytetracker_snapshot_file(bytetracker_t _tracker, const char *path)
+{
+    bytetrack_handle_t *tracker = (bytetrack_handle_t *)_tracker;
+    _bytetracker_save(tracker, tracker->snapshot_buf);
+    return tracker->snapshot_file.write(path, tracker->snapshot_buf.data(), tracker->snapshot_buf.size());
+}
+
+int bytetracker_restore_file(bytetracker_t _tracker, const char *path)
+{
+    bytetrack_handle_t *tracker = (bytetrack_handle_t *)_tracker;
+    if (SnapshotFile::read(path, tracker->snapshot_buf) != 0)
+        return -1;
+    return _bytetracker_load(tracker, tracker->snapshot_buf.data(), tracker->snapshot_buf.size());
+}
+
+void bytetracker_set_schedule(bytetracker_t _tracker, const bytetrack_schedule_t *schedule)
+{
+    bytetrack_handle_t *tracker = (bytetrack_handle_t *)_tracker;
+    tracker->scheduler.set_config(*schedule);
+}
+
+void bytetracker_set_npu_load(bytetracker_t _tracker, float load)
+{
+    bytetrack_handle_t *tracker = (bytetrack_handle_t *)_tracker;
+    tracker->scheduler.set_npu_load(load);
+}
 
-        _bytetracker_track(tracker->m_label_tracker[it.first].get(), it.second, m_track_objs, it.first);
+int bytetracker_need_detect(bytetracker_t _tracker)
+{
+    bytetrack_handle_t *tracker = (bytetrack_handle_t *)_tracker;
+    return tracker->scheduler.need_detect() ? 1 : 0;
+}
+
+int bytetracker_get_interval(bytetracker_t _tracker)
+{
+    bytetrack_handle_t *tracker = (bytetrack_handle_t *)_tracker;
+    return tracker->scheduler.interval();
+}
+
+bytetrack_service_t bytetrack_service_create(int num_workers, int frame_rate, int track_buffer, int max_pending,
+                                             bytetrack_service_cb_t callback, void *user)
+{
+    return new TrackerService(num_workers, frame_rate, track_buffer, max_pending, callback, user);
+}
+
+void bytetrack_service_release(bytetrack_service_t *pservice)
+{
+    if (pservice)
+    {
+        delete (TrackerService *)*pservice;
+        *pservice = nullptr;
     }
+}
+
+int bytetrack_service_submit(bytetrack_service_t service, int channel, const track_object_t *objects, int n_objects, void *frame_user)
+{
+    return ((TrackerService *)service)->submit(channel, objects, n_objects, frame_user);
+}
+
+int bytetrack_service_need_detect(bytetrack_service_t service, int channel)
+{
+    return ((TrackerService *)service)->need_detect(channel);
+}
+
+void bytetrack_service_set_schedule(bytetrack_service_t service, int channel, const bytetrack_schedule_t *schedule)
+{
+    ((TrackerService *)service)->set_schedule(channel, *schedule);
+}
+
+void bytetrack_service_set_reid(bytetrack_service_t service, int channel, const bytetrack_reid_t *reid)
+{
+    ((TrackerService *)service)->set_reid(channel, *reid);
+}
+
+void bytetrack_service_get_health(bytetrack_service_t service, int channel, bytetrack_health_t *health)
+{
+    ((TrackerService *)service)->get_health(channel, *health);
+}
+
+int bytetrack_service_snapshot_file(bytetrack_service_t service, int channel, const char *path)
+{
+    return ((TrackerService *)service)->snapshot_file(channel, path);
+}
 
-    objs->n_track_objects = m_track_objs.size() > TRACK_OBJETCS_MAX_SIZE ? TRACK_OBJETCS_MAX_SIZE : m_track_objs.size();
-    memcpy(&objs->track_objects[0], m_track_objs.data(), objs->n_track_objects * sizeof(track_object_t));
+int bytetrack_service_restore_file(bytetrack_service_t service, int channel, const char *path)
+{
+    return ((TrackerService *)service)->restore_file(channel, path);
+}
+
+void bytetrack_service_flush(bytetrack_service_t service)
+{
+    ((TrackerService *)service)->flush();
 }
\ No newline at end of file
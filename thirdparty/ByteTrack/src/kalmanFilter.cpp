@@ -1,6 +1,8 @@
 #include "kalmanFilter.h"
 #include <Eigen/Cholesky>
 
+#include "SimdDefs.h"
+
 namespace byte_kalman
 {
 	const double KalmanFilter::chi2inv95[10] = {
@@ -149,4 +151,159 @@ namespace byte_kalman
 		auto square_maha = zz.colwise().sum();
 		return square_maha;
 	}
+
+	void KalmanFilter::initiate(const float *xyah, KalmanState &state)
+	{
+		const float std_pos = 2 * _std_weight_position * xyah[3];
+		const float std_vel = 10 * _std_weight_velocity * xyah[3];
+		const float std_a = 1e-2f;
+		const float std_va = 1e-5f;
+
+		for (int i = 0; i < 4; i++)
+		{
+			state.mean[i] = xyah[i];
+			state.mean[4 + i] = 0;
+			state.pv[i] = 0;
+		}
+		state.pp[0] = state.pp[1] = state.pp[3] = std_pos * std_pos;
+		state.pp[2] = std_a * std_a;
+		state.vv[0] = state.vv[1] = state.vv[3] = std_vel * std_vel;
+		state.vv[2] = std_va * std_va;
+	}
+
+	// Per block with F = [1 1; 0 1]: x += v, P = F P F^T + Q
+	void KalmanFilter::predict(KalmanState &state)
+	{
+		const float std_pos = _std_weight_position * state.mean[3];
+		const float std_vel = _std_weight_velocity * state.mean[3];
+		const float std_a = 1e-2f;
+		const float std_va = 1e-5f;
+		alignas(16) const float q_pos[4] = { std_pos * std_pos, std_pos * std_pos, std_a * std_a, std_pos * std_pos };
+		alignas(16) const float q_vel[4] = { std_vel * std_vel, std_vel * std_vel, std_va * std_va, std_vel * std_vel };
+
+#if defined(BYTETRACK_SIMD_NEON)
+		float32x4_t x = vld1q_f32(state.mean);
+		float32x4_t v = vld1q_f32(state.mean + 4);
+		float32x4_t pp = vld1q_f32(state.pp);
+		float32x4_t pv = vld1q_f32(state.pv);
+		float32x4_t vv = vld1q_f32(state.vv);
+		float32x4_t pv_vv = vaddq_f32(pv, vv);
+		vst1q_f32(state.mean, vaddq_f32(x, v));
+		vst1q_f32(state.pp, vaddq_f32(vaddq_f32(vaddq_f32(pp, pv), pv_vv), vld1q_f32(q_pos)));
+		vst1q_f32(state.pv, pv_vv);
+		vst1q_f32(state.vv, vaddq_f32(vv, vld1q_f32(q_vel)));
+#elif defined(BYTETRACK_SIMD_SSE2)
+		__m128 x = _mm_load_ps(state.mean);
+		__m128 v = _mm_load_ps(state.mean + 4);
+		__m128 pp = _mm_load_ps(state.pp);
+		__m128 pv = _mm_load_ps(state.pv);
+		__m128 vv = _mm_load_ps(state.vv);
+		__m128 pv_vv = _mm_add_ps(pv, vv);
+		_mm_store_ps(state.mean, _mm_add_ps(x, v));
+		_mm_store_ps(state.pp, _mm_add_ps(_mm_add_ps(_mm_add_ps(pp, pv), pv_vv), _mm_load_ps(q_pos)));
+		_mm_store_ps(state.pv, pv_vv);
+		_mm_store_ps(state.vv, _mm_add_ps(vv, _mm_load_ps(q_vel)));
+#else
+		for (int i = 0; i < 4; i++)
+		{
+			float pv_vv = state.pv[i] + state.vv[i];
+			state.mean[i] += state.mean[4 + i];
+			state.pp[i] = state.pp[i] + state.pv[i] + pv_vv + q_pos[i];
+			state.pv[i] = pv_vv;
+			state.vv[i] += q_vel[i];
+		}
+#endif
+	}
+
+	// H = [1 0] per block, so the innovation covariance S = pp + r is diagonal and the gain is [pp pv] / S
+	void KalmanFilter::update(KalmanState &state, const float *xyah)
+	{
+		const float std_pos = _std_weight_position * state.mean[3];
+		const float std_a = 1e-1f;
+		alignas(16) const float r[4] = { std_pos * std_pos, std_pos * std_pos, std_a * std_a, std_pos * std_pos };
+
+#if defined(BYTETRACK_SIMD_NEON)
+		float32x4_t x = vld1q_f32(state.mean);
+		float32x4_t v = vld1q_f32(state.mean + 4);
+		float32x4_t pp = vld1q_f32(state.pp);
+		float32x4_t pv = vld1q_f32(state.pv);
+		float32x4_t vv = vld1q_f32(state.vv);
+		float32x4_t s = vaddq_f32(pp, vld1q_f32(r));
+#if defined(__aarch64__)
+		float32x4_t inv_s = vdivq_f32(vdupq_n_f32(1.f), s);
+#else
+		float32x4_t inv_s = vrecpeq_f32(s);
+		inv_s = vmulq_f32(inv_s, vrecpsq_f32(s, inv_s));
+		inv_s = vmulq_f32(inv_s, vrecpsq_f32(s, inv_s));
+#endif
+		float32x4_t kp = vmulq_f32(pp, inv_s);
+		float32x4_t kv = vmulq_f32(pv, inv_s);
+		float32x4_t y = vsubq_f32(vld1q_f32(xyah), x);
+		vst1q_f32(state.mean, vmlaq_f32(x, kp, y));
+		vst1q_f32(state.mean + 4, vmlaq_f32(v, kv, y));
+		vst1q_f32(state.pp, vmlsq_f32(pp, kp, pp));
+		vst1q_f32(state.pv, vmlsq_f32(pv, kp, pv));
+		vst1q_f32(state.vv, vmlsq_f32(vv, kv, pv));
+#elif defined(BYTETRACK_SIMD_SSE2)
+		__m128 x = _mm_load_ps(state.mean);
+		__m128 v = _mm_load_ps(state.mean + 4);
+		__m128 pp = _mm_load_ps(state.pp);
+		__m128 pv = _mm_load_ps(state.pv);
+		__m128 vv = _mm_load_ps(state.vv);
+		__m128 s = _mm_add_ps(pp, _mm_load_ps(r));
+		__m128 kp = _mm_div_ps(pp, s);
+		__m128 kv = _mm_div_ps(pv, s);
+		__m128 y = _mm_sub_ps(_mm_loadu_ps(xyah), x);
+		_mm_store_ps(state.mean, _mm_add_ps(x, _mm_mul_ps(kp, y)));
+		_mm_store_ps(state.mean + 4, _mm_add_ps(v, _mm_mul_ps(kv, y)));
+		_mm_store_ps(state.pp, _mm_sub_ps(pp, _mm_mul_ps(kp, pp)));
+		_mm_store_ps(state.pv, _mm_sub_ps(pv, _mm_mul_ps(kp, pv)));
+		_mm_store_ps(state.vv, _mm_sub_ps(vv, _mm_mul_ps(kv, pv)));
+#else
+		for (int i = 0; i < 4; i++)
+		{
+			float s = state.pp[i] + r[i];
+			float kp = state.pp[i] / s;
+			float kv = state.pv[i] / s;
+			float y = xyah[i] - state.mean[i];
+			state.mean[i] += kp * y;
+			state.mean[4 + i] += kv * y;
+			state.vv[i] -= kv * state.pv[i];
+			state.pv[i] -= kp * state.pv[i];
+			state.pp[i] -= kp * state.pp[i];
+		}
+#endif
+	}
+
+	float KalmanFilter::gating_distance(const KalmanState &state, const float *xyah)
+	{
+		const float std_pos = _std_weight_position * state.mean[3];
+		const float std_a = 1e-1f;
+		const float r[4] = { std_pos * std_pos, std_pos * std_pos, std_a * std_a, std_pos * std_pos };
+
+		float d = 0;
+		for (int i = 0; i < 4; i++)
+		{
+			float y = xyah[i] - state.mean[i];
+			d += y * y / (state.pp[i] + r[i]);
+		}
+		return d;
+	}
+
+	void KalmanFilter::warp(KalmanState &state, float scale, float tx, float ty)
+	{
+		// x, y and h scale with their velocities and variances, the aspect ratio does not change
+		const float lane[4] = { scale, scale, 1.f, scale };
+		state.mean[0] = scale * state.mean[0] + tx;
+		state.mean[1] = scale * state.mean[1] + ty;
+		state.mean[3] *= scale;
+		for (int i = 0; i < 4; i++)
+		{
+			const float s2 = lane[i] * lane[i];
+			state.mean[4 + i] *= lane[i];
+			state.pp[i] *= s2;
+			state.pv[i] *= s2;
+			state.vv[i] *= s2;
+		}
+	}
 }
\ No newline at end of file
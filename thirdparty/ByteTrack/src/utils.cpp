@@ -1,427 +1,148 @@
 #include "BYTETracker.h"
-#include "lapjv.h"
-#include "map"
+#include <algorithm>
 
-std::vector<STrack *> BYTETracker::joint_stracks(std::vector<STrack *> &tlista, std::vector<STrack> &tlistb)
+unsigned int BYTETracker::next_stamp()
 {
-	std::map<int, int> exists;
-	std::vector<STrack *> res;
-	for (size_t i = 0; i < tlista.size(); i++)
+	if (++stamp_gen == 0)
 	{
-		exists.insert(std::pair<int, int>(tlista[i]->track_id, 1));
-		res.push_back(tlista[i]);
+		std::fill(slot_stamp.begin(), slot_stamp.end(), 0);
+		stamp_gen = 1;
 	}
-	for (size_t i = 0; i < tlistb.size(); i++)
-	{
-		int tid = tlistb[i].track_id;
-		if (!exists[tid] || exists.count(tid) == 0)
-		{
-			exists[tid] = 1;
-			res.push_back(&tlistb[i]);
-		}
-	}
-	return res;
+	return stamp_gen;
 }
 
-std::vector<STrack> BYTETracker::joint_stracks(std::vector<STrack> &tlista, std::vector<STrack> &tlistb)
+void BYTETracker::joint_stracks(const std::vector<int> &tlista, const std::vector<int> &tlistb, std::vector<int> &res)
 {
-	std::map<int, int> exists;
-	std::vector<STrack> res;
+	unsigned int stamp = next_stamp();
+	res.clear();
 	for (size_t i = 0; i < tlista.size(); i++)
 	{
-		exists.insert(std::pair<int, int>(tlista[i].track_id, 1));
+		slot_stamp[tlista[i]] = stamp;
 		res.push_back(tlista[i]);
 	}
 	for (size_t i = 0; i < tlistb.size(); i++)
 	{
-		int tid = tlistb[i].track_id;
-		if (!exists[tid] || exists.count(tid) == 0)
+		if (slot_stamp[tlistb[i]] != stamp)
 		{
-			exists[tid] = 1;
+			slot_stamp[tlistb[i]] = stamp;
 			res.push_back(tlistb[i]);
 		}
 	}
-	return res;
 }
 
-std::vector<STrack> BYTETracker::sub_stracks(std::vector<STrack> &tlista, std::vector<STrack> &tlistb)
+// Order of tlista is kept, the lost list stays sorted by id
+void BYTETracker::sub_stracks(const std::vector<int> &tlista, const std::vector<int> &tlistb, std::vector<int> &res)
 {
-	std::map<int, STrack> stracks;
-	for (size_t i = 0; i < tlista.size(); i++)
-	{
-		stracks.insert(std::pair<int, STrack>(tlista[i].track_id, tlista[i]));
-	}
+	unsigned int stamp = next_stamp();
 	for (size_t i = 0; i < tlistb.size(); i++)
 	{
-		int tid = tlistb[i].track_id;
-		if (stracks.count(tid) != 0)
-		{
-			stracks.erase(tid);
-		}
+		slot_stamp[tlistb[i]] = stamp;
 	}
 
-	std::vector<STrack> res;
-	std::map<int, STrack>::iterator it;
-	for (it = stracks.begin(); it != stracks.end(); ++it)
+	res.clear();
+	for (size_t i = 0; i < tlista.size(); i++)
 	{
-		res.push_back(it->second);
+		if (slot_stamp[tlista[i]] != stamp)
+		{
+			slot_stamp[tlista[i]] = stamp;
+			res.push_back(tlista[i]);
+		}
 	}
-
-	return res;
 }
 
-void BYTETracker::remove_duplicate_stracks(std::vector<STrack> &resa, std::vector<STrack> &resb, std::vector<STrack> &stracksa, std::vector<STrack> &stracksb)
+void BYTETracker::sub_removed(const std::vector<int> &tlista, std::vector<int> &res)
 {
-	std::vector<std::vector<float>> pdist = iou_distance(stracksa, stracksb);
-	std::vector<std::pair<int, int>> pairs;
-	for (size_t i = 0; i < pdist.size(); i++)
+	res.clear();
+	for (size_t i = 0; i < tlista.size(); i++)
 	{
-		for (size_t j = 0; j < pdist[i].size(); j++)
+		if (!slot_removed[tlista[i]])
 		{
-			if (pdist[i][j] < 0.15)
-			{
-				pairs.push_back(std::pair<int, int>(i, j));
-			}
+			res.push_back(tlista[i]);
 		}
 	}
+}
 
-	std::vector<int> dupa, dupb;
-	for (size_t i = 0; i < pairs.size(); i++)
-	{
-		int timep = stracksa[pairs[i].first].frame_id - stracksa[pairs[i].first].start_frame;
-		int timeq = stracksb[pairs[i].second].frame_id - stracksb[pairs[i].second].start_frame;
-		if (timep > timeq)
-			dupb.push_back(pairs[i].second);
-		else
-			dupa.push_back(pairs[i].first);
-	}
-
-	for (size_t i = 0; i < stracksa.size(); i++)
-	{
-		std::vector<int>::iterator iter = find(dupa.begin(), dupa.end(), i);
-		if (iter == dupa.end())
-		{
-			resa.push_back(stracksa[i]);
-		}
-	}
+// sorted and tlistb (sorted here, it is the few newly lost tracks) merged by track id
+void BYTETracker::merge_by_id(const std::vector<int> &sorted, std::vector<int> &tlistb, std::vector<int> &res)
+{
+	const std::vector<STrack> &t = tracks;
+	std::sort(tlistb.begin(), tlistb.end(), [&t](int a, int b) { return t[a].track_id < t[b].track_id; });
 
-	for (size_t i = 0; i < stracksb.size(); i++)
+	res.clear();
+	size_t i = 0, j = 0;
+	while (i < sorted.size() && j < tlistb.size())
 	{
-		std::vector<int>::iterator iter = find(dupb.begin(), dupb.end(), i);
-		if (iter == dupb.end())
-		{
-			resb.push_back(stracksb[i]);
-		}
+		if (t[tlistb[j]].track_id < t[sorted[i]].track_id)
+			res.push_back(tlistb[j++]);
+		else
+			res.push_back(sorted[i++]);
 	}
+	res.insert(res.end(), sorted.begin() + i, sorted.end());
+	res.insert(res.end(), tlistb.begin() + j, tlistb.end());
 }
 
-void BYTETracker::linear_assignment(std::vector<std::vector<float>> &cost_matrix, int cost_matrix_size, int cost_matrix_size_size, float thresh,
-									std::vector<std::vector<int>> &matches, std::vector<int> &unmatched_a, std::vector<int> &unmatched_b)
+void BYTETracker::remove_duplicate_stracks(std::vector<int> &resa, std::vector<int> &resb, const std::vector<int> &stracksa, const std::vector<int> &stracksb)
 {
-	if (cost_matrix.size() == 0)
+	iou_distance(tracks, stracksa, tracks, stracksb, 0.15);
+	const std::vector<GatedAssignment::Edge> &edges = assignment.get_edges();
+	dup_pairs.clear();
+	for (size_t i = 0; i < edges.size(); i++)
 	{
-		for (int i = 0; i < cost_matrix_size; i++)
-		{
-			unmatched_a.push_back(i);
-		}
-		for (int i = 0; i < cost_matrix_size_size; i++)
-		{
-			unmatched_b.push_back(i);
-		}
-		return;
+		dup_pairs.push_back(std::pair<int, int>(edges[i].row, edges[i].col));
 	}
 
-	std::vector<int> rowsol;
-	std::vector<int> colsol;
-	float c = lapjv(cost_matrix, rowsol, colsol, true, thresh);
-	for (size_t i = 0; i < rowsol.size(); i++)
+	dupa.assign(stracksa.size(), 0);
+	dupb.assign(stracksb.size(), 0);
+	for (size_t i = 0; i < dup_pairs.size(); i++)
 	{
-		if (rowsol[i] >= 0)
-		{
-			std::vector<int> match;
-			match.push_back(i);
-			match.push_back(rowsol[i]);
-			matches.push_back(match);
-		}
+		const STrack &p = tracks[stracksa[dup_pairs[i].first]];
+		const STrack &q = tracks[stracksb[dup_pairs[i].second]];
+		int timep = p.frame_id - p.start_frame;
+		int timeq = q.frame_id - q.start_frame;
+		if (timep > timeq)
+			dupb[dup_pairs[i].second] = 1;
 		else
-		{
-			unmatched_a.push_back(i);
-		}
+			dupa[dup_pairs[i].first] = 1;
 	}
 
-	for (size_t i = 0; i < colsol.size(); i++)
+	resa.clear();
+	for (size_t i = 0; i < stracksa.size(); i++)
 	{
-		if (colsol[i] < 0)
+		if (!dupa[i])
 		{
-			unmatched_b.push_back(i);
+			resa.push_back(stracksa[i]);
 		}
 	}
-}
 
-std::vector<std::vector<float>> BYTETracker::ious(std::vector<std::vector<float>> &atlbrs, std::vector<std::vector<float>> &btlbrs)
-{
-	std::vector<std::vector<float>> ious;
-	if (atlbrs.size() * btlbrs.size() == 0)
-		return ious;
-
-	ious.resize(atlbrs.size());
-	for (size_t i = 0; i < ious.size(); i++)
-	{
-		ious[i].resize(btlbrs.size());
-	}
-
-	// bbox_ious
-	for (size_t k = 0; k < btlbrs.size(); k++)
+	resb.clear();
+	for (size_t i = 0; i < stracksb.size(); i++)
 	{
-		std::vector<float> ious_tmp;
-		float box_area = (btlbrs[k][2] - btlbrs[k][0] + 1) * (btlbrs[k][3] - btlbrs[k][1] + 1);
-		for (size_t n = 0; n < atlbrs.size(); n++)
+		if (!dupb[i])
 		{
-			float iw = std::min(atlbrs[n][2], btlbrs[k][2]) - std::max(atlbrs[n][0], btlbrs[k][0]) + 1;
-			if (iw > 0)
-			{
-				float ih = std::min(atlbrs[n][3], btlbrs[k][3]) - std::max(atlbrs[n][1], btlbrs[k][1]) + 1;
-				if (ih > 0)
-				{
-					float ua = (atlbrs[n][2] - atlbrs[n][0] + 1) * (atlbrs[n][3] - atlbrs[n][1] + 1) + box_area - iw * ih;
-					ious[n][k] = iw * ih / ua;
-				}
-				else
-				{
-					ious[n][k] = 0.0;
-				}
-			}
-			else
-			{
-				ious[n][k] = 0.0;
-			}
+			resb.push_back(stracksb[i]);
 		}
 	}
-
-	return ious;
 }
 
-std::vector<std::vector<float>> BYTETracker::iou_distance(std::vector<STrack *> &atracks, std::vector<STrack> &btracks, int &dist_size, int &dist_size_size)
+void BYTETracker::linear_assignment(float thresh, std::vector<std::pair<int, int>> &matches, std::vector<int> &unmatched_a, std::vector<int> &unmatched_b)
 {
-	std::vector<std::vector<float>> cost_matrix;
-	if (atracks.size() * btracks.size() == 0)
-	{
-		dist_size = atracks.size();
-		dist_size_size = btracks.size();
-		return cost_matrix;
-	}
-	std::vector<std::vector<float>> atlbrs, btlbrs;
-	for (size_t i = 0; i < atracks.size(); i++)
-	{
-		atlbrs.push_back(atracks[i]->tlbr);
-	}
-	for (size_t i = 0; i < btracks.size(); i++)
-	{
-		btlbrs.push_back(btracks[i].tlbr);
-	}
-
-	dist_size = atracks.size();
-	dist_size_size = btracks.size();
-
-	std::vector<std::vector<float>> _ious = ious(atlbrs, btlbrs);
-
-	for (size_t i = 0; i < _ious.size(); i++)
-	{
-		std::vector<float> _iou;
-		for (size_t j = 0; j < _ious[i].size(); j++)
-		{
-			_iou.push_back(1 - _ious[i][j]);
-		}
-		cost_matrix.push_back(_iou);
-	}
-
-	return cost_matrix;
+	assignment.solve(thresh, matches, unmatched_a, unmatched_b);
 }
 
-std::vector<std::vector<float>> BYTETracker::iou_distance(std::vector<STrack> &atracks, std::vector<STrack> &btracks)
+void BYTETracker::iou_distance(const std::vector<STrack> &astore, const std::vector<int> &atracks, const std::vector<STrack> &bstore, const std::vector<int> &btracks, float max_cost)
 {
-	std::vector<std::vector<float>> atlbrs, btlbrs;
+	box_a.resize(atracks.size() * 4);
 	for (size_t i = 0; i < atracks.size(); i++)
 	{
-		atlbrs.push_back(atracks[i].tlbr);
+		std::copy(astore[atracks[i]].tlbr, astore[atracks[i]].tlbr + 4, &box_a[i * 4]);
 	}
+	box_b.resize(btracks.size() * 4);
 	for (size_t i = 0; i < btracks.size(); i++)
 	{
-		btlbrs.push_back(btracks[i].tlbr);
-	}
-
-	std::vector<std::vector<float>> _ious = ious(atlbrs, btlbrs);
-	std::vector<std::vector<float>> cost_matrix;
-	for (size_t i = 0; i < _ious.size(); i++)
-	{
-		std::vector<float> _iou;
-		for (size_t j = 0; j < _ious[i].size(); j++)
-		{
-			_iou.push_back(1 - _ious[i][j]);
-		}
-		cost_matrix.push_back(_iou);
-	}
-
-	return cost_matrix;
-}
-
-double BYTETracker::lapjv(const std::vector<std::vector<float>> &cost, std::vector<int> &rowsol, std::vector<int> &colsol,
-						  bool extend_cost, float cost_limit, bool return_cost)
-{
-	std::vector<std::vector<float>> cost_c;
-	cost_c.assign(cost.begin(), cost.end());
-
-	std::vector<std::vector<float>> cost_c_extended;
-
-	int n_rows = cost.size();
-	int n_cols = cost[0].size();
-	rowsol.resize(n_rows);
-	colsol.resize(n_cols);
-
-	int n = 0;
-	if (n_rows == n_cols)
-	{
-		n = n_rows;
-	}
-	else
-	{
-		if (!extend_cost)
-		{
-			std::cout << "set extend_cost=True" << std::endl;
-			system("pause");
-			exit(0);
-		}
-	}
-
-	if (extend_cost || cost_limit < LONG_MAX)
-	{
-		n = n_rows + n_cols;
-		cost_c_extended.resize(n);
-		for (size_t i = 0; i < cost_c_extended.size(); i++)
-			cost_c_extended[i].resize(n);
-
-		if (cost_limit < LONG_MAX)
-		{
-			for (size_t i = 0; i < cost_c_extended.size(); i++)
-			{
-				for (size_t j = 0; j < cost_c_extended[i].size(); j++)
-				{
-					cost_c_extended[i][j] = cost_limit / 2.0;
-				}
-			}
-		}
-		else
-		{
-			float cost_max = -1;
-			for (size_t i = 0; i < cost_c.size(); i++)
-			{
-				for (size_t j = 0; j < cost_c[i].size(); j++)
-				{
-					if (cost_c[i][j] > cost_max)
-						cost_max = cost_c[i][j];
-				}
-			}
-			for (size_t i = 0; i < cost_c_extended.size(); i++)
-			{
-				for (size_t j = 0; j < cost_c_extended[i].size(); j++)
-				{
-					cost_c_extended[i][j] = cost_max + 1;
-				}
-			}
-		}
-
-		for (size_t i = n_rows; i < cost_c_extended.size(); i++)
-		{
-			for (size_t j = n_cols; j < cost_c_extended[i].size(); j++)
-			{
-				cost_c_extended[i][j] = 0;
-			}
-		}
-		for (int i = 0; i < n_rows; i++)
-		{
-			for (int j = 0; j < n_cols; j++)
-			{
-				cost_c_extended[i][j] = cost_c[i][j];
-			}
-		}
-
-		cost_c.clear();
-		cost_c.assign(cost_c_extended.begin(), cost_c_extended.end());
-	}
-
-	double **cost_ptr;
-	cost_ptr = new double *[sizeof(double *) * n];
-	for (int i = 0; i < n; i++)
-		cost_ptr[i] = new double[sizeof(double) * n];
-
-	for (int i = 0; i < n; i++)
-	{
-		for (int j = 0; j < n; j++)
-		{
-			cost_ptr[i][j] = cost_c[i][j];
-		}
-	}
-
-	int *x_c = new int[sizeof(int) * n];
-	int *y_c = new int[sizeof(int) * n];
-
-	int ret = lapjv_internal(n, cost_ptr, x_c, y_c);
-	if (ret != 0)
-	{
-		std::cout << "Calculate Wrong!" << std::endl;
-		system("pause");
-		exit(0);
-	}
-
-	double opt = 0.0;
-
-	if (n != n_rows)
-	{
-		for (int i = 0; i < n; i++)
-		{
-			if (x_c[i] >= n_cols)
-				x_c[i] = -1;
-			if (y_c[i] >= n_rows)
-				y_c[i] = -1;
-		}
-		for (int i = 0; i < n_rows; i++)
-		{
-			rowsol[i] = x_c[i];
-		}
-		for (int i = 0; i < n_cols; i++)
-		{
-			colsol[i] = y_c[i];
-		}
-
-		if (return_cost)
-		{
-			for (size_t i = 0; i < rowsol.size(); i++)
-			{
-				if (rowsol[i] != -1)
-				{
-					// std::cout << i << "\t" << rowsol[i] << "\t" << cost_ptr[i][rowsol[i]] << std::endl;
-					opt += cost_ptr[i][rowsol[i]];
-				}
-			}
-		}
-	}
-	else if (return_cost)
-	{
-		for (size_t i = 0; i < rowsol.size(); i++)
-		{
-			opt += cost_ptr[i][rowsol[i]];
-		}
-	}
-
-	for (int i = 0; i < n; i++)
-	{
-		delete[] cost_ptr[i];
+		std::copy(bstore[btracks[i]].tlbr, bstore[btracks[i]].tlbr + 4, &box_b[i * 4]);
 	}
-	delete[] cost_ptr;
-	delete[] x_c;
-	delete[] y_c;
 
-	return opt;
+	assignment.gate(box_a.data(), (int)atracks.size(), box_b.data(), (int)btracks.size(), max_cost);
 }
 
 // Scalar BYTETracker::get_color(int idx)